@@ -9,6 +9,8 @@
 #include "./basic/basic_search.hpp"
 #include "./basic/pext64.hpp"
 #include "./basic/byte_vector_functions.hpp"
+#include "./basic/parallel_functions.hpp"
+#include "./basic/uint40.hpp"
 
 
 #include "./debug/equal_checker.hpp"
@@ -18,23 +20,33 @@
 #include "./debug/memory.hpp"
 
 #include "./io/file_reader.hpp"
+#include "./io/streaming_file_writer.hpp"
 #include "./io/file_writer.hpp"
+#include "./io/mapped_vector.hpp"
+#include "./io/packed_array_file.hpp"
 #include "./io/online_file_reader.hpp"
+#include "./io/external_sorter.hpp"
 
 #include "./rmq/rmq_small_sparse_table.hpp"
+#include "./rmq/rmq_compact.hpp"
 
 #include "./strings/alphabet.hpp"
 #include "./strings/delta.hpp"
+#include "./strings/delta_estimator.hpp"
 #include "./strings/random_string.hpp"
 #include "./strings/forward_rle.hpp"
 #include "./strings/text_statistics.hpp"
 #include "./strings/lcp_interval.hpp"
 #include "./strings/lcp_interval_comparator_in_preorder.hpp"
 #include "./strings/lcp_interval_comparator_in_depth_order.hpp"
+#include "./strings/lcp_interval_tree_traversal.hpp"
 #include "./strings/sa_is.hpp"
+#include "./strings/external_suffix_array.hpp"
+#include "./strings/compressed_plcp_array.hpp"
 #include "./strings/array_constructor.hpp"
 #include "./strings/string_functions_on_sa.hpp"
 #include "./strings/string_functions.hpp"
+#include "./strings/lce_index.hpp"
 
 
 
@@ -43,6 +55,7 @@
 #include "./specialized_collection/value_array.hpp"
 #include "./specialized_collection/vlc_deque.hpp"
 #include "./specialized_collection/naive_dynamic_string.hpp"
+#include "./specialized_collection/byte_rank_directory.hpp"
 
 #include "./specialized_collection/push_pop_arrays/naive_integer_array.hpp"
 //#include "./specialized_collection/push_pop_arrays/eytzinger_layout_for_psum.hpp"
@@ -53,7 +66,10 @@
 
 #include "./lz/lz_factor.hpp"
 
+#include "./bwt/parallel_lf_walk.hpp"
 #include "./bwt/backward_isa.hpp"
+#include "./bwt/bwt_inversion.hpp"
 #include "./rlbwt/rle_io.hpp"
+#include "./rlbwt/prefix_free_parsing.hpp"
 
 
@@ -6,12 +6,15 @@
 #include "./rlbwt/forward_sa.hpp"
 #include "./rlbwt/rle.hpp"
 #include "./rlbwt/rle_wavelet_tree.hpp"
+#include "./rlbwt/move_lf_data_structure.hpp"
+#include "./rlbwt/r_index.hpp"
 
 #include "./bwt/bwt_functions.hpp"
 #include "./bwt/lf_data_structure.hpp"
 #include "./third_party/sdsl_functions.hpp"
 
 #include "./beller/beller_component.hpp"
+#include "./beller/parallel_beller_component.hpp"
 #include "./beller/lcp_interval_enumerator.hpp"
 #include "./beller/lcp_enumerator.hpp"
 
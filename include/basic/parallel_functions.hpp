@@ -0,0 +1,233 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <utility>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+namespace stool
+{
+    /**
+     * @brief A reusable barrier for a fixed number of threads
+     *
+     * It lets the threads of a single parallel_for_ranges call work in phases, instead of creating new threads for every phase.
+     * \ingroup BasicClasses
+     */
+    class ThreadBarrier
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        uint64_t thread_count;
+        uint64_t waiting_count = 0;
+        uint64_t generation = 0;
+
+    public:
+        /**
+         * @brief Constructs a barrier for \p _thread_count threads
+         */
+        ThreadBarrier(uint64_t _thread_count) : thread_count(std::max(_thread_count, (uint64_t)1))
+        {
+        }
+
+        ThreadBarrier(const ThreadBarrier &) = delete;
+        ThreadBarrier &operator=(const ThreadBarrier &) = delete;
+
+        /**
+         * @brief Blocks until all the threads have called this function, and then releases all of them
+         */
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            uint64_t current_generation = this->generation;
+            if (++this->waiting_count == this->thread_count)
+            {
+                this->waiting_count = 0;
+                this->generation++;
+                this->cv.notify_all();
+            }
+            else
+            {
+                this->cv.wait(lock, [&]()
+                              { return current_generation != this->generation; });
+            }
+        }
+    };
+
+    /**
+     * @brief A utility class for running simple data-parallel loops with std::thread
+     * \ingroup BasicClasses
+     */
+    class ParallelFunctions
+    {
+    public:
+        /**
+         * @brief Returns the number of hardware threads (at least 1)
+         */
+        static uint64_t get_hardware_thread_count()
+        {
+            uint64_t x = std::thread::hardware_concurrency();
+            return x == 0 ? 1 : x;
+        }
+
+        /**
+         * @brief Splits [0, n) into at most \p thread_count contiguous ranges
+         *
+         * @param alignment Every boundary between two ranges is a multiple of \p alignment
+         * @return The list of half-open ranges [begin, end). Empty ranges are not returned.
+         */
+        static std::vector<std::pair<uint64_t, uint64_t>> split_ranges(uint64_t n, uint64_t thread_count, uint64_t alignment = 1)
+        {
+            std::vector<std::pair<uint64_t, uint64_t>> r;
+            if (n == 0)
+            {
+                return r;
+            }
+            uint64_t p = std::max(thread_count, (uint64_t)1);
+            uint64_t width = (n + p - 1) / p;
+            if (alignment > 1)
+            {
+                width = ((width + alignment - 1) / alignment) * alignment;
+            }
+            for (uint64_t x = 0; x < n; x += width)
+            {
+                r.push_back(std::pair<uint64_t, uint64_t>(x, std::min(n, x + width)));
+            }
+            return r;
+        }
+
+        /**
+         * @brief Calls \p func(t, begin, end) for the t-th range of split_ranges(n, thread_count, alignment) in parallel
+         *
+         * The first range is processed by the calling thread. If only one range exists, no thread is created.
+         */
+        template <typename FUNC>
+        static void parallel_for_ranges(uint64_t n, uint64_t thread_count, FUNC func, uint64_t alignment = 1)
+        {
+            std::vector<std::pair<uint64_t, uint64_t>> ranges = split_ranges(n, thread_count, alignment);
+            if (ranges.size() == 0)
+            {
+                return;
+            }
+            else if (ranges.size() == 1)
+            {
+                func((uint64_t)0, ranges[0].first, ranges[0].second);
+                return;
+            }
+
+            std::vector<std::thread> threads;
+            threads.reserve(ranges.size() - 1);
+            for (uint64_t t = 1; t < ranges.size(); t++)
+            {
+                threads.emplace_back(func, t, ranges[t].first, ranges[t].second);
+            }
+            func((uint64_t)0, ranges[0].first, ranges[0].second);
+            for (auto &th : threads)
+            {
+                th.join();
+            }
+        }
+
+        /**
+         * @brief Calls \p func(t, b) for every batch b in [0, batch_count) on at most \p thread_count threads
+         *
+         * The batches are handed out one at a time through a shared counter, so a thread that finishes early takes the remaining batches
+         * of slower threads. \p t is the ID of the thread in [0, thread_count), and the calling thread works as thread 0.
+         */
+        template <typename FUNC>
+        static void parallel_for_batches(uint64_t batch_count, uint64_t thread_count, FUNC func)
+        {
+            uint64_t p = std::min(std::max(thread_count, (uint64_t)1), batch_count);
+            if (p <= 1)
+            {
+                for (uint64_t b = 0; b < batch_count; b++)
+                {
+                    func((uint64_t)0, b);
+                }
+                return;
+            }
+
+            std::atomic<uint64_t> next_batch(0);
+            auto worker = [&](uint64_t t)
+            {
+                while (true)
+                {
+                    uint64_t b = next_batch.fetch_add(1, std::memory_order_relaxed);
+                    if (b >= batch_count)
+                    {
+                        break;
+                    }
+                    func(t, b);
+                }
+            };
+            std::vector<std::thread> threads;
+            threads.reserve(p - 1);
+            for (uint64_t t = 1; t < p; t++)
+            {
+                threads.emplace_back(worker, t);
+            }
+            worker(0);
+            for (auto &th : threads)
+            {
+                th.join();
+            }
+        }
+
+        /**
+         * @brief Sorts \p items by the integer keys \p key(item) in [0, \p max_key] with a stable LSD radix sort on \p thread_count threads
+         *
+         * Each pass sorts by 8 bits of the keys: the threads count the digits of contiguous ranges, and then move the items of their ranges
+         * to the disjoint positions given by the prefix sums of the counts. The number of passes is the number of bytes of \p max_key.
+         */
+        template <typename T, typename KEY_FUNC>
+        static void parallel_radix_sort(std::vector<T> &items, KEY_FUNC key, uint64_t max_key, uint64_t thread_count)
+        {
+            constexpr uint64_t RADIX = 256;
+            uint64_t n = items.size();
+            std::vector<std::pair<uint64_t, uint64_t>> ranges = split_ranges(n, thread_count);
+            uint64_t range_count = ranges.size();
+            std::vector<T> buffer(n);
+            std::vector<uint64_t> offsets(range_count * RADIX);
+
+            for (uint64_t shift = 0; shift < 64 && (max_key >> shift) > 0; shift += 8)
+            {
+                std::fill(offsets.begin(), offsets.end(), 0);
+                parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t begin, uint64_t end)
+                                    {
+                                        uint64_t *counts = &offsets[t * RADIX];
+                                        for (uint64_t i = begin; i < end; i++)
+                                        {
+                                            counts[(key(items[i]) >> shift) & (RADIX - 1)]++;
+                                        } });
+                uint64_t sum = 0;
+                for (uint64_t d = 0; d < RADIX; d++)
+                {
+                    for (uint64_t t = 0; t < range_count; t++)
+                    {
+                        uint64_t count = offsets[t * RADIX + d];
+                        offsets[t * RADIX + d] = sum;
+                        sum += count;
+                    }
+                }
+                parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t begin, uint64_t end)
+                                    {
+                                        uint64_t *positions = &offsets[t * RADIX];
+                                        for (uint64_t i = begin; i < end; i++)
+                                        {
+                                            buffer[positions[(key(items[i]) >> shift) & (RADIX - 1)]++] = std::move(items[i]);
+                                        } });
+                items.swap(buffer);
+            }
+        }
+
+        /**
+         * @brief Returns the number of ranges that parallel_for_ranges(n, thread_count, func, alignment) creates
+         */
+        static uint64_t get_range_count(uint64_t n, uint64_t thread_count, uint64_t alignment = 1)
+        {
+            return split_ranges(n, thread_count, alignment).size();
+        }
+    };
+}
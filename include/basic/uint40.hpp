@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+
+namespace stool
+{
+    /**
+     * @brief A 40-bit unsigned integer stored in 5 bytes
+     *
+     * This class converts implicitly from and to uint64_t, so that std::vector<UInt40> can be used as a compact
+     * replacement of std::vector<uint64_t> for arrays (e.g., suffix arrays) whose values are less than 2^40.
+     * Arithmetic is performed on uint64_t after the conversion.
+     * \ingroup BasicClasses
+     */
+    class UInt40
+    {
+        uint8_t bytes[5];
+
+    public:
+        /** @brief The maximum value representable by UInt40 */
+        static inline constexpr uint64_t MAX_VALUE = (1ULL << 40) - 1;
+
+        /**
+         * @brief Constructs the value 0
+         */
+        UInt40() : bytes{0, 0, 0, 0, 0}
+        {
+        }
+
+        /**
+         * @brief Constructs the lowest 40 bits of \p value
+         */
+        UInt40(uint64_t value)
+        {
+            this->set(value);
+        }
+
+        /**
+         * @brief Stores the lowest 40 bits of \p value
+         */
+        void set(uint64_t value)
+        {
+            for (uint64_t i = 0; i < 5; i++)
+            {
+                this->bytes[i] = (value >> (i * 8)) & 0xFF;
+            }
+        }
+
+        /**
+         * @brief Returns the stored value as uint64_t
+         */
+        uint64_t get() const
+        {
+            uint64_t value = 0;
+            for (uint64_t i = 0; i < 5; i++)
+            {
+                value |= ((uint64_t)this->bytes[i]) << (i * 8);
+            }
+            return value;
+        }
+
+        /**
+         * @brief Returns the stored value as uint64_t
+         */
+        operator uint64_t() const
+        {
+            return this->get();
+        }
+    };
+    static_assert(sizeof(UInt40) == 5, "UInt40 must occupy 5 bytes");
+}
+
+namespace std
+{
+    template <>
+    class numeric_limits<stool::UInt40>
+    {
+    public:
+        static constexpr bool is_specialized = true;
+        static constexpr bool is_integer = true;
+        static constexpr bool is_signed = false;
+        static constexpr int digits = 40;
+        static stool::UInt40 min() { return stool::UInt40(0); }
+        static stool::UInt40 max() { return stool::UInt40(stool::UInt40::MAX_VALUE); }
+    };
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "./beller_small_component.hpp"
+#include "./compact_interval_queue.hpp"
 
 namespace stool
 {
@@ -21,7 +22,8 @@ namespace stool
          * - Memory-efficient text indexing
          * 
          * @note This implementation uses queues and vectors for efficient interval tracking
-         *       and supports generic index types through templates
+         *       and supports generic index types through templates.
+         *       The queues are CompactIntervalQueues; if queue_storage is set before initialize, they share its memory budget and spill to disk when it is exceeded.
          */
         class BellerComponent
         {
@@ -29,7 +31,7 @@ namespace stool
             using INDEX = uint64_t;
             using INTERVAL = stool::LCPInterval<INDEX>;
 
-            std::vector<std::queue<INTERVAL>> intervalQueues;
+            std::vector<CompactIntervalQueue> intervalQueues;
             std::vector<bool> checker;
 
             std::vector<bool> lcp_checker;
@@ -39,8 +41,9 @@ namespace stool
             std::vector<uint8_t> occurrenceChars;
             std::vector<CharInterval<INDEX, uint8_t>> charIntervalTmpVec;
 
-            std::queue<INTERVAL> outputQueue;
+            CompactIntervalQueue outputQueue;
             IntervalSearchDataStructure<uint8_t> *range = nullptr;
+            IntervalQueueStorage *queue_storage = nullptr;
 
             uint64_t lcp = 0;
             bool _process_end = false;
@@ -48,21 +51,22 @@ namespace stool
 
             void refresh()
             {
-                uint64_t bwtSize = this->range->wt->size();
+                uint64_t bwtSize = this->range->get_text_size();
                 uint64_t CHARMAX = UINT8_MAX + 1;
 
                 intervalQueues.clear();
-                while (outputQueue.size() > 0)
-                {
-                    outputQueue.pop();
-                }
+                outputQueue = CompactIntervalQueue(this->queue_storage);
                 checker.clear();
                 counter.clear();
                 occurrenceChars.clear();
                 charIntervalTmpVec.clear();
                 lcp_checker.clear();
 
-                intervalQueues.resize(CHARMAX);
+                intervalQueues.reserve(CHARMAX);
+                for (uint64_t c = 0; c < CHARMAX; c++)
+                {
+                    intervalQueues.emplace_back(this->queue_storage);
+                }
                 counter.resize(CHARMAX, 0);
                 checker.resize(bwtSize + 1, false);
                 checker[0] = false;
@@ -259,7 +263,7 @@ namespace stool
         private:
             void first_process()
             {
-                uint64_t bwtSize = this->range->wt->size();
+                uint64_t bwtSize = this->range->get_text_size();
                 INTERVAL fst(0, bwtSize - 1, 0);
                 uint64_t charIntvCount = this->range->getIntervals(fst.i, fst.j, this->charIntervalTmpVec);
 
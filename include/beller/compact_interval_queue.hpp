@@ -0,0 +1,504 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <unistd.h>
+#include "../strings/lcp_interval.hpp"
+#include "../io/external_sorter.hpp"
+
+namespace stool
+{
+    namespace beller
+    {
+        /*!
+         * @brief The memory budget and the spill file shared by CompactIntervalQueues
+         *
+         * The queues report the bytes of their in-memory chunks to this object. When the total exceeds the memory limit,
+         * every chunk filled afterwards is written to a temporary file and is read back when the queue reaches it.
+         * The file is truncated whenever all the spilled chunks have been read, and it is removed by the destructor.
+         * The functions are guarded by a mutex, so distinct queues sharing this object can be used by distinct threads.
+         * This object must outlive the queues that use it.
+         */
+        class IntervalQueueStorage
+        {
+            uint64_t memory_limit_bytes = UINT64_MAX;
+            std::string tmp_dir = ".";
+            std::string file_path;
+            std::fstream file;
+            uint64_t file_size = 0;
+
+            uint64_t memory_bytes = 0;
+            uint64_t peak_memory_bytes = 0;
+            uint64_t spilled_bytes = 0;
+            uint64_t live_spilled_bytes = 0;
+            mutable std::mutex mutex;
+
+            void open_file()
+            {
+                if (this->file_path.size() == 0)
+                {
+                    this->file_path = this->tmp_dir + "/stool_interval_queue_" + std::to_string(getpid()) + "_" + std::to_string(external_sorter_detail::get_next_file_id()) + ".tmp";
+                }
+                this->file.open(this->file_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!this->file)
+                {
+                    throw std::runtime_error("Failed to open file: " + this->file_path);
+                }
+                this->file_size = 0;
+            }
+
+        public:
+            /*!
+             * @brief Constructs a storage without a memory limit (no chunk is spilled)
+             */
+            IntervalQueueStorage()
+            {
+            }
+
+            /*!
+             * @brief Constructs a storage that spills the chunks to \p _tmp_dir when the queues use more than \p _memory_limit_bytes bytes
+             */
+            IntervalQueueStorage(uint64_t _memory_limit_bytes, const std::string &_tmp_dir = ".") : memory_limit_bytes(_memory_limit_bytes), tmp_dir(_tmp_dir)
+            {
+            }
+
+            IntervalQueueStorage(const IntervalQueueStorage &) = delete;
+            IntervalQueueStorage &operator=(const IntervalQueueStorage &) = delete;
+
+            ~IntervalQueueStorage()
+            {
+                if (this->file.is_open())
+                {
+                    this->file.close();
+                    std::remove(this->file_path.c_str());
+                }
+            }
+
+            /*!
+             * @brief Records that a queue has allocated \p bytes bytes
+             */
+            void allocate(uint64_t bytes)
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->memory_bytes += bytes;
+                this->peak_memory_bytes = std::max(this->peak_memory_bytes, this->memory_bytes);
+            }
+
+            /*!
+             * @brief Records that a queue has released \p bytes bytes
+             */
+            void deallocate(uint64_t bytes)
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->memory_bytes -= bytes;
+            }
+
+            /*!
+             * @brief Returns true if the queues use more memory than the limit
+             */
+            bool is_over_budget() const
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                return this->memory_bytes > this->memory_limit_bytes;
+            }
+
+            /*!
+             * @brief Appends \p len bytes starting at \p data to the spill file and returns their offset in the file
+             */
+            uint64_t write_chunk(const uint8_t *data, uint64_t len)
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                if (!this->file.is_open())
+                {
+                    this->open_file();
+                }
+                uint64_t offset = this->file_size;
+                this->file.seekp(offset);
+                this->file.write(reinterpret_cast<const char *>(data), len);
+                if (!this->file)
+                {
+                    throw std::runtime_error("Failed to write to file: " + this->file_path);
+                }
+                this->file_size += len;
+                this->spilled_bytes += len;
+                this->live_spilled_bytes += len;
+                return offset;
+            }
+
+            /*!
+             * @brief Reads the \p len bytes at \p offset of the spill file into \p output
+             */
+            void read_chunk(uint64_t offset, uint64_t len, uint8_t *output)
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->file.seekg(offset);
+                this->file.read(reinterpret_cast<char *>(output), len);
+                if (!this->file)
+                {
+                    throw std::runtime_error("Failed to read from file: " + this->file_path);
+                }
+            }
+
+            /*!
+             * @brief Records that a spilled chunk of \p len bytes has been read and is no longer needed
+             */
+            void discard_chunk(uint64_t len)
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->live_spilled_bytes -= len;
+                if (this->live_spilled_bytes == 0 && this->file.is_open())
+                {
+                    this->file.close();
+                    this->open_file();
+                }
+            }
+
+            /*!
+             * @brief Returns the bytes currently used by the in-memory chunks
+             */
+            uint64_t get_memory_bytes() const
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                return this->memory_bytes;
+            }
+
+            /*!
+             * @brief Returns the maximum of get_memory_bytes() so far
+             */
+            uint64_t get_peak_memory_bytes() const
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                return this->peak_memory_bytes;
+            }
+
+            /*!
+             * @brief Returns the total bytes written to the spill file so far
+             */
+            uint64_t get_spilled_bytes() const
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                return this->spilled_bytes;
+            }
+        };
+
+        /*!
+         * @brief A FIFO queue of LCP intervals stored in a compact form
+         *
+         * Each interval (i, j, lcp) is encoded as three variable-length integers: the difference between i and the previous i,
+         * j - i, and the difference between lcp and the previous lcp (the differences are zigzag-encoded).
+         * The intervals of a Beller queue share the lcp value and have close left boundaries, so an interval usually takes 3-6 bytes
+         * instead of the 24 bytes (plus the node overhead) of std::queue<LCPInterval<uint64_t>>.
+         * The bytes are stored in chunks of at most CHUNK_SIZE bytes, and the filled chunks can be spilled to disk through an IntervalQueueStorage.
+         */
+        class CompactIntervalQueue
+        {
+        public:
+            using INTERVAL = stool::LCPInterval<uint64_t>;
+
+            /** @brief The maximum size of a chunk in bytes */
+            static inline constexpr uint64_t CHUNK_SIZE = 1ULL << 16;
+
+            /** @brief The initial size of a chunk in bytes */
+            static inline constexpr uint64_t MIN_CHUNK_SIZE = 1ULL << 8;
+
+            /** @brief The maximum number of bytes of an encoded interval */
+            static inline constexpr uint64_t MAX_ENCODED_SIZE = 30;
+
+        private:
+            struct Chunk
+            {
+                std::vector<uint8_t> data;
+                uint64_t used = 0;
+                uint64_t file_offset = UINT64_MAX;
+                bool sealed = false;
+            };
+
+            std::deque<Chunk> chunks;
+            IntervalQueueStorage *storage = nullptr;
+            uint64_t element_count = 0;
+            uint64_t read_position = 0;
+
+            uint64_t last_pushed_i = 0;
+            uint64_t last_pushed_lcp = 0;
+            uint64_t last_popped_i = 0;
+            uint64_t last_popped_lcp = 0;
+
+            static uint64_t zigzag_encode(uint64_t x, uint64_t prev)
+            {
+                int64_t diff = (int64_t)(x - prev);
+                return (((uint64_t)diff) << 1) ^ (uint64_t)(diff >> 63);
+            }
+            static uint64_t zigzag_decode(uint64_t value, uint64_t prev)
+            {
+                return prev + (uint64_t)((int64_t)(value >> 1) ^ -(int64_t)(value & 1));
+            }
+            static uint8_t *write_varint(uint64_t value, uint8_t *dst)
+            {
+                while (value >= 128)
+                {
+                    *dst++ = (uint8_t)(value | 128);
+                    value >>= 7;
+                }
+                *dst++ = (uint8_t)value;
+                return dst;
+            }
+            static const uint8_t *read_varint(const uint8_t *src, uint64_t &value)
+            {
+                value = 0;
+                uint64_t shift = 0;
+                while (*src >= 128)
+                {
+                    value |= ((uint64_t)(*src++ & 127)) << shift;
+                    shift += 7;
+                }
+                value |= ((uint64_t)*src++) << shift;
+                return src;
+            }
+
+            void resize_chunk_data(Chunk &chunk, uint64_t new_size)
+            {
+                uint64_t old_size = chunk.data.size();
+                chunk.data.resize(new_size);
+                chunk.data.shrink_to_fit();
+                if (this->storage != nullptr)
+                {
+                    if (new_size > old_size)
+                    {
+                        this->storage->allocate(new_size - old_size);
+                    }
+                    else
+                    {
+                        this->storage->deallocate(old_size - new_size);
+                    }
+                }
+            }
+
+            /*!
+             * @brief Marks the last chunk as filled and spills it if the memory budget is exceeded
+             */
+            void seal_last_chunk()
+            {
+                Chunk &chunk = this->chunks.back();
+                chunk.sealed = true;
+                if (this->storage != nullptr && this->storage->is_over_budget() && this->chunks.size() > 1)
+                {
+                    chunk.file_offset = this->storage->write_chunk(chunk.data.data(), chunk.used);
+                    this->resize_chunk_data(chunk, 0);
+                }
+            }
+
+            /*!
+             * @brief Returns the last chunk after making room for an encoded interval
+             */
+            Chunk &get_writable_chunk()
+            {
+                if (this->chunks.size() > 0 && !this->chunks.back().sealed)
+                {
+                    Chunk &chunk = this->chunks.back();
+                    if (chunk.used + MAX_ENCODED_SIZE <= chunk.data.size())
+                    {
+                        return chunk;
+                    }
+                    if (chunk.data.size() < CHUNK_SIZE)
+                    {
+                        this->resize_chunk_data(chunk, std::min(CHUNK_SIZE, chunk.data.size() * 2));
+                        return chunk;
+                    }
+                    this->seal_last_chunk();
+                }
+                this->chunks.emplace_back();
+                this->resize_chunk_data(this->chunks.back(), MIN_CHUNK_SIZE);
+                return this->chunks.back();
+            }
+
+            /*!
+             * @brief Loads the first chunk from the spill file if it has been spilled (the first chunk is always kept in memory)
+             */
+            void load_first_chunk()
+            {
+                if (this->chunks.size() > 0)
+                {
+                    Chunk &chunk = this->chunks.front();
+                    if (chunk.file_offset != UINT64_MAX && chunk.data.size() == 0)
+                    {
+                        this->resize_chunk_data(chunk, chunk.used);
+                        this->storage->read_chunk(chunk.file_offset, chunk.used, chunk.data.data());
+                    }
+                }
+            }
+
+            void release_all()
+            {
+                while (this->chunks.size() > 0)
+                {
+                    Chunk &chunk = this->chunks.front();
+                    this->resize_chunk_data(chunk, 0);
+                    if (chunk.file_offset != UINT64_MAX)
+                    {
+                        this->storage->discard_chunk(chunk.used);
+                    }
+                    this->chunks.pop_front();
+                }
+            }
+
+        public:
+            /*!
+             * @brief Constructs an empty queue. If \p _storage is not nullptr, the memory usage is reported to it and the chunks may be spilled.
+             */
+            CompactIntervalQueue(IntervalQueueStorage *_storage = nullptr) : storage(_storage)
+            {
+            }
+
+            CompactIntervalQueue(const CompactIntervalQueue &) = delete;
+            CompactIntervalQueue &operator=(const CompactIntervalQueue &) = delete;
+
+            CompactIntervalQueue(CompactIntervalQueue &&other) noexcept
+            {
+                this->swap(other);
+            }
+            CompactIntervalQueue &operator=(CompactIntervalQueue &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    this->release_all();
+                    this->clear();
+                    this->storage = nullptr;
+                    this->swap(other);
+                }
+                return *this;
+            }
+
+            ~CompactIntervalQueue()
+            {
+                this->release_all();
+            }
+
+            /*!
+             * @brief Swaps the contents of this queue and \p other
+             */
+            void swap(CompactIntervalQueue &other) noexcept
+            {
+                std::swap(this->chunks, other.chunks);
+                std::swap(this->storage, other.storage);
+                std::swap(this->element_count, other.element_count);
+                std::swap(this->read_position, other.read_position);
+                std::swap(this->last_pushed_i, other.last_pushed_i);
+                std::swap(this->last_pushed_lcp, other.last_pushed_lcp);
+                std::swap(this->last_popped_i, other.last_popped_i);
+                std::swap(this->last_popped_lcp, other.last_popped_lcp);
+            }
+
+            /*!
+             * @brief Returns the number of intervals in this queue
+             */
+            uint64_t size() const
+            {
+                return this->element_count;
+            }
+
+            /*!
+             * @brief Returns true if this queue has no interval
+             */
+            bool empty() const
+            {
+                return this->element_count == 0;
+            }
+
+            /*!
+             * @brief Appends \p interval to the end of this queue
+             */
+            void push(const INTERVAL &interval)
+            {
+                Chunk &chunk = this->get_writable_chunk();
+                uint8_t *dst = chunk.data.data() + chunk.used;
+                uint8_t *p = write_varint(zigzag_encode(interval.i, this->last_pushed_i), dst);
+                p = write_varint(zigzag_encode(interval.j, interval.i), p);
+                p = write_varint(zigzag_encode(interval.lcp, this->last_pushed_lcp), p);
+                chunk.used += p - dst;
+                this->last_pushed_i = interval.i;
+                this->last_pushed_lcp = interval.lcp;
+                this->element_count++;
+            }
+
+            /*!
+             * @brief Returns the first interval of this queue
+             */
+            INTERVAL front() const
+            {
+                if (this->element_count == 0)
+                {
+                    throw std::runtime_error("CompactIntervalQueue: the queue is empty");
+                }
+                const Chunk &chunk = this->chunks.front();
+                uint64_t x;
+                const uint8_t *p = read_varint(chunk.data.data() + this->read_position, x);
+                uint64_t i = zigzag_decode(x, this->last_popped_i);
+                p = read_varint(p, x);
+                uint64_t j = zigzag_decode(x, i);
+                read_varint(p, x);
+                uint64_t lcp = zigzag_decode(x, this->last_popped_lcp);
+                return INTERVAL(i, j, lcp);
+            }
+
+            /*!
+             * @brief Removes the first interval of this queue
+             */
+            void pop()
+            {
+                if (this->element_count == 0)
+                {
+                    throw std::runtime_error("CompactIntervalQueue: the queue is empty");
+                }
+                Chunk &chunk = this->chunks.front();
+                const uint8_t *begin = chunk.data.data() + this->read_position;
+                uint64_t x;
+                const uint8_t *p = read_varint(begin, x);
+                this->last_popped_i = zigzag_decode(x, this->last_popped_i);
+                p = read_varint(p, x);
+                p = read_varint(p, x);
+                this->last_popped_lcp = zigzag_decode(x, this->last_popped_lcp);
+                this->read_position += p - begin;
+                this->element_count--;
+
+                if (this->read_position == chunk.used)
+                {
+                    if (chunk.sealed)
+                    {
+                        this->resize_chunk_data(chunk, 0);
+                        if (chunk.file_offset != UINT64_MAX)
+                        {
+                            this->storage->discard_chunk(chunk.used);
+                        }
+                        this->chunks.pop_front();
+                        this->load_first_chunk();
+                    }
+                    else
+                    {
+                        // The only chunk has been read, so it is reused from the beginning.
+                        chunk.used = 0;
+                    }
+                    this->read_position = 0;
+                }
+            }
+
+            /*!
+             * @brief Removes all the intervals
+             */
+            void clear()
+            {
+                this->release_all();
+                this->element_count = 0;
+                this->read_position = 0;
+                this->last_pushed_i = 0;
+                this->last_pushed_lcp = 0;
+                this->last_popped_i = 0;
+                this->last_popped_lcp = 0;
+            }
+        };
+    } // namespace beller
+} // namespace stool
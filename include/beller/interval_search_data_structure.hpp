@@ -6,9 +6,21 @@
 #include <sdsl/wt_algorithm.hpp>
 
 #include "./char_interval.hpp"
+#include "../specialized_collection/byte_rank_directory.hpp"
 
 namespace stool
 {
+    /*!
+     * @brief The rank data structure used by IntervalSearchDataStructure
+     */
+    enum class IntervalSearchBackend
+    {
+        /** @brief sdsl::wt_huff<> (small, but each rank query follows a root-to-leaf path) */
+        WaveletTree,
+        /** @brief stool::ByteRankDirectory (up to 1.5 bytes per character, but a query reads only one block record per endpoint) */
+        ByteRankDirectory
+    };
+
     /*!
      * @brief A data structure for efficient interval searching in text sequences [Unchecked AI's Comment] 
      * 
@@ -24,27 +36,30 @@ namespace stool
      * - Suffix array interval computations
      * 
      * @note This implementation uses SDSL wavelet trees for efficient querying
-     *       and supports generic character types through templates
+     *       and supports generic character types through templates.
+     *       For byte alphabets, a ByteRankDirectory can be used instead of the wavelet tree (see IntervalSearchBackend).
      */
     template <typename CHAR>
     class IntervalSearchDataStructure
     {
     public:
         using WT = sdsl::wt_huff<>;
-        std::vector<uint64_t> *C;
-        WT *wt;
+        std::vector<uint64_t> *C = nullptr;
+        WT *wt = nullptr;
+        stool::ByteRankDirectory *rank_directory = nullptr;
         CHAR lastChar;
         std::vector<CHAR> cs;
         std::vector<uint64_t> cs1;
         std::vector<uint64_t> cs2;
 
         uint64_t get_text_size() const {
-            return this->wt->size();
+            return this->rank_directory != nullptr ? this->rank_directory->size() : this->wt->size();
         }
 
         void initialize(WT *_wt, std::vector<uint64_t> *_C, CHAR _lastChar)
         {
             this->wt = _wt;
+            this->rank_directory = nullptr;
             this->C = _C;
             this->lastChar = _lastChar;
 
@@ -52,44 +67,111 @@ namespace stool
             cs1.resize(256, 0);
             cs2.resize(256, 0);
         }
+
+        /*!
+         * @brief Initializes this data structure with a ByteRankDirectory instead of a wavelet tree (CHAR must be a byte type)
+         */
+        void initialize(stool::ByteRankDirectory *_rank_directory, std::vector<uint64_t> *_C, CHAR _lastChar)
+        {
+            this->wt = nullptr;
+            this->rank_directory = _rank_directory;
+            this->C = _C;
+            this->lastChar = _lastChar;
+
+            cs.resize(256, 0);
+            cs1.resize(256, 0);
+            cs2.resize(256, 0);
+        }
+
+        /*!
+         * @brief Initializes this data structure for the BWT \p bwt with the backend \p backend
+         *
+         * If \p backend is IntervalSearchBackend::ByteRankDirectory, \p _rank_directory is built from \p bwt and \p _wt is not used;
+         * otherwise, \p _wt is built from \p bwt.
+         */
+        template <typename BWT>
+        void initialize(const BWT &bwt, WT *_wt, stool::ByteRankDirectory *_rank_directory, std::vector<uint64_t> *_C, CHAR _lastChar, IntervalSearchBackend backend)
+        {
+            if (backend == IntervalSearchBackend::ByteRankDirectory)
+            {
+                _rank_directory->build(bwt);
+                this->initialize(_rank_directory, _C, _lastChar);
+            }
+            else
+            {
+                construct_im(*_wt, bwt);
+                this->initialize(_wt, _C, _lastChar);
+            }
+        }
+
+        /*!
+         * @brief Prefetches the memory read by getIntervals(i, j, ...) into the cache (no-op for the wavelet tree)
+         *
+         * Calling this function for the intervals processed a few steps later hides the cache misses of the rank queries.
+         */
+        void prefetch(uint64_t i, uint64_t j) const
+        {
+            if (this->rank_directory != nullptr)
+            {
+                uint64_t size = this->rank_directory->size();
+                this->rank_directory->prefetch(i + 1);
+                this->rank_directory->prefetch(j + 1 == size ? size : j + 2);
+            }
+        }
         template <typename INDEX_SIZE>
         uint64_t getIntervals(INDEX_SIZE i, INDEX_SIZE j, std::vector<CharInterval<INDEX_SIZE, CHAR>> &output)
+        {
+            return this->getIntervals(i, j, output, this->cs, this->cs1, this->cs2);
+        }
+
+        /*!
+         * @brief The same as getIntervals(i, j, output), but uses the given buffers (of size 256) instead of the member buffers
+         *
+         * This function does not modify this data structure, so it can be called by multiple threads with their own buffers.
+         */
+        template <typename INDEX_SIZE>
+        uint64_t getIntervals(INDEX_SIZE i, INDEX_SIZE j, std::vector<CharInterval<INDEX_SIZE, CHAR>> &output, std::vector<CHAR> &_cs, std::vector<uint64_t> &_cs1, std::vector<uint64_t> &_cs2) const
         {
             using CHARINTV = CharInterval<INDEX_SIZE, CHAR>;
-            std::vector<CHARINTV> r;
             uint64_t k;
-            uint64_t newJ = j + 1 == wt->size() ? wt->size() : j + 2;
+            uint64_t size = this->get_text_size();
+            uint64_t newJ = j + 1 == size ? size : j + 2;
             uint64_t p = 0;
 
-            // std::cout << "@[" << i << "/" << j << ", " << wt->size() << "]" << std::endl;
+            // std::cout << "@[" << i << "/" << j << ", " << size << "]" << std::endl;
 
-            sdsl::interval_symbols(*wt, i + 1, newJ, k, cs, cs1, cs2);
+            if (this->rank_directory != nullptr)
+            {
+                this->rank_directory->interval_symbols(i + 1, newJ, k, _cs, _cs1, _cs2);
+            }
+            else
+            {
+                sdsl::interval_symbols(*wt, i + 1, newJ, k, _cs, _cs1, _cs2);
+            }
 
-            bool b = j + 1 < wt->size();
+            bool b = j + 1 < size;
             for (INDEX_SIZE x = 0; x < k; x++)
             {
-                INDEX_SIZE left = (*C)[cs[x]] + cs1[x];
-                INDEX_SIZE right = left + (cs2[x] - cs1[x] - 1);
+                INDEX_SIZE left = (*C)[_cs[x]] + _cs1[x];
+                INDEX_SIZE right = left + (_cs2[x] - _cs1[x] - 1);
 
                 // uint64_t right = C[cs[x]] + cs2[x]+1;
 
-                if (j + 1 == wt->size() && cs[x] == lastChar)
+                if (j + 1 == size && _cs[x] == lastChar)
                 {
                     right++;
                     b = true;
                 }
 
                 // std::cout << ((int)cs[x]) << "/" << left << "/" << right << std::endl;
-                output[p++] = CHARINTV(left, right, cs[x]);
-                // r.push_back(CHARINTV(left, right, cs[x]));
+                output[p++] = CHARINTV(left, right, _cs[x]);
             }
             if (!b)
             {
-                INDEX_SIZE num = wt->rank(wt->size(), lastChar) + 1;
+                INDEX_SIZE num = (this->rank_directory != nullptr ? this->rank_directory->rank(size, lastChar) : wt->rank(size, lastChar)) + 1;
                 INDEX_SIZE left = (*C)[lastChar] + num - 1;
                 INDEX_SIZE right = left;
                 output[p++] = CHARINTV(left, right, lastChar);
-                // r.push_back(CHARINTV(left, right, lastChar));
             }
 
             return p;
@@ -4,7 +4,9 @@
 #include <random>
 #include <algorithm>
 #include <set>
+#include <limits>
 #include "./beller_component.hpp"
+#include "./parallel_beller_component.hpp"
 #include "./lcp_info.hpp"
 #include "../bwt/bwt_functions.hpp"
 
@@ -36,8 +38,12 @@ namespace stool
         public:
             using INDEX = uint64_t;
             using INTERVAL = stool::LCPInterval<INDEX>;
-            LCPEnumerator(IntervalSearchDataStructure<uint8_t> *_range)
+            /*!
+             * @brief Constructs the enumerator on \p _range. If \p _queue_storage is not nullptr, the queues of Beller's algorithm use its memory budget.
+             */
+            LCPEnumerator(IntervalSearchDataStructure<uint8_t> *_range, IntervalQueueStorage *_queue_storage = nullptr)
             {
+                this->component.queue_storage = _queue_storage;
                 this->component.initialize(_range);
                 this->component.output_single_lcp_interval = true;
             }
@@ -143,31 +149,50 @@ namespace stool
                 return LCPIterator(nullptr, UINT64_MAX, LCPInfo(UINT64_MAX, UINT64_MAX));
             }
 
-            static std::vector<uint64_t> construct_LCP_array(const sdsl::int_vector<> &bwt, [[maybe_unused]]int message_paragraph = stool::Message::SHOW_MESSAGE)
+            /*!
+             * @brief Computes the LCP array from the BWT \p bwt by Beller's algorithm
+             *
+             * The queues of the algorithm use at most \p queue_memory_limit_bytes bytes of memory; the intervals beyond the limit are spilled to a temporary file in \p tmp_dir.
+             * \p LCP_INDEX must be able to represent the length of the BWT; the positions without an LCP value have the maximum value of \p LCP_INDEX.
+             */
+            template <typename LCP_INDEX = uint64_t>
+            static std::vector<LCP_INDEX> construct_LCP_array(const sdsl::int_vector<> &bwt, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1, IntervalSearchBackend backend = IntervalSearchBackend::WaveletTree, uint64_t queue_memory_limit_bytes = UINT64_MAX, const std::string &tmp_dir = ".")
             {
                 std::vector<uint64_t> C;
-                stool::bwt::BWTFunctions::construct_C_array(bwt, C);
-
-                sdsl::wt_huff<> wt;
-                construct_im(wt, bwt);
+                stool::bwt::BWTFunctions::construct_C_array(bwt, C, message_paragraph);
 
                 uint64_t lastChar = bwt[bwt.size() - 1];
 
+                sdsl::wt_huff<> wt;
+                stool::ByteRankDirectory rank_directory;
                 stool::IntervalSearchDataStructure<uint8_t> range;
-                range.initialize(&wt, &C, lastChar);
+                range.initialize(bwt, &wt, &rank_directory, &C, lastChar, backend);
 
-                LCPEnumerator comp(&range);
+                std::vector<LCP_INDEX> output;
+                output.resize(bwt.size(), std::numeric_limits<LCP_INDEX>::max());
 
-                std::vector<uint64_t> output;
-                output.resize(bwt.size(), UINT64_MAX);
+                IntervalQueueStorage queue_storage(queue_memory_limit_bytes, tmp_dir);
+                if (thread_count > 1)
+                {
+                    ParallelBellerComponent comp(&range, thread_count, ParallelBellerComponent::DEFAULT_BATCH_SIZE, &queue_storage);
+                    comp.enumerate_lcp_values([&](uint64_t, uint64_t position, uint64_t lcp)
+                                              { output[position] = (LCP_INDEX)lcp; });
+                    return output;
+                }
 
+                LCPEnumerator comp(&range, &queue_storage);
                 for (auto it = comp.begin(); it != comp.end(); it++)
                 {
-                    output[(*it).position] = (*it).lcp;
+                    output[(*it).position] = (LCP_INDEX)(*it).lcp;
                 }
                 return output;
             }
-            static std::vector<uint64_t> compute_lcp_statistics(const sdsl::int_vector<> &bwt, int message_paragraph = stool::Message::SHOW_MESSAGE)
+            /*!
+             * @brief Returns the histogram of the LCP values of the BWT \p bwt without storing the LCP array
+             *
+             * The queues of Beller's algorithm use at most \p queue_memory_limit_bytes bytes of memory; the intervals beyond the limit are spilled to a temporary file in \p tmp_dir.
+             */
+            static std::vector<uint64_t> compute_lcp_statistics(const sdsl::int_vector<> &bwt, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1, IntervalSearchBackend backend = IntervalSearchBackend::WaveletTree, uint64_t queue_memory_limit_bytes = UINT64_MAX, const std::string &tmp_dir = ".")
             {
 
                 if(message_paragraph != stool::Message::NO_MESSAGE){
@@ -177,29 +202,60 @@ namespace stool
                 std::vector<uint64_t> C;
                 stool::bwt::BWTFunctions::construct_C_array(bwt, C, stool::Message::increment_paragraph_level(message_paragraph));
 
-                sdsl::wt_huff<> wt;
+                uint64_t lastChar = bwt[bwt.size() - 1];
 
+                sdsl::wt_huff<> wt;
+                stool::ByteRankDirectory rank_directory;
+                stool::IntervalSearchDataStructure<uint8_t> range;
                 if(message_paragraph != stool::Message::NO_MESSAGE){
-                    std::cout << stool::Message::get_paragraph_string(message_paragraph+1) << "Constructing wavelet tree..." << std::flush;
+                    std::cout << stool::Message::get_paragraph_string(message_paragraph+1) << (backend == IntervalSearchBackend::ByteRankDirectory ? "Constructing rank directory..." : "Constructing wavelet tree...") << std::flush;
                 }
-                construct_im(wt, bwt);
+                range.initialize(bwt, &wt, &rank_directory, &C, lastChar, backend);
                 if(message_paragraph != stool::Message::NO_MESSAGE){
                     std::cout << "[DONE]" << std::endl;
                 }
 
-                uint64_t lastChar = bwt[bwt.size() - 1];
-
-                stool::IntervalSearchDataStructure<uint8_t> range;
-                range.initialize(&wt, &C, lastChar);
-
-                LCPEnumerator comp(&range);
-
-
                 if(message_paragraph != stool::Message::NO_MESSAGE){
                     std::cout << stool::Message::get_paragraph_string(message_paragraph+1) << "Computing LCP values..." << std::flush;
                 }
 
                 std::vector<uint64_t> r;
+                IntervalQueueStorage queue_storage(queue_memory_limit_bytes, tmp_dir);
+                if (thread_count > 1)
+                {
+                    // Every thread counts the LCP values in its own histogram, and the histograms are summed up at the end.
+                    std::vector<std::vector<uint64_t>> histograms(thread_count);
+                    ParallelBellerComponent comp(&range, thread_count, ParallelBellerComponent::DEFAULT_BATCH_SIZE, &queue_storage);
+                    comp.enumerate_lcp_values([&](uint64_t t, uint64_t, uint64_t lcp)
+                                              {
+                                                  auto &h = histograms[t];
+                                                  if (h.size() <= lcp)
+                                                  {
+                                                      h.resize(lcp + 1, 0);
+                                                  }
+                                                  h[lcp]++; });
+
+                    // The iterator of LCPEnumerator reports LCPInfo(0, 0) before the root interval, so it is counted here as well.
+                    r.push_back(1);
+                    for (auto &h : histograms)
+                    {
+                        if (r.size() < h.size())
+                        {
+                            r.resize(h.size(), 0);
+                        }
+                        for (uint64_t x = 0; x < h.size(); x++)
+                        {
+                            r[x] += h[x];
+                        }
+                    }
+                    if(message_paragraph != stool::Message::NO_MESSAGE){
+                        std::cout << "[DONE]" << std::endl;
+                        std::cout << "\r" << stool::Message::get_paragraph_string(message_paragraph) << "Computing LCP statistics[DONE]" << std::endl;
+                    }
+                    return r;
+                }
+
+                LCPEnumerator comp(&range, &queue_storage);
                 uint64_t counter = 0;
                 for (auto it = comp.begin(); it != comp.end(); it++)
                 {
@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <set>
 #include "./beller_component.hpp"
+#include "./lcp_enumerator.hpp"
+#include "../strings/lcp_interval_tree_traversal.hpp"
 
 namespace stool
 {
@@ -35,8 +37,12 @@ namespace stool
         public:
             using INDEX = uint64_t;
             using INTERVAL = stool::LCPInterval<INDEX>;
-            LCPIntervalEnumerator(IntervalSearchDataStructure<uint8_t> *_range)
+            /*!
+             * @brief Constructs the enumerator on \p _range. If \p _queue_storage is not nullptr, the queues of Beller's algorithm use its memory budget.
+             */
+            LCPIntervalEnumerator(IntervalSearchDataStructure<uint8_t> *_range, IntervalQueueStorage *_queue_storage = nullptr)
             {
+                this->component.queue_storage = _queue_storage;
                 this->component.initialize(_range);
             }
 
@@ -128,24 +134,44 @@ namespace stool
                 return LCPIntervalIterator(nullptr, UINT64_MAX, LCPInterval<INDEX>(UINT64_MAX, UINT64_MAX, UINT64_MAX));
             }
 
-            static std::vector<INTERVAL> compute_lcp_intervals(const sdsl::int_vector<> &bwt, [[maybe_unused]]int message_paragraph = stool::Message::NO_MESSAGE)
+            /*!
+             * @brief Visits the LCP intervals of the BWT \p bwt in depth-first order without storing them
+             *
+             * The LCP array is computed by LCPEnumerator::construct_LCP_array, and the tree is traversed by LCPIntervalTreeTraversal
+             * (see LCPIntervalTreeTraversal::traverse for the callbacks and the pruning parameters).
+             * The LCP array and the child table are stored in memory, i.e., this function uses 2n integers of type \p LCP_INDEX (O(n) words) for a BWT of length n,
+             * so uint32_t halves the space if n is less than 2^32.
+             */
+            template <typename LCP_INDEX = uint64_t, typename ENTER, typename LEAVE>
+            static void traverse_lcp_interval_tree(const sdsl::int_vector<> &bwt, ENTER on_enter, LEAVE on_leave, uint64_t min_frequency = 2, uint64_t max_lcp = UINT64_MAX, int message_paragraph = stool::Message::NO_MESSAGE, uint64_t thread_count = 1, IntervalSearchBackend backend = IntervalSearchBackend::WaveletTree, uint64_t queue_memory_limit_bytes = UINT64_MAX, const std::string &tmp_dir = ".")
+            {
+                std::vector<LCP_INDEX> lcp_array = LCPEnumerator::construct_LCP_array<LCP_INDEX>(bwt, message_paragraph, thread_count, backend, queue_memory_limit_bytes, tmp_dir);
+                stool::LCPIntervalTreeTraversal<LCP_INDEX>::traverse(lcp_array, on_enter, on_leave, min_frequency, max_lcp);
+            }
+
+            /*!
+             * @brief Returns the LCP intervals of the BWT \p bwt
+             *
+             * The queues of Beller's algorithm use at most \p queue_memory_limit_bytes bytes of memory; the intervals beyond the limit are spilled to a temporary file in \p tmp_dir.
+             */
+            static std::vector<INTERVAL> compute_lcp_intervals(const sdsl::int_vector<> &bwt, int message_paragraph = stool::Message::NO_MESSAGE, IntervalSearchBackend backend = IntervalSearchBackend::WaveletTree, uint64_t queue_memory_limit_bytes = UINT64_MAX, const std::string &tmp_dir = ".")
             {
                 if(bwt.width() != 8){
                     throw std::runtime_error("BWT must be 8-bit encoded.");
                 }
                 std::vector<uint64_t> C;
-                stool::bwt::BWTFunctions::construct_C_array(bwt, C);
+                stool::bwt::BWTFunctions::construct_C_array(bwt, C, message_paragraph);
 
 
-                sdsl::wt_huff<> wt;
-                construct_im(wt, bwt);
-
                 uint64_t lastChar = bwt[bwt.size() - 1];
 
+                sdsl::wt_huff<> wt;
+                stool::ByteRankDirectory rank_directory;
                 stool::IntervalSearchDataStructure<uint8_t> range;
-                range.initialize(&wt, &C, lastChar);
+                range.initialize(bwt, &wt, &rank_directory, &C, lastChar, backend);
 
-                LCPIntervalEnumerator comp(&range);
+                IntervalQueueStorage queue_storage(queue_memory_limit_bytes, tmp_dir);
+                LCPIntervalEnumerator comp(&range, &queue_storage);
 
                 std::vector<INTERVAL> output;
                 for (auto it = comp.begin(); it != comp.end(); it++)
@@ -0,0 +1,535 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <atomic>
+#include <algorithm>
+#include "./beller_small_component.hpp"
+#include "./compact_interval_queue.hpp"
+#include "../basic/parallel_functions.hpp"
+
+namespace stool
+{
+    namespace beller
+    {
+        /*!
+         * @brief A multi-threaded version of BellerComponent that enumerates the LCP values of a BWT
+         *
+         * Beller's algorithm processes the intervals of the suffix array level by level, where the intervals of level l represent
+         * the strings of length l. As in BellerComponent, the intervals are stored in a CompactIntervalQueue per character, and
+         * the queues share the memory budget of an IntervalQueueStorage if one is given.
+         *
+         * The checks of BellerComponent::process depend on the order of the intervals of a level. The queues hold the intervals of a level in the order of their strings,
+         * so their boundaries are usually non-decreasing, and then the checks reduce to local ones: an interval is new if the bit of its right boundary has not been set
+         * and the previous interval has another right boundary, and an interval that is not new is expanded if its left boundary is the right boundary plus one of
+         * the last new interval and the previous interval is new or has another left boundary. The threads verify the order, and thread 0 falls back to the sequential checks
+         * for the rest of the level if it does not hold.
+         *
+         * The threads are created once by a single ParallelFunctions::parallel_for_ranges call and work in phases separated by a ThreadBarrier.
+         * A level is split into the fewest windows of at most window_size intervals, and each window is processed in four phases:
+         * the threads pop the intervals of the characters assigned to them, report the LCP values and check the new intervals,
+         * expand the intervals (the rank queries dominate the running time), and push the children to the queues of the characters assigned to them.
+         * The batches of the middle phases have at most batch_size intervals and are handed out through a shared counter.
+         * The intervals of the next level are pushed to the queues in the same order as BellerComponent, so the enumerated
+         * (position, LCP) pairs are the same as those of the sequential LCPEnumerator.
+         */
+        class ParallelBellerComponent
+        {
+        public:
+            using INDEX = uint64_t;
+            using INTERVAL = stool::LCPInterval<INDEX>;
+
+            /** @brief The default maximum number of intervals in a batch */
+            static inline constexpr uint64_t DEFAULT_BATCH_SIZE = 4096;
+
+            /** @brief The default maximum number of intervals in a window (24 bytes per interval in memory) */
+            static inline constexpr uint64_t DEFAULT_WINDOW_SIZE = 1ULL << 20;
+
+            /** @brief The batches of a window are made smaller for small windows, so that every thread gets at least this number of batches */
+            static inline constexpr uint64_t MIN_BATCHES_PER_THREAD = 4;
+
+            /** @brief The number of intervals between the interval being expanded and the interval being prefetched */
+            static inline constexpr uint64_t PREFETCH_DISTANCE = 8;
+
+        private:
+            /*!
+             * @brief An interval of the next level with the character prepended to its string
+             */
+            struct ChildInterval
+            {
+                INTERVAL interval;
+                uint8_t c;
+            };
+
+            /*!
+             * @brief The children of a batch sorted by their characters, where the children of c are children[offsets[c]..offsets[c+1]-1]
+             */
+            struct BatchChildren
+            {
+                std::vector<INTERVAL> children;
+                std::vector<uint64_t> offsets;
+            };
+
+            /*!
+             * @brief The buffers used by a thread
+             */
+            struct ThreadWorkspace
+            {
+                std::vector<uint8_t> cs;
+                std::vector<uint64_t> cs1;
+                std::vector<uint64_t> cs2;
+                std::vector<CharInterval<INDEX, uint8_t>> char_intervals;
+                std::vector<ChildInterval> children;
+
+                ThreadWorkspace()
+                {
+                    uint64_t CHARMAX = UINT8_MAX + 1;
+                    this->cs.resize(CHARMAX, 0);
+                    this->cs1.resize(CHARMAX, 0);
+                    this->cs2.resize(CHARMAX, 0);
+                    this->char_intervals.resize(CHARMAX);
+                }
+            };
+
+            IntervalSearchDataStructure<uint8_t> *range = nullptr;
+            IntervalQueueStorage *queue_storage = nullptr;
+            uint64_t thread_count = 1;
+            uint64_t batch_size = DEFAULT_BATCH_SIZE;
+            uint64_t window_size = DEFAULT_WINDOW_SIZE;
+
+            // Bit vectors shared by the threads; distinct threads may update distinct bits of the same word.
+            std::vector<uint64_t> checker;
+            std::vector<uint64_t> lcp_checker;
+
+            /*!
+             * @brief Returns the i-th bit
+             */
+            static bool get_bit(const std::vector<uint64_t> &bits, uint64_t i)
+            {
+                return (__atomic_load_n(&bits[i / 64], __ATOMIC_RELAXED) >> (i % 64)) & 1;
+            }
+
+            /*!
+             * @brief Sets the i-th bit and returns its previous value
+             */
+            static bool test_and_set_bit(std::vector<uint64_t> &bits, uint64_t i)
+            {
+                uint64_t mask = 1ULL << (i % 64);
+                return (__atomic_fetch_or(&bits[i / 64], mask, __ATOMIC_RELAXED) & mask) != 0;
+            }
+
+            /*!
+             * @brief Appends the intervals of the strings cw to \p output, where w is the string represented by \p intv
+             */
+            void expand(const INTERVAL &intv, ThreadWorkspace &ws, std::vector<ChildInterval> &output) const
+            {
+                uint64_t charIntvCount = this->range->getIntervals(intv.i, intv.j, ws.char_intervals, ws.cs, ws.cs1, ws.cs2);
+                for (uint64_t x = 0; x < charIntvCount; x++)
+                {
+                    auto &civ = ws.char_intervals[x];
+                    output.push_back(ChildInterval{INTERVAL(civ.i, civ.j, intv.lcp + 1), civ.c});
+                }
+            }
+
+            /*!
+             * @brief Moves \p children to \p output sorted stably by their characters
+             */
+            static void sort_children(std::vector<ChildInterval> &children, BatchChildren &output)
+            {
+                uint64_t CHARMAX = UINT8_MAX + 1;
+                output.offsets.assign(CHARMAX + 1, 0);
+                for (const ChildInterval &child : children)
+                {
+                    output.offsets[child.c + 1]++;
+                }
+                for (uint64_t c = 0; c < CHARMAX; c++)
+                {
+                    output.offsets[c + 1] += output.offsets[c];
+                }
+                output.children.resize(children.size());
+                std::vector<uint64_t> &positions = output.offsets;
+                for (const ChildInterval &child : children)
+                {
+                    output.children[positions[child.c]++] = child.interval;
+                }
+                // positions[c] is now the end of the children of c, i.e., the beginning of the children of c + 1.
+                for (uint64_t c = CHARMAX; c > 0; c--)
+                {
+                    positions[c] = positions[c - 1];
+                }
+                positions[0] = 0;
+                children.clear();
+            }
+
+            /*!
+             * @brief Assigns every character with a positive count to a thread, balancing the sums of the counts of the threads greedily
+             */
+            static void assign_characters(const std::vector<uint64_t> &counts, uint64_t thread_count, std::vector<uint64_t> &owners)
+            {
+                std::vector<uint64_t> chars;
+                for (uint64_t c = 0; c < counts.size(); c++)
+                {
+                    if (counts[c] > 0)
+                    {
+                        chars.push_back(c);
+                    }
+                }
+                std::stable_sort(chars.begin(), chars.end(), [&](uint64_t x, uint64_t y)
+                                 { return counts[x] > counts[y]; });
+                std::vector<uint64_t> loads(thread_count, 0);
+                owners.assign(counts.size(), UINT64_MAX);
+                for (uint64_t c : chars)
+                {
+                    uint64_t t = std::min_element(loads.begin(), loads.end()) - loads.begin();
+                    owners[c] = t;
+                    loads[t] += counts[c];
+                }
+            }
+
+        public:
+            /*!
+             * @brief Constructs the component on \p _range using \p _thread_count threads
+             *
+             * A level is processed in windows of at most \p _window_size intervals, and the windows in batches of at most \p _batch_size intervals.
+             * If \p _queue_storage is not nullptr, the queues of the intervals use its memory budget.
+             */
+            ParallelBellerComponent(IntervalSearchDataStructure<uint8_t> *_range, uint64_t _thread_count, uint64_t _batch_size = DEFAULT_BATCH_SIZE, IntervalQueueStorage *_queue_storage = nullptr, uint64_t _window_size = DEFAULT_WINDOW_SIZE) : range(_range), queue_storage(_queue_storage), thread_count(std::max(_thread_count, (uint64_t)1)), batch_size(std::max(_batch_size, (uint64_t)1)), window_size(std::max(_window_size, (uint64_t)1))
+            {
+            }
+
+            /*!
+             * @brief Calls \p func(t, position, lcp) for every LCP value reported by LCPEnumerator
+             *
+             * \p func is called concurrently by the threads, and \p t in [0, thread_count) is the ID of the calling thread.
+             * The order of the calls is not specified.
+             */
+            template <typename FUNC>
+            void enumerate_lcp_values(FUNC func)
+            {
+                uint64_t bwtSize = this->range->get_text_size();
+                uint64_t CHARMAX = UINT8_MAX + 1;
+                uint64_t p = this->thread_count;
+                this->checker.clear();
+                this->checker.resize((bwtSize + 1 + 63) / 64, 0);
+                this->lcp_checker.clear();
+                this->lcp_checker.resize((bwtSize + 63) / 64, 0);
+
+                std::vector<CompactIntervalQueue> queues;
+                queues.reserve(CHARMAX);
+                for (uint64_t c = 0; c < CHARMAX; c++)
+                {
+                    queues.emplace_back(this->queue_storage);
+                }
+
+                // The root interval and the intervals of the first level (see BellerComponent::first_process).
+                func((uint64_t)0, (uint64_t)0, (uint64_t)0);
+                std::vector<ThreadWorkspace> workspaces(p);
+                this->expand(INTERVAL(0, bwtSize - 1, 0), workspaces[0], workspaces[0].children);
+                for (const ChildInterval &child : workspaces[0].children)
+                {
+                    queues[child.c].push(child.interval);
+                }
+                workspaces[0].children.clear();
+
+                // The state shared by the threads. It is updated by thread 0 between the barriers.
+                std::vector<uint64_t> level_counts(CHARMAX, 0);
+                std::vector<uint64_t> window_counts(CHARMAX, 0);
+                std::vector<uint64_t> window_offsets(CHARMAX, 0);
+                std::vector<uint64_t> child_counts(CHARMAX, 0);
+                std::vector<uint64_t> pop_owners, push_owners;
+                std::vector<INTERVAL> window;
+                std::vector<uint8_t> is_candidate, is_new, is_expanded;
+                std::vector<uint64_t> batch_last_new, batch_last_idx;
+                std::vector<BatchChildren> batch_children;
+                uint64_t level_size = 0;
+                uint64_t window_count = 0;
+                uint64_t window_capacity = 0;
+                uint64_t m = 0;
+                uint64_t current_batch_size = 1;
+                uint64_t batch_count = 0;
+                // The last interval of the previous windows of the level, and the right boundary plus one of the last new interval of the level.
+                bool has_previous = false;
+                bool previous_is_new = false;
+                INTERVAL previous;
+                uint64_t last_new_position = UINT64_MAX;
+                // The last_idx of BellerComponent::process after the previous windows of the level.
+                uint64_t last_idx = UINT64_MAX;
+                bool level_is_sorted = true;
+                std::atomic<bool> window_is_sorted(true);
+                std::atomic<uint64_t> next_check_batch(0);
+                std::atomic<uint64_t> next_new_batch(0);
+                std::atomic<uint64_t> next_expand_batch(0);
+                stool::ThreadBarrier barrier(p);
+
+                stool::ParallelFunctions::parallel_for_ranges(p, p, [&](uint64_t t, uint64_t, uint64_t)
+                                                              {
+                    ThreadWorkspace &ws = workspaces[t];
+                    while (true)
+                    {
+                        if (t == 0)
+                        {
+                            // The intervals of the current level are the intervals in the queues.
+                            level_size = 0;
+                            for (uint64_t c = 0; c < CHARMAX; c++)
+                            {
+                                level_counts[c] = queues[c].size();
+                                level_size += level_counts[c];
+                            }
+                            window_count = (level_size + this->window_size - 1) / this->window_size;
+                            window_capacity = window_count == 0 ? 0 : (level_size + window_count - 1) / window_count;
+                            has_previous = false;
+                            previous_is_new = false;
+                            last_new_position = UINT64_MAX;
+                            last_idx = UINT64_MAX;
+                            level_is_sorted = true;
+                        }
+                        barrier.wait();
+                        // Thread 0 updates the shared state of the next level while the other threads may still be in this loop, so they use copies.
+                        uint64_t current_level_size = level_size;
+                        uint64_t current_window_count = window_count;
+                        barrier.wait();
+                        if (current_level_size == 0)
+                        {
+                            break;
+                        }
+
+                        for (uint64_t w = 0; w < current_window_count; w++)
+                        {
+                            if (t == 0)
+                            {
+                                // The window takes the next intervals of the level in the order of the characters.
+                                m = 0;
+                                for (uint64_t c = 0; c < CHARMAX; c++)
+                                {
+                                    window_offsets[c] = m;
+                                    window_counts[c] = std::min(level_counts[c], window_capacity - m);
+                                    level_counts[c] -= window_counts[c];
+                                    m += window_counts[c];
+                                }
+                                assign_characters(window_counts, p, pop_owners);
+                                window.resize(m);
+                                is_candidate.resize(m);
+                                is_new.resize(m);
+                                is_expanded.resize(m);
+                                current_batch_size = std::max(std::min(this->batch_size, m / (p * MIN_BATCHES_PER_THREAD)), (uint64_t)1);
+                                batch_count = (m + current_batch_size - 1) / current_batch_size;
+                                if (batch_children.size() < batch_count)
+                                {
+                                    batch_children.resize(batch_count);
+                                }
+                                batch_last_new.resize(batch_count);
+                                batch_last_idx.resize(batch_count);
+                                window_is_sorted.store(true);
+                                next_check_batch.store(0);
+                                next_new_batch.store(0);
+                                next_expand_batch.store(0);
+                            }
+                            barrier.wait();
+
+                            // Phase 1: the threads pop the intervals of their characters.
+                            for (uint64_t c = 0; c < CHARMAX; c++)
+                            {
+                                if (pop_owners[c] == t)
+                                {
+                                    for (uint64_t x = 0; x < window_counts[c]; x++)
+                                    {
+                                        window[window_offsets[c] + x] = queues[c].front();
+                                        queues[c].pop();
+                                    }
+                                }
+                            }
+                            barrier.wait();
+
+                            // Phase 2: reports the LCP values, reads the bits set by the previous windows, and checks whether the boundaries are non-decreasing.
+                            while (true)
+                            {
+                                uint64_t b = next_check_batch.fetch_add(1, std::memory_order_relaxed);
+                                if (b >= batch_count)
+                                {
+                                    break;
+                                }
+                                uint64_t end = std::min(m, (b + 1) * current_batch_size);
+                                for (uint64_t k = b * current_batch_size; k < end; k++)
+                                {
+                                    const INTERVAL &top = window[k];
+                                    is_candidate[k] = get_bit(this->checker, top.j + 1) ? 0 : 1;
+                                    if (!test_and_set_bit(this->lcp_checker, top.i))
+                                    {
+                                        func(t, (uint64_t)top.i, (uint64_t)(top.lcp == 0 ? 0 : top.lcp - 1));
+                                    }
+                                    if (k > 0 || has_previous)
+                                    {
+                                        const INTERVAL &prev = k > 0 ? window[k - 1] : previous;
+                                        if (top.i < prev.i || top.j < prev.j)
+                                        {
+                                            window_is_sorted.store(false, std::memory_order_relaxed);
+                                        }
+                                    }
+                                }
+                            }
+                            barrier.wait();
+
+                            // Phase 3: if the boundaries of the level are non-decreasing, the intervals with the same right boundary are adjacent,
+                            // and an interval is new if it is a candidate and the previous interval has another right boundary.
+                            bool is_sorted = level_is_sorted && window_is_sorted.load();
+                            while (is_sorted)
+                            {
+                                uint64_t b = next_new_batch.fetch_add(1, std::memory_order_relaxed);
+                                if (b >= batch_count)
+                                {
+                                    break;
+                                }
+                                uint64_t end = std::min(m, (b + 1) * current_batch_size);
+                                batch_last_new[b] = UINT64_MAX;
+                                for (uint64_t k = b * current_batch_size; k < end; k++)
+                                {
+                                    const INTERVAL &top = window[k];
+                                    bool same_as_previous = k > 0 ? window[k - 1].j == top.j : (has_previous && previous.j == top.j);
+                                    is_new[k] = is_candidate[k] && !same_as_previous ? 1 : 0;
+                                    if (is_new[k])
+                                    {
+                                        test_and_set_bit(this->checker, top.j + 1);
+                                        batch_last_new[b] = k;
+                                    }
+                                }
+                            }
+                            barrier.wait();
+
+                            if (t == 0)
+                            {
+                                if (is_sorted)
+                                {
+                                    // The right boundary plus one of the last new interval before each batch.
+                                    for (uint64_t b = 0; b < batch_count; b++)
+                                    {
+                                        batch_last_idx[b] = last_new_position;
+                                        if (batch_last_new[b] != UINT64_MAX)
+                                        {
+                                            last_new_position = window[batch_last_new[b]].j + 1;
+                                        }
+                                    }
+                                }
+                                else
+                                {
+                                    // The checks of BellerComponent::process in the order of the intervals.
+                                    for (uint64_t k = 0; k < m; k++)
+                                    {
+                                        const INTERVAL &top = window[k];
+                                        is_new[k] = is_candidate[k] && !test_and_set_bit(this->checker, top.j + 1) ? 1 : 0;
+                                        is_expanded[k] = is_new[k];
+                                        if (is_new[k])
+                                        {
+                                            last_idx = top.j + 1;
+                                        }
+                                        else if (top.i == last_idx)
+                                        {
+                                            is_expanded[k] = 1;
+                                            last_idx = UINT64_MAX;
+                                        }
+                                    }
+                                }
+                            }
+                            barrier.wait();
+
+                            // Phase 4: expands the new intervals and the first interval after each new interval whose left boundary is the right boundary plus one of the new interval.
+                            // If the boundaries are non-decreasing, such an interval is either preceded by the new interval or by an interval with another left boundary.
+                            while (true)
+                            {
+                                uint64_t b = next_expand_batch.fetch_add(1, std::memory_order_relaxed);
+                                if (b >= batch_count)
+                                {
+                                    break;
+                                }
+                                uint64_t end = std::min(m, (b + 1) * current_batch_size);
+                                uint64_t next_position = is_sorted ? batch_last_idx[b] : UINT64_MAX;
+                                for (uint64_t k = b * current_batch_size; k < end; k++)
+                                {
+                                    if (k + PREFETCH_DISTANCE < end)
+                                    {
+                                        const INTERVAL &ahead = window[k + PREFETCH_DISTANCE];
+                                        this->range->prefetch(ahead.i, ahead.j);
+                                    }
+                                    const INTERVAL &top = window[k];
+                                    if (is_sorted)
+                                    {
+                                        if (is_new[k])
+                                        {
+                                            is_expanded[k] = 1;
+                                            next_position = top.j + 1;
+                                        }
+                                        else
+                                        {
+                                            bool prev_is_new = k > 0 ? is_new[k - 1] : previous_is_new;
+                                            uint64_t prev_i = k > 0 ? window[k - 1].i : previous.i;
+                                            is_expanded[k] = next_position == top.i && (prev_is_new || prev_i != top.i) ? 1 : 0;
+                                        }
+                                    }
+                                    if (is_expanded[k])
+                                    {
+                                        this->expand(top, ws, ws.children);
+                                    }
+                                }
+                                sort_children(ws.children, batch_children[b]);
+                            }
+                            barrier.wait();
+
+                            if (t == 0)
+                            {
+                                if (is_sorted)
+                                {
+                                    // last_idx is the right boundary plus one of the last new interval unless an interval after it has been expanded.
+                                    bool consumed = false;
+                                    uint64_t k = m;
+                                    while (k > 0 && !is_new[k - 1])
+                                    {
+                                        k--;
+                                        consumed = consumed || is_expanded[k];
+                                    }
+                                    if (k > 0)
+                                    {
+                                        last_idx = window[k - 1].j + 1;
+                                    }
+                                    if (consumed)
+                                    {
+                                        last_idx = UINT64_MAX;
+                                    }
+                                }
+                                level_is_sorted = is_sorted;
+                                has_previous = true;
+                                previous = window[m - 1];
+                                previous_is_new = is_new[m - 1];
+
+                                std::fill(child_counts.begin(), child_counts.end(), 0);
+                                for (uint64_t b = 0; b < batch_count; b++)
+                                {
+                                    const std::vector<uint64_t> &offsets = batch_children[b].offsets;
+                                    for (uint64_t c = 0; c < CHARMAX; c++)
+                                    {
+                                        child_counts[c] += offsets[c + 1] - offsets[c];
+                                    }
+                                }
+                                assign_characters(child_counts, p, push_owners);
+                            }
+                            barrier.wait();
+
+                            // Phase 5: the threads push the children of their characters in the order of the batches.
+                            for (uint64_t c = 0; c < CHARMAX; c++)
+                            {
+                                if (push_owners[c] == t)
+                                {
+                                    for (uint64_t b = 0; b < batch_count; b++)
+                                    {
+                                        const BatchChildren &bc = batch_children[b];
+                                        for (uint64_t x = bc.offsets[c]; x < bc.offsets[c + 1]; x++)
+                                        {
+                                            queues[c].push(bc.children[x]);
+                                        }
+                                    }
+                                }
+                            }
+                            barrier.wait();
+                        }
+                    } });
+            }
+        };
+    } // namespace beller
+} // namespace stool
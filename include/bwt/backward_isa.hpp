@@ -4,6 +4,7 @@
 #include <random>
 #include <algorithm>
 #include <unordered_set>
+#include "./parallel_lf_walk.hpp"
 
 namespace stool
 {
@@ -172,13 +173,21 @@ namespace stool
        * Iterates through all positions and constructs the complete inverse suffix array
        * by filling the result vector in reverse order.
        * 
+       * If \p thread_count > 1, the LF walks are performed in parallel by ParallelLFWalk (LF_DATA_STRUCTURE::lf must be thread-safe).
+       *
        * @return Vector containing the complete inverse suffix array
        */
-      std::vector<INDEX> to_isa() const
+      std::vector<INDEX> to_isa(uint64_t thread_count = 1) const
       {
         std::vector<INDEX> r;
         INDEX size = this->_str_size;
         r.resize(size);
+        if (thread_count > 1)
+        {
+          ParallelLFWalk::walk(*this->_lfds, this->_end_marker_position_in_BWT, size, thread_count, [&](uint64_t, uint64_t text_position, uint64_t bwt_position)
+                               { r[text_position] = bwt_position; });
+          return r;
+        }
         INDEX p = size;
         for (INDEX c : *this)
         {
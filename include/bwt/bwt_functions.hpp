@@ -12,8 +12,13 @@
 #include <sdsl/wt_algorithm.hpp>
 
 #include <queue>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <type_traits>
 #include "../strings/array_constructor.hpp"
 #include "../debug/debug_printer.hpp"
+#include "../basic/parallel_functions.hpp"
 
 
 namespace stool
@@ -49,32 +54,120 @@ namespace stool
                 return C[c] + cNum;
             }
 
+            /**
+             * @brief Adds the number of the occurrences of each character in \p data[0..\p size-1] to \p counts[0..255]
+             *
+             * The characters are read eight at a time and counted in four sub-histograms in turn,
+             * so that the increments of consecutive equal characters (e.g., a run of the BWT) do not wait for each other through the memory.
+             */
+            static void count_characters(const uint8_t *data, uint64_t size, uint64_t *counts)
+            {
+                constexpr uint64_t CHARMAX = UINT8_MAX + 1;
+                std::array<uint64_t, CHARMAX * 4> sub_counts;
+                sub_counts.fill(0);
+                uint64_t *h0 = &sub_counts[0];
+                uint64_t *h1 = &sub_counts[CHARMAX];
+                uint64_t *h2 = &sub_counts[CHARMAX * 2];
+                uint64_t *h3 = &sub_counts[CHARMAX * 3];
+
+                uint64_t i = 0;
+                for (; i + 8 <= size; i += 8)
+                {
+                    uint64_t w;
+                    std::memcpy(&w, data + i, sizeof(uint64_t));
+                    h0[w & 0xFF]++;
+                    h1[(w >> 8) & 0xFF]++;
+                    h2[(w >> 16) & 0xFF]++;
+                    h3[(w >> 24) & 0xFF]++;
+                    h0[(w >> 32) & 0xFF]++;
+                    h1[(w >> 40) & 0xFF]++;
+                    h2[(w >> 48) & 0xFF]++;
+                    h3[w >> 56]++;
+                }
+                for (; i < size; i++)
+                {
+                    h0[data[i]]++;
+                }
+                for (uint64_t c = 0; c < CHARMAX; c++)
+                {
+                    counts[c] += h0[c] + h1[c] + h2[c] + h3[c];
+                }
+            }
+
+            /**
+             * @brief Returns the number of the occurrences of each character in \p data[0..\p size-1], counted by \p thread_count threads
+             */
+            static std::vector<uint64_t> count_characters(const uint8_t *data, uint64_t size, uint64_t thread_count)
+            {
+                constexpr uint64_t CHARMAX = UINT8_MAX + 1;
+                uint64_t range_count = stool::ParallelFunctions::get_range_count(size, thread_count);
+                std::vector<uint64_t> local_counts(range_count * CHARMAX, 0);
+                stool::ParallelFunctions::parallel_for_ranges(size, thread_count, [&](uint64_t t, uint64_t begin, uint64_t end)
+                                                              { count_characters(data + begin, end - begin, &local_counts[t * CHARMAX]); });
+                std::vector<uint64_t> counts(CHARMAX, 0);
+                for (uint64_t t = 0; t < range_count; t++)
+                {
+                    for (uint64_t c = 0; c < CHARMAX; c++)
+                    {
+                        counts[c] += local_counts[t * CHARMAX + c];
+                    }
+                }
+                return counts;
+            }
+
             /**
              * @brief Constructs the LF (Last-to-First) array for a given BWT
              * 
              * The LF array maps each position in the BWT to its corresponding position
              * in the original text, enabling efficient backward traversal.
+             *
+             * The BWT is divided into \p thread_count chunks. The characters of each chunk are counted, and then
+             * each chunk is scanned independently from the prefix sums of the counts (LF[i] = C[c] + the occurrences of c before the chunk + the occurrences of c in the chunk before i).
              * 
+             * @tparam INDEX The type of the output values (e.g., uint32_t halves the output for a BWT shorter than 2^32)
              * @param bwt The Burrows-Wheeler Transform as a vector of bytes
              * @param C The C array containing cumulative character counts
              * @param message_paragraph The message level for progress reporting
+             * @param thread_count The number of threads
              * @return A vector containing the LF mapping for each position
              */
-            static std::vector<uint64_t> construct_LF_array(const std::vector<uint8_t> &bwt, const std::vector<uint64_t> &C, int message_paragraph = stool::Message::SHOW_MESSAGE)
+            template <typename INDEX = uint64_t>
+            static std::vector<INDEX> construct_LF_array(const std::vector<uint8_t> &bwt, const std::vector<uint64_t> &C, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
             {
                 if(message_paragraph != stool::Message::NO_MESSAGE){
                     std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Constructing LF array..." << std::flush;
                 }
+                if (bwt.size() > 0 && bwt.size() - 1 > (uint64_t)std::numeric_limits<INDEX>::max())
+                {
+                    throw std::runtime_error("construct_LF_array: the BWT is too long for the index type");
+                }
 
-                std::vector<uint64_t> rank_array;
-                rank_array.resize(C.size(), 0);
-
-                std::vector<uint64_t> LF;
-                LF.resize(bwt.size(), 0);
-                for(uint64_t i = 0; i < bwt.size(); i++){
-                    LF[i] = C[bwt[i]] + rank_array[bwt[i]];
-                    rank_array[bwt[i]]++;                    
+                constexpr uint64_t CHARMAX = UINT8_MAX + 1;
+                uint64_t n = bwt.size();
+                uint64_t range_count = stool::ParallelFunctions::get_range_count(n, thread_count);
+                std::vector<uint64_t> next_values(range_count * CHARMAX, 0);
+                stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t begin, uint64_t end)
+                                                              { count_characters(bwt.data() + begin, end - begin, &next_values[t * CHARMAX]); });
+                for (uint64_t c = 0; c < CHARMAX; c++)
+                {
+                    uint64_t sum = c < C.size() ? C[c] : 0;
+                    for (uint64_t t = 0; t < range_count; t++)
+                    {
+                        uint64_t count = next_values[t * CHARMAX + c];
+                        next_values[t * CHARMAX + c] = sum;
+                        sum += count;
+                    }
                 }
+
+                std::vector<INDEX> LF;
+                LF.resize(n);
+                stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t begin, uint64_t end)
+                                                              {
+                                                                  uint64_t *next = &next_values[t * CHARMAX];
+                                                                  for (uint64_t i = begin; i < end; i++)
+                                                                  {
+                                                                      LF[i] = next[bwt[i]]++;
+                                                                  } });
                 if(message_paragraph != stool::Message::NO_MESSAGE){
                     std::cout << "[DONE]" << std::endl;
                 }
@@ -88,23 +181,31 @@ namespace stool
              * The FL array is the inverse of the LF array, mapping positions in the original text
              * back to positions in the BWT.
              * 
+             * Since the LF array is a permutation, the threads write disjoint positions.
+             * 
+             * @tparam INDEX The type of the values of the LF array and the output
              * @param bwt The Burrows-Wheeler Transform as a vector of bytes
              * @param lf_array The pre-computed LF array
              * @param message_paragraph The message level for progress reporting
+             * @param thread_count The number of threads
              * @return A vector containing the FL mapping for each position
              */
-            static std::vector<uint64_t> construct_FL_array(const std::vector<uint8_t> &bwt, const std::vector<uint64_t> &lf_array, int message_paragraph = stool::Message::SHOW_MESSAGE)
+            template <typename INDEX = uint64_t>
+            static std::vector<INDEX> construct_FL_array(const std::vector<uint8_t> &bwt, const std::vector<INDEX> &lf_array, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
             {
                 if(message_paragraph != stool::Message::NO_MESSAGE){
                     std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Constructing FL array..." << std::flush;
                 }
 
-                std::vector<uint64_t> fl_array;
+                std::vector<INDEX> fl_array;
                 fl_array.resize(bwt.size(), 0);
 
-                for(uint64_t i = 0; i < bwt.size(); i++){
-                    fl_array[lf_array[i]] = i;
-                }
+                stool::ParallelFunctions::parallel_for_ranges(bwt.size(), thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+                                                              {
+                                                                  for (uint64_t i = begin; i < end; i++)
+                                                                  {
+                                                                      fl_array[lf_array[i]] = i;
+                                                                  } });
                 if(message_paragraph != stool::Message::NO_MESSAGE){
                     std::cout << "[DONE]" << std::endl;
                 }
@@ -123,20 +224,41 @@ namespace stool
              * @param text The input text to analyze
              * @param output The output C array to be populated
              * @param message_paragraph The message level for progress reporting
+             * @param thread_count The number of threads used for a byte vector (std::vector<uint8_t> or sdsl::int_vector<> of width 8)
              */
             template <typename TEXT, typename OUTPUT>
-            static void construct_C_array(TEXT &text, OUTPUT &output, int message_paragraph = stool::Message::SHOW_MESSAGE)
+            static void construct_C_array(TEXT &text, OUTPUT &output, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
             {
                 if(message_paragraph != stool::Message::NO_MESSAGE){
                     std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Constructing C array..." << std::flush;
                 }
 
+                using TEXT_TYPE = std::remove_cv_t<TEXT>;
                 uint64_t CHARMAX = UINT8_MAX + 1;
                 output.resize(CHARMAX, 0);
                 std::vector<uint64_t> tmp;
-                tmp.resize(CHARMAX, 0);
-                for(uint64_t i = 0; i < text.size(); i++){
-                    tmp[text[i]]++;
+                const uint8_t *bytes = nullptr;
+                if constexpr (std::is_same_v<TEXT_TYPE, std::vector<uint8_t>>)
+                {
+                    bytes = text.data();
+                }
+                else if constexpr (std::is_same_v<TEXT_TYPE, sdsl::int_vector<>>)
+                {
+                    if (text.width() == 8)
+                    {
+                        bytes = reinterpret_cast<const uint8_t *>(text.data());
+                    }
+                }
+                if (bytes != nullptr)
+                {
+                    tmp = count_characters(bytes, text.size(), thread_count);
+                }
+                else
+                {
+                    tmp.resize(CHARMAX, 0);
+                    for(uint64_t i = 0; i < text.size(); i++){
+                        tmp[text[i]]++;
+                    }
                 }
                 for(uint64_t i = 1; i < CHARMAX; i++){
                     output[i] = output[i - 1] + tmp[i - 1];
@@ -169,10 +291,17 @@ namespace stool
                 tmp.resize(CHARMAX, 0);
                 output.resize(CHARMAX, 0);
 
-                for (uint64_t i = 0; i < wt.size() - 1; i++)
+                // The occurrences in wt[0..wt.size()-2] are obtained by a single traversal of the wavelet tree.
+                if (wt.size() > 1)
                 {
-                    assert(wt[i] >= 0 && wt[i] < tmp.size());
-                    tmp[wt[i]]++;
+                    uint64_t k = 0;
+                    std::vector<uint64_t> cs(CHARMAX), rank_c_i(CHARMAX), rank_c_j(CHARMAX);
+                    sdsl::interval_symbols(wt, 0, wt.size() - 1, k, cs, rank_c_i, rank_c_j);
+                    for (uint64_t x = 0; x < k; x++)
+                    {
+                        assert(cs[x] < tmp.size());
+                        tmp[cs[x]] = rank_c_j[x] - rank_c_i[x];
+                    }
                 }
                 tmp[lastChar]++;
 
@@ -196,10 +325,23 @@ namespace stool
             {
                 uint64_t CHARMAX = UINT8_MAX + 1;
 
+                // The occurrences of all the characters are obtained by a single traversal of the wavelet tree instead of 256 rank queries.
+                std::vector<uint64_t> counts(CHARMAX, 0);
+                if (wt.size() > 0)
+                {
+                    uint64_t distinct_count = 0;
+                    std::vector<uint64_t> cs(CHARMAX), rank_c_i(CHARMAX), rank_c_j(CHARMAX);
+                    sdsl::interval_symbols(wt, 0, wt.size(), distinct_count, cs, rank_c_i, rank_c_j);
+                    for (uint64_t x = 0; x < distinct_count; x++)
+                    {
+                        counts[cs[x]] = rank_c_j[x] - rank_c_i[x];
+                    }
+                }
+
                 output.resize(CHARMAX, 0);
                 for (uint64_t i = 0; i < CHARMAX; i++)
                 {
-                    uint64_t k = wt.rank(wt.size(), i);
+                    uint64_t k = counts[i];
                     if (i == 0)
                     {
                         /*
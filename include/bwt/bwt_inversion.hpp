@@ -0,0 +1,239 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include "../basic/parallel_functions.hpp"
+#include "../debug/message.hpp"
+#include "../specialized_collection/byte_rank_directory.hpp"
+
+namespace stool
+{
+  namespace bwt
+  {
+    /**
+     * @brief Recovers the text from the BWT of a byte string by interleaved LF chains
+     *
+     * The text is recovered by LF steps as usual, but a single LF chain is bound by the memory latency of the rank queries.
+     * Hence the BWT positions are cut into chains at sampled starting positions (evenly spaced positions and the end marker),
+     * and each thread keeps \p stream_count chains in flight: it advances the chains in a round-robin manner and prefetches the record
+     * of the next LF step of a chain while the other chains are processed.
+     * The rank queries are answered by ByteRankDirectory, which reads the character and its rank from the same record.
+     *
+     * Each chain stores its characters in its own buffer. After all the chains are processed, the text positions of the chains are obtained
+     * by linking them from the end marker, and the buffers are copied to the text.
+     * \ingroup StringClasses
+     */
+    class BWTInversion
+    {
+    public:
+      /** @brief The default number of the chains processed by a thread at the same time */
+      static inline constexpr uint64_t DEFAULT_STREAM_COUNT = 16;
+
+      /** @brief The number of the chains per stream (more chains balance the load of the threads better) */
+      static inline constexpr uint64_t CHAINS_PER_STREAM = 16;
+
+    private:
+      struct Chain
+      {
+        uint64_t start;
+        uint64_t next;
+        std::vector<uint8_t> chars;
+      };
+
+      /**
+       * @brief Processes the chains given by \p next_chain with \p stream_count chains in flight
+       *
+       * A chain of a valid BWT of length \p n has less than \p n characters. If a chain reaches \p n characters (i.e., it runs on a cycle of LF without a starting position),
+       * \p failed is set and all the threads stop taking chains.
+       */
+      static void process_chains(const ByteRankDirectory &brd, const std::array<uint64_t, 256> &C, const std::vector<uint64_t> &start_bits,
+                                 std::vector<Chain> &chains, std::atomic<uint64_t> &next_chain, uint64_t stream_count, uint64_t n, std::atomic<bool> &failed)
+      {
+        uint64_t q = chains.size();
+        std::vector<uint64_t> chain_ids(stream_count, UINT64_MAX);
+        std::vector<uint64_t> positions(stream_count, 0);
+        uint64_t active_count = 0;
+
+        auto fetch = [&](uint64_t slot)
+        {
+          uint64_t k = failed.load(std::memory_order_relaxed) ? q : next_chain.fetch_add(1, std::memory_order_relaxed);
+          if (k < q)
+          {
+            chain_ids[slot] = k;
+            positions[slot] = chains[k].start;
+            brd.prefetch(chains[k].start);
+            return true;
+          }
+          else
+          {
+            chain_ids[slot] = UINT64_MAX;
+            return false;
+          }
+        };
+        for (uint64_t slot = 0; slot < stream_count; slot++)
+        {
+          if (fetch(slot))
+          {
+            active_count++;
+          }
+        }
+
+        // The bit of the next position of a chain is checked when the chain is visited again, so that it is prefetched together with the record.
+        while (active_count > 0)
+        {
+          for (uint64_t slot = 0; slot < stream_count; slot++)
+          {
+            uint64_t k = chain_ids[slot];
+            if (k == UINT64_MAX)
+            {
+              continue;
+            }
+            uint64_t x = positions[slot];
+            bool is_finished = chains[k].chars.size() > 0 && ((start_bits[x / 64] >> (x % 64)) & 1) != 0;
+            if (!is_finished && chains[k].chars.size() == n)
+            {
+              failed.store(true, std::memory_order_relaxed);
+              is_finished = true;
+            }
+            if (is_finished)
+            {
+              chains[k].next = x;
+              if (!fetch(slot))
+              {
+                active_count--;
+              }
+              continue;
+            }
+            std::pair<uint64_t, uint8_t> rc = brd.inverse_select(x);
+            chains[k].chars.push_back(rc.second);
+            x = C[rc.second] + rc.first;
+            positions[slot] = x;
+            brd.prefetch(x);
+            __builtin_prefetch(&start_bits[x / 64]);
+          }
+        }
+      }
+
+    public:
+      /**
+       * @brief Returns the text whose BWT is \p bwt
+       *
+       * The BWT must contain a unique end marker which is the smallest character (it becomes the last character of the text).
+       * \p stream_count chains are kept in flight by each of the \p thread_count threads.
+       */
+      static std::vector<uint8_t> invert(const std::vector<uint8_t> &bwt, uint64_t stream_count = DEFAULT_STREAM_COUNT, uint64_t thread_count = 1, int message_paragraph = stool::Message::NO_MESSAGE)
+      {
+        uint64_t n = bwt.size();
+        if (n <= 1)
+        {
+          return bwt;
+        }
+        if (message_paragraph >= 0)
+        {
+          std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Inverting BWT..." << std::flush;
+        }
+        std::chrono::system_clock::time_point st1, st2;
+        st1 = std::chrono::system_clock::now();
+
+        stream_count = std::max(stream_count, (uint64_t)1);
+        thread_count = std::max(thread_count, (uint64_t)1);
+
+        std::array<uint64_t, 256> C;
+        C.fill(0);
+        for (uint64_t i = 0; i < n; i++)
+        {
+          C[bwt[i]]++;
+        }
+        uint64_t end_marker_char = 0;
+        while (C[end_marker_char] == 0)
+        {
+          end_marker_char++;
+        }
+        if (C[end_marker_char] != 1)
+        {
+          throw std::runtime_error("BWTInversion: the smallest character of the BWT must occur exactly once");
+        }
+        uint64_t end_marker_position = std::find(bwt.begin(), bwt.end(), (uint8_t)end_marker_char) - bwt.begin();
+        uint64_t sum = 0;
+        for (uint64_t c = 0; c < 256; c++)
+        {
+          uint64_t count = C[c];
+          C[c] = sum;
+          sum += count;
+        }
+
+        ByteRankDirectory brd;
+        brd.build(bwt);
+
+        uint64_t q = std::min(thread_count * stream_count * CHAINS_PER_STREAM, n);
+        std::vector<uint64_t> starts;
+        starts.push_back(end_marker_position);
+        for (uint64_t x = 0; x < q; x++)
+        {
+          starts.push_back((x * n) / q);
+        }
+        std::sort(starts.begin(), starts.end());
+        starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+        std::vector<uint64_t> start_bits((n + 63) / 64, 0);
+        std::vector<Chain> chains(starts.size());
+        for (uint64_t k = 0; k < starts.size(); k++)
+        {
+          start_bits[starts[k] / 64] |= 1ULL << (starts[k] % 64);
+          chains[k].start = starts[k];
+          chains[k].chars.reserve(n / starts.size() + 1);
+        }
+
+        // Each range of [0, thread_count) is a single worker that takes the chains from the shared counter.
+        std::atomic<uint64_t> next_chain(0);
+        std::atomic<bool> failed(false);
+        stool::ParallelFunctions::parallel_for_ranges(thread_count, thread_count, [&](uint64_t, uint64_t, uint64_t)
+                                                      { process_chains(brd, C, start_bits, chains, next_chain, stream_count, n, failed); });
+        if (failed.load())
+        {
+          throw std::runtime_error("BWTInversion: the LF function is not a single cycle (invalid BWT)");
+        }
+
+        // The chain starting at the end marker produces T[n-1], T[n-2], ..., and the next chain continues from there.
+        std::vector<uint64_t> depths(chains.size(), UINT64_MAX);
+        uint64_t k = std::lower_bound(starts.begin(), starts.end(), end_marker_position) - starts.begin();
+        uint64_t depth = 0;
+        uint64_t linked_count = 0;
+        while (linked_count < chains.size() && depths[k] == UINT64_MAX)
+        {
+          depths[k] = depth;
+          depth += chains[k].chars.size();
+          linked_count++;
+          k = std::lower_bound(starts.begin(), starts.end(), chains[k].next) - starts.begin();
+        }
+        if (depth != n || linked_count != chains.size())
+        {
+          throw std::runtime_error("BWTInversion: the LF function is not a single cycle (invalid BWT)");
+        }
+
+        std::vector<uint8_t> text(n);
+        stool::ParallelFunctions::parallel_for_batches(chains.size(), thread_count, [&](uint64_t, uint64_t b)
+                                                       {
+                                                         const std::vector<uint8_t> &chars = chains[b].chars;
+                                                         uint8_t *dst = &text[n - 1 - depths[b]];
+                                                         for (uint64_t i = 0; i < chars.size(); i++)
+                                                         {
+                                                           *(dst - i) = chars[i];
+                                                         } });
+
+        st2 = std::chrono::system_clock::now();
+        if (message_paragraph >= 0)
+        {
+          uint64_t ms_time = std::chrono::duration_cast<std::chrono::milliseconds>(st2 - st1).count();
+          std::cout << "[END] Elapsed Time: " << ms_time << " ms" << std::endl;
+        }
+        return text;
+      }
+    };
+  } // namespace bwt
+} // namespace stool
@@ -0,0 +1,149 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "../basic/parallel_functions.hpp"
+
+namespace stool
+{
+  namespace bwt
+  {
+    /**
+     * @brief Multi-threaded enumeration of the pairs (SA[i], i) of a BWT by LF walks from checkpoints
+     *
+     * A checkpoint is a pair (text position, BWT position) of the same suffix. Starting from a checkpoint with text position p,
+     * LF visits the text positions p-1, p-2, ... (cyclically), so the walks from sorted checkpoints cover disjoint ranges of the text
+     * and can be processed independently by the threads.
+     *
+     * The checkpoints are computed by compute_checkpoints without a sequential scan of the whole BWT: walks are started from evenly spaced
+     * BWT positions and stopped at the next starting position, and the text positions of the starting positions are obtained by linking the walks from the end marker.
+     * This costs one extra LF step per position, so walk(lfds, end_marker_position, ...) performs 2n LF steps on p threads instead of n LF steps on one thread.
+     * \ingroup StringClasses
+     */
+    class ParallelLFWalk
+    {
+    public:
+      /** @brief The number of walks per thread (more walks balance the load better) */
+      static inline constexpr uint64_t WALKS_PER_THREAD = 64;
+
+      /**
+       * @brief A pair of a text position and the BWT position of the suffix starting at it
+       */
+      struct Checkpoint
+      {
+        uint64_t text_position;
+        uint64_t bwt_position;
+      };
+
+    private:
+      /**
+       * @brief Returns the number of the LF steps from the end marker to a suffix starting at \p text_position
+       */
+      static uint64_t get_depth(uint64_t text_position, uint64_t text_size)
+      {
+        return text_position == 0 ? 0 : text_size - text_position;
+      }
+
+    public:
+      /**
+       * @brief Computes about \p checkpoint_count checkpoints including (0, \p end_marker_position), sorted by the number of the LF steps from the end marker
+       *
+       * \p lfds.lf(i) must return LF(i) and is called concurrently by \p thread_count threads.
+       */
+      template <typename LF_DATA_STRUCTURE>
+      static std::vector<Checkpoint> compute_checkpoints(LF_DATA_STRUCTURE &lfds, uint64_t end_marker_position, uint64_t text_size, uint64_t checkpoint_count, uint64_t thread_count)
+      {
+        if (end_marker_position >= text_size)
+        {
+          throw std::runtime_error("ParallelLFWalk: the position of the end marker is out of range");
+        }
+        uint64_t q = std::max(std::min(checkpoint_count, text_size), (uint64_t)1);
+
+        std::vector<uint64_t> starts;
+        starts.push_back(end_marker_position);
+        for (uint64_t x = 0; x < q; x++)
+        {
+          uint64_t pos = (x * text_size) / q;
+          if (pos != end_marker_position)
+          {
+            starts.push_back(pos);
+          }
+        }
+        std::sort(starts.begin(), starts.end());
+        starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+        std::vector<uint64_t> start_bits((text_size + 63) / 64, 0);
+        for (uint64_t pos : starts)
+        {
+          start_bits[pos / 64] |= 1ULL << (pos % 64);
+        }
+
+        // lengths[k] is the number of the positions visited by the walk from starts[k], and nexts[k] is the index of the start at which it stops.
+        std::vector<uint64_t> lengths(starts.size(), 0);
+        std::vector<uint64_t> nexts(starts.size(), 0);
+        stool::ParallelFunctions::parallel_for_batches(starts.size(), thread_count, [&](uint64_t, uint64_t k)
+                                                       {
+                                                         uint64_t x = starts[k];
+                                                         uint64_t length = 0;
+                                                         do
+                                                         {
+                                                           x = lfds.lf(x);
+                                                           length++;
+                                                         } while (((start_bits[x / 64] >> (x % 64)) & 1) == 0);
+                                                         lengths[k] = length;
+                                                         nexts[k] = std::lower_bound(starts.begin(), starts.end(), x) - starts.begin(); });
+
+        std::vector<Checkpoint> checkpoints;
+        checkpoints.reserve(starts.size());
+        uint64_t k = std::lower_bound(starts.begin(), starts.end(), end_marker_position) - starts.begin();
+        uint64_t depth = 0;
+        for (uint64_t x = 0; x < starts.size(); x++)
+        {
+          checkpoints.push_back(Checkpoint{depth == 0 ? 0 : text_size - depth, starts[k]});
+          depth += lengths[k];
+          k = nexts[k];
+        }
+        if (depth != text_size)
+        {
+          throw std::runtime_error("ParallelLFWalk: the LF function is not a single cycle (invalid BWT)");
+        }
+        return checkpoints;
+      }
+
+      /**
+       * @brief Calls \p func(t, text_position, bwt_position) for every suffix, where \p t is the ID of the calling thread
+       *
+       * \p checkpoints must contain the end marker and be sorted as the output of compute_checkpoints.
+       * Each thread reports the suffixes of a contiguous range of text positions in decreasing order (starting from 0 for the range of the end marker).
+       */
+      template <typename LF_DATA_STRUCTURE, typename FUNC>
+      static void walk(LF_DATA_STRUCTURE &lfds, const std::vector<Checkpoint> &checkpoints, uint64_t text_size, uint64_t thread_count, FUNC func)
+      {
+        stool::ParallelFunctions::parallel_for_batches(checkpoints.size(), thread_count, [&](uint64_t t, uint64_t k)
+                                                       {
+                                                         uint64_t depth = get_depth(checkpoints[k].text_position, text_size);
+                                                         uint64_t end_depth = k + 1 < checkpoints.size() ? get_depth(checkpoints[k + 1].text_position, text_size) : text_size;
+                                                         uint64_t x = checkpoints[k].bwt_position;
+                                                         for (uint64_t d = depth; d < end_depth; d++)
+                                                         {
+                                                           func(t, d == 0 ? (uint64_t)0 : text_size - d, x);
+                                                           if (d + 1 < end_depth)
+                                                           {
+                                                             x = lfds.lf(x);
+                                                           }
+                                                         } });
+      }
+
+      /**
+       * @brief Calls \p func(t, text_position, bwt_position) for every suffix using \p thread_count threads (see compute_checkpoints)
+       */
+      template <typename LF_DATA_STRUCTURE, typename FUNC>
+      static void walk(LF_DATA_STRUCTURE &lfds, uint64_t end_marker_position, uint64_t text_size, uint64_t thread_count, FUNC func)
+      {
+        std::vector<Checkpoint> checkpoints = compute_checkpoints(lfds, end_marker_position, text_size, std::max(thread_count, (uint64_t)1) * WALKS_PER_THREAD, thread_count);
+        walk(lfds, checkpoints, text_size, thread_count, func);
+      }
+    };
+  } // namespace bwt
+} // namespace stool
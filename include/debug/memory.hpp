@@ -10,6 +10,7 @@
 
 #ifdef __linux__
 #include <malloc.h>
+#include <sys/resource.h>
 #elif defined(__APPLE__)
 #include <sys/resource.h>
 #include <mach/mach.h>
@@ -48,6 +49,19 @@ static uint64_t current_memory_footprint_bytes()
 			return r.ru_maxrss;
 		}
 
+#elif defined(__linux__)
+		/**
+		 * @brief Returns the peak resident set size of this program in bytes
+		 *
+		 * @note Linux reports ru_maxrss in kilobytes, so the value is converted to bytes to match macOS.
+		 */
+		static uint64_t getPeakRSS()
+		{
+			struct rusage r;
+			getrusage(RUSAGE_SELF, &r);
+			return (uint64_t)r.ru_maxrss * 1024;
+		}
+
 #endif
 
 		/**
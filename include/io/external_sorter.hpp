@@ -0,0 +1,239 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <cstdio>
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <unistd.h>
+
+namespace stool
+{
+    namespace external_sorter_detail
+    {
+        /**
+         * @brief Returns a process-wide unique ID for a temporary file
+         */
+        inline uint64_t get_next_file_id()
+        {
+            static std::atomic<uint64_t> counter(0);
+            return counter++;
+        }
+    }
+
+    /**
+     * @brief A class for sorting more elements than fit in memory
+     *
+     * Elements are pushed one at a time. Whenever the in-memory buffer is full, it is sorted and written to a
+     * temporary file (a run). sort_and_consume merges the runs with a priority queue and passes the elements
+     * to a callback in sorted order. All the temporary files are removed after the merge.
+     *
+     * @tparam T A trivially copyable element type
+     * @tparam CMP A strict weak ordering on T
+     * \ingroup IOClasses
+     */
+    template <typename T, typename CMP = std::less<T>>
+    class ExternalSorter
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+        std::string tmp_dir;
+        uint64_t memory_limit_bytes;
+        CMP cmp;
+        std::vector<T> buffer;
+        std::vector<std::string> run_files;
+        uint64_t element_count = 0;
+
+        std::string create_tmp_file_path()
+        {
+            return tmp_dir + "/stool_external_sorter_" + std::to_string(getpid()) + "_" + std::to_string(external_sorter_detail::get_next_file_id()) + ".tmp";
+        }
+
+        void flush_buffer()
+        {
+            if (this->buffer.size() == 0)
+            {
+                return;
+            }
+            std::sort(this->buffer.begin(), this->buffer.end(), this->cmp);
+            std::string path = this->create_tmp_file_path();
+            std::ofstream out(path, std::ios::out | std::ios::binary);
+            if (!out)
+            {
+                throw std::runtime_error("Failed to open file for writing: " + path);
+            }
+            out.write(reinterpret_cast<const char *>(&this->buffer[0]), this->buffer.size() * sizeof(T));
+            out.close();
+            this->run_files.push_back(path);
+            this->buffer.clear();
+        }
+
+        /**
+         * @brief A sorted run read through a fixed-size buffer
+         */
+        struct RunReader
+        {
+            std::ifstream stream;
+            std::vector<T> buffer;
+            uint64_t position = 0;
+            uint64_t capacity;
+
+            RunReader(const std::string &path, uint64_t _capacity) : capacity(_capacity)
+            {
+                this->stream.open(path, std::ios::binary);
+                if (!this->stream)
+                {
+                    throw std::runtime_error("Failed to open file for reading: " + path);
+                }
+                this->fill();
+            }
+
+            void fill()
+            {
+                this->buffer.resize(this->capacity);
+                this->stream.read(reinterpret_cast<char *>(&this->buffer[0]), this->capacity * sizeof(T));
+                this->buffer.resize(this->stream.gcount() / sizeof(T));
+                this->position = 0;
+            }
+
+            bool empty() const
+            {
+                return this->position >= this->buffer.size();
+            }
+
+            const T &top() const
+            {
+                return this->buffer[this->position];
+            }
+
+            void pop()
+            {
+                this->position++;
+                if (this->position == this->buffer.size())
+                {
+                    this->fill();
+                }
+            }
+        };
+
+    public:
+        /**
+         * @brief Constructs an empty sorter
+         * @param _tmp_dir The directory for the temporary files
+         * @param _memory_limit_bytes The memory used for the in-memory buffer and for the merge buffers
+         */
+        ExternalSorter(std::string _tmp_dir, uint64_t _memory_limit_bytes, CMP _cmp = CMP()) : tmp_dir(_tmp_dir), memory_limit_bytes(_memory_limit_bytes), cmp(_cmp)
+        {
+            this->buffer.reserve(this->get_buffer_capacity());
+        }
+
+        ~ExternalSorter()
+        {
+            for (auto &path : this->run_files)
+            {
+                std::remove(path.c_str());
+            }
+        }
+
+        ExternalSorter(const ExternalSorter &) = delete;
+        ExternalSorter &operator=(const ExternalSorter &) = delete;
+
+        /**
+         * @brief Returns the number of elements kept in memory before a run is written
+         */
+        uint64_t get_buffer_capacity() const
+        {
+            return std::max(this->memory_limit_bytes / sizeof(T), (uint64_t)1024);
+        }
+
+        /**
+         * @brief Returns the number of pushed elements
+         */
+        uint64_t size() const
+        {
+            return this->element_count;
+        }
+
+        /**
+         * @brief Adds an element
+         */
+        void push(const T &value)
+        {
+            this->buffer.push_back(value);
+            this->element_count++;
+            if (this->buffer.size() >= this->get_buffer_capacity())
+            {
+                this->flush_buffer();
+            }
+        }
+
+        /**
+         * @brief Calls \p func(x) for every pushed element x in sorted order and clears this sorter
+         */
+        template <typename FUNC>
+        void sort_and_consume(FUNC func)
+        {
+            if (this->run_files.size() == 0)
+            {
+                // Everything fits in memory.
+                std::sort(this->buffer.begin(), this->buffer.end(), this->cmp);
+                for (const T &x : this->buffer)
+                {
+                    func(x);
+                }
+            }
+            else
+            {
+                this->flush_buffer();
+                std::vector<T>().swap(this->buffer);
+
+                uint64_t k = this->run_files.size();
+                uint64_t capacity = std::max(this->memory_limit_bytes / (sizeof(T) * k), (uint64_t)256);
+                std::vector<std::unique_ptr<RunReader>> readers;
+                for (auto &path : this->run_files)
+                {
+                    readers.push_back(std::make_unique<RunReader>(path, capacity));
+                }
+
+                auto heap_cmp = [&](uint64_t x, uint64_t y)
+                {
+                    return this->cmp(readers[y]->top(), readers[x]->top());
+                };
+                std::priority_queue<uint64_t, std::vector<uint64_t>, decltype(heap_cmp)> heap(heap_cmp);
+                for (uint64_t i = 0; i < k; i++)
+                {
+                    if (!readers[i]->empty())
+                    {
+                        heap.push(i);
+                    }
+                }
+                while (!heap.empty())
+                {
+                    uint64_t i = heap.top();
+                    heap.pop();
+                    func(readers[i]->top());
+                    readers[i]->pop();
+                    if (!readers[i]->empty())
+                    {
+                        heap.push(i);
+                    }
+                }
+                readers.clear();
+                for (auto &path : this->run_files)
+                {
+                    std::remove(path.c_str());
+                }
+                this->run_files.clear();
+            }
+            this->buffer.clear();
+            this->buffer.reserve(this->get_buffer_capacity());
+            this->element_count = 0;
+        }
+    };
+}
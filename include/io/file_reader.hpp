@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include "./mapped_vector.hpp"
+#include "./packed_array_file.hpp"
 
 namespace stool
 {
@@ -133,6 +135,73 @@ namespace stool
 			load_vector(inputStream1, output_vec);
 		}
 
+		/**
+		 * @brief Maps a file storing a \a vector<T> into memory without copying it
+		 *
+		 * @tparam T The data type of the elements
+		 * @param filename The name of the file to map. This file must represent a \a vector<T>.
+		 * @param advice The access pattern hint given to the OS
+		 * @return The read-only view of the file
+		 * @throws std::runtime_error If the file cannot be opened or mapped
+		 */
+		template <typename T>
+		static stool::MappedVector<T> map_vector(const std::string &filename, stool::MappingAdvice advice = stool::MappingAdvice::Normal)
+		{
+			return stool::MappedVector<T>(filename, advice);
+		}
+
+
+		/**
+		 * @brief Loads the header of a packed array file (see FileWriter::write_packed_array)
+		 *
+		 * @throws std::runtime_error If the file cannot be opened or is not a packed array file
+		 */
+		static stool::PackedArrayHeader load_packed_array_header(const std::string &filename)
+		{
+			std::ifstream stream;
+			stream.open(filename, std::ios::binary);
+			if (!stream)
+			{
+				throw std::runtime_error("Failed to open file: " + filename);
+			}
+			stool::PackedArrayHeader header;
+			stream.read((char *)&header, sizeof(stool::PackedArrayHeader));
+			if ((uint64_t)stream.gcount() != sizeof(stool::PackedArrayHeader))
+			{
+				throw std::runtime_error("The file is not a packed array file: " + filename);
+			}
+			stool::PackedArrayFormat::check_header(header);
+			return header;
+		}
+
+		/**
+		 * @brief Maps a packed array file into memory without unpacking it
+		 *
+		 * @throws std::runtime_error If the file cannot be mapped or is not a valid packed array file
+		 */
+		static stool::MappedPackedArray map_packed_array(const std::string &filename, stool::MappingAdvice advice = stool::MappingAdvice::Normal)
+		{
+			return stool::MappedPackedArray(filename, advice);
+		}
+
+		/**
+		 * @brief Loads a packed array file into a vector
+		 *
+		 * @tparam T The data type of the elements
+		 * @param output_vec The vector loaded from the file
+		 * @param verify If true, the loaded values are checked against the checksum in the header
+		 * @throws std::runtime_error If the file is invalid, the values do not fit in T, or the checksum does not match
+		 */
+		template <typename T>
+		static void load_packed_array(const std::string &filename, std::vector<T> &output_vec, bool verify = true)
+		{
+			stool::MappedPackedArray array(filename, stool::MappingAdvice::Sequential);
+			if (verify && !array.verify())
+			{
+				throw std::runtime_error("The checksum of the packed array file does not match: " + filename);
+			}
+			output_vec = array.to_vector<T>();
+		}
 
 		/**
 		 * @brief Loads a string from a file
@@ -4,6 +4,9 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <cstring>
+#include "./streaming_file_writer.hpp"
+#include "./packed_array_file.hpp"
 
 namespace stool
 {
@@ -62,36 +65,103 @@ namespace stool
             out.close();
         }
 
+        /**
+         * @brief Writes vector data to a file as decimal integers separated by newlines
+         */
         template <typename T>
         static void write_vector_as_text(std::string &filename, std::vector<T> &data)
         {
-            std::ofstream file(filename);
-            if (!file) {
-                throw std::runtime_error("Failed to open file for writing");
+            stool::StreamingFileWriter writer(filename);
+            for (size_t i = 0; i < data.size(); i++) {
+                writer.push_back_as_text(data[i]);
             }
-            std::string buffer = "";
+            writer.close();
+        }
 
-            for(size_t i = 0; i < data.size(); i++) {
-                buffer.append(std::to_string(data[i]));
-                if(i < data.size() - 1) {
-                    buffer.append("\n");
-                }
 
-                if(buffer.size() > 1024*1024) {
-                    file.write(buffer.c_str(), buffer.size());
-                    buffer.clear();
+        /**
+         * @brief Writes \p data to \p filename in the packed array format
+         *
+         * The bit width is the number of bits of the largest stored value, e.g., ceil(log2 n) bits for a suffix array of length n.
+         *
+         * @tparam VEC A random access container of integers (e.g., std::vector<uint64_t>, stool::MappedVector<int64_t>)
+         * @param content The kind of the array
+         * @param text_length The length of the text the array was built from
+         * @param alphabet The alphabet of the text
+         * @param block_size The number of values per checksum block (0 for no block index)
+         * @throws std::runtime_error If the file cannot be written
+         */
+        template <typename VEC>
+        static void write_packed_array(const std::string &filename, const VEC &data, PackedArrayContent content, uint64_t text_length = 0,
+                                       const std::vector<uint64_t> &alphabet = std::vector<uint64_t>(), uint64_t block_size = PackedArrayFormat::DEFAULT_BLOCK_SIZE)
+        {
+            using T = typename std::remove_cv<typename std::remove_reference<decltype(data[0])>::type>::type;
+            uint64_t n = data.size();
+
+            PackedArrayHeader header;
+            std::memset(&header, 0, sizeof(PackedArrayHeader));
+            std::memcpy(header.magic, PackedArrayFormat::get_magic(), 8);
+            header.version = PackedArrayFormat::VERSION;
+            header.content = (uint32_t)content;
+            header.is_signed = std::is_signed<T>::value ? 1 : 0;
+            header.element_count = n;
+            header.text_length = text_length;
+            header.alphabet_size = alphabet.size();
+            header.block_size = block_size;
+
+            // The first pass computes the bit width and the checksums, which precede the payload.
+            uint64_t max_value = 0;
+            uint64_t checksum = PackedArrayFormat::CHECKSUM_SEED;
+            uint64_t block_checksum = PackedArrayFormat::CHECKSUM_SEED;
+            std::vector<uint64_t> block_checksums;
+            for (uint64_t i = 0; i < n; i++)
+            {
+                uint64_t v = PackedArrayFormat::to_stored_value<T>(data[i]);
+                max_value = std::max(max_value, v);
+                checksum = PackedArrayFormat::update_checksum(checksum, v);
+                if (block_size > 0)
+                {
+                    block_checksum = PackedArrayFormat::update_checksum(block_checksum, v);
+                    if ((i + 1) % block_size == 0 || i + 1 == n)
+                    {
+                        block_checksums.push_back(block_checksum);
+                        block_checksum = PackedArrayFormat::CHECKSUM_SEED;
+                    }
                 }
             }
+            header.bit_width = PackedArrayFormat::get_bit_width(max_value);
+            header.checksum = checksum;
 
-            if(buffer.size() > 0) {
-                file.write(buffer.c_str(), buffer.size());
-                buffer.clear();
-            }
+            stool::StreamingFileWriter writer(filename, stool::StreamingFileWriter::DEFAULT_BUFFER_SIZE, true);
+            writer.write_bytes(&header, sizeof(PackedArrayHeader));
+            writer.write_block(alphabet);
+            writer.write_block(block_checksums);
 
-            file.close();
+            uint64_t w = header.bit_width;
+            if (w > 0)
+            {
+                uint64_t word = 0;
+                uint64_t used_bits = 0;
+                for (uint64_t i = 0; i < n; i++)
+                {
+                    uint64_t v = PackedArrayFormat::to_stored_value<T>(data[i]);
+                    word |= v << used_bits;
+                    used_bits += w;
+                    if (used_bits >= 64)
+                    {
+                        writer.push_back<uint64_t>(word);
+                        used_bits -= 64;
+                        word = used_bits == 0 ? 0 : v >> (w - used_bits);
+                    }
+                }
+                if (used_bits > 0)
+                {
+                    writer.push_back<uint64_t>(word);
+                }
+            }
+            writer.close();
         }
 
-
         /**
          * @brief Writes string data to an output stream
          *
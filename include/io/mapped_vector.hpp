@@ -0,0 +1,271 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define STOOL_MAPPED_VECTOR_USE_MMAP
+#endif
+
+namespace stool
+{
+    /**
+     * @brief The access pattern hint given to a memory-mapped file (see madvise(2))
+     * \ingroup IOClasses
+     */
+    enum class MappingAdvice
+    {
+        /** @brief No hint */
+        Normal,
+        /** @brief The file will be read sequentially, so aggressive read-ahead is useful */
+        Sequential,
+        /** @brief The file will be read randomly, so read-ahead is useless */
+        Random,
+        /** @brief The whole file will be read soon */
+        WillNeed
+    };
+
+    /**
+     * @brief A read-only view of a file storing a \a vector<T> (in the format of FileWriter::write_vector) that is mapped into memory
+     *
+     * The file is not copied to the heap; the pages are loaded by the OS on demand and are shared with the page cache.
+     * This class provides the read-only part of the std::vector interface (size, operator[], data, begin, end), so it can be
+     * given to the template functions that take a vector-like container.
+     * On platforms without mmap, the file is loaded into an internal std::vector<T>.
+     *
+     * @tparam T A trivially copyable element type
+     * \ingroup IOClasses
+     */
+    template <typename T>
+    class MappedVector
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+        const T *ptr = nullptr;
+        uint64_t element_count = 0;
+#ifdef STOOL_MAPPED_VECTOR_USE_MMAP
+        void *mapped_address = nullptr;
+        uint64_t mapped_size = 0;
+#else
+        std::vector<T> fallback_buffer;
+#endif
+
+    public:
+        using value_type = T;
+        using const_iterator = const T *;
+
+        MappedVector()
+        {
+        }
+
+        /**
+         * @brief Maps the file \p filename into memory
+         * @throws std::runtime_error If the file cannot be opened or mapped
+         */
+        MappedVector(const std::string &filename, MappingAdvice advice = MappingAdvice::Normal)
+        {
+            this->open(filename, advice);
+        }
+
+        MappedVector(const MappedVector &) = delete;
+        MappedVector &operator=(const MappedVector &) = delete;
+
+        MappedVector(MappedVector &&other) noexcept
+        {
+            this->swap(other);
+        }
+
+        MappedVector &operator=(MappedVector &&other) noexcept
+        {
+            if (this != &other)
+            {
+                this->close();
+                this->swap(other);
+            }
+            return *this;
+        }
+
+        ~MappedVector()
+        {
+            this->close();
+        }
+
+        /**
+         * @brief Swaps the contents of this view and \p other
+         */
+        void swap(MappedVector &other) noexcept
+        {
+            std::swap(this->ptr, other.ptr);
+            std::swap(this->element_count, other.element_count);
+#ifdef STOOL_MAPPED_VECTOR_USE_MMAP
+            std::swap(this->mapped_address, other.mapped_address);
+            std::swap(this->mapped_size, other.mapped_size);
+#else
+            this->fallback_buffer.swap(other.fallback_buffer);
+#endif
+        }
+
+        /**
+         * @brief Maps the file \p filename into memory. The previously mapped file is unmapped.
+         * @throws std::runtime_error If the file cannot be opened or mapped
+         */
+        void open(const std::string &filename, MappingAdvice advice = MappingAdvice::Normal)
+        {
+            this->close();
+#ifdef STOOL_MAPPED_VECTOR_USE_MMAP
+            int fd = ::open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw std::runtime_error("Failed to open file: " + filename);
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0)
+            {
+                ::close(fd);
+                throw std::runtime_error("Failed to get the size of file: " + filename);
+            }
+            uint64_t byte_size = st.st_size;
+            this->element_count = byte_size / sizeof(T);
+            if (this->element_count > 0)
+            {
+                this->mapped_size = this->element_count * sizeof(T);
+                void *address = mmap(nullptr, this->mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (address == MAP_FAILED)
+                {
+                    ::close(fd);
+                    this->element_count = 0;
+                    this->mapped_size = 0;
+                    throw std::runtime_error("Failed to map file: " + filename);
+                }
+                this->mapped_address = address;
+                this->ptr = static_cast<const T *>(address);
+            }
+            ::close(fd);
+            this->advise(advice);
+#else
+            (void)advice;
+            std::ifstream stream(filename, std::ios::binary);
+            if (!stream)
+            {
+                throw std::runtime_error("Failed to open file: " + filename);
+            }
+            stream.seekg(0, std::ios::end);
+            uint64_t byte_size = stream.tellg();
+            stream.seekg(0, std::ios::beg);
+            this->fallback_buffer.resize(byte_size / sizeof(T));
+            if (this->fallback_buffer.size() > 0)
+            {
+                stream.read(reinterpret_cast<char *>(&this->fallback_buffer[0]), this->fallback_buffer.size() * sizeof(T));
+            }
+            this->element_count = this->fallback_buffer.size();
+            this->ptr = this->fallback_buffer.data();
+#endif
+        }
+
+        /**
+         * @brief Unmaps the file. This view becomes empty.
+         */
+        void close()
+        {
+#ifdef STOOL_MAPPED_VECTOR_USE_MMAP
+            if (this->mapped_address != nullptr)
+            {
+                munmap(this->mapped_address, this->mapped_size);
+                this->mapped_address = nullptr;
+                this->mapped_size = 0;
+            }
+#else
+            std::vector<T>().swap(this->fallback_buffer);
+#endif
+            this->ptr = nullptr;
+            this->element_count = 0;
+        }
+
+        /**
+         * @brief Gives the access pattern hint \p advice to the OS (no-op on platforms without madvise)
+         */
+        void advise(MappingAdvice advice) const
+        {
+#ifdef STOOL_MAPPED_VECTOR_USE_MMAP
+            if (this->mapped_address == nullptr)
+            {
+                return;
+            }
+            int flag = MADV_NORMAL;
+            switch (advice)
+            {
+            case MappingAdvice::Sequential:
+                flag = MADV_SEQUENTIAL;
+                break;
+            case MappingAdvice::Random:
+                flag = MADV_RANDOM;
+                break;
+            case MappingAdvice::WillNeed:
+                flag = MADV_WILLNEED;
+                break;
+            default:
+                break;
+            }
+            madvise(this->mapped_address, this->mapped_size, flag);
+#else
+            (void)advice;
+#endif
+        }
+
+        /**
+         * @brief Returns the number of elements
+         */
+        uint64_t size() const
+        {
+            return this->element_count;
+        }
+
+        /**
+         * @brief Returns true if this view has no element
+         */
+        bool empty() const
+        {
+            return this->element_count == 0;
+        }
+
+        /**
+         * @brief Returns the pointer to the first element
+         */
+        const T *data() const
+        {
+            return this->ptr;
+        }
+
+        /**
+         * @brief Returns the i-th element
+         */
+        const T &operator[](uint64_t i) const
+        {
+            return this->ptr[i];
+        }
+
+        const_iterator begin() const
+        {
+            return this->ptr;
+        }
+
+        const_iterator end() const
+        {
+            return this->ptr + this->element_count;
+        }
+
+        /**
+         * @brief Copies the elements into a std::vector<T>
+         */
+        std::vector<T> to_vector() const
+        {
+            return std::vector<T>(this->begin(), this->end());
+        }
+    };
+}
@@ -4,11 +4,18 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 namespace stool
 {
 	/**
 	 * @brief A class for reading files in an online (streaming) manner
+	 *
+	 * The file is read in chunks of \p buffer_size bytes. In the prefetching mode, a background thread reads the next chunk
+	 * while the current chunk is processed (double buffering), so that the caller is not blocked by I/O at chunk boundaries.
      * \ingroup IOClasses
 	 */
 	class OnlineFileReader
@@ -18,6 +25,72 @@ namespace stool
 		std::vector<uint8_t> buffer;
 		uint64_t text_length;
 		bool is_used;
+		uint64_t buffer_size;
+		bool prefetch;
+
+		std::thread prefetch_thread;
+		std::mutex prefetch_mutex;
+		std::condition_variable prefetch_cv;
+		std::vector<uint8_t> prefetched_buffer;
+		bool prefetched_buffer_ready = false;
+		bool prefetch_finished = false;
+		std::atomic<bool> stop_requested{false};
+
+		/**
+		 * @brief The loop of the background thread in the prefetching mode
+		 */
+		void prefetch_loop()
+		{
+			std::vector<uint8_t> tmp;
+			while (true)
+			{
+				bool b = false;
+				if (!this->stop_requested)
+				{
+					try
+					{
+						b = OnlineFileReader::read(this->stream, tmp, this->buffer_size, this->text_length);
+					}
+					catch (...)
+					{
+						b = false;
+					}
+				}
+
+				std::unique_lock<std::mutex> lock(this->prefetch_mutex);
+				if (b)
+				{
+					this->prefetch_cv.wait(lock, [&]
+										   { return !this->prefetched_buffer_ready || this->stop_requested; });
+				}
+				if (!b || this->stop_requested)
+				{
+					this->prefetch_finished = true;
+					this->prefetch_cv.notify_all();
+					return;
+				}
+				// The consumed buffer is reused for the next chunk.
+				this->prefetched_buffer.swap(tmp);
+				this->prefetched_buffer_ready = true;
+				this->prefetch_cv.notify_all();
+			}
+		}
+
+		/**
+		 * @brief Stops the background thread if it is running
+		 */
+		void stop_prefetch_thread()
+		{
+			if (this->prefetch_thread.joinable())
+			{
+				{
+					std::lock_guard<std::mutex> lock(this->prefetch_mutex);
+					this->stop_requested = true;
+				}
+				this->prefetch_cv.notify_all();
+				this->prefetch_thread.join();
+			}
+		}
 
 	public:
 		/**
@@ -25,6 +98,11 @@ namespace stool
 		 */
 		static inline constexpr int STATIC_BUFFER_SIZE = 8192;
 
+		/**
+		 * @brief The recommended buffer size for the prefetching mode
+		 */
+		static inline constexpr uint64_t PREFETCH_BUFFER_SIZE = 1ULL << 22;
+
 /**
 		 * @brief Iterator class for OnlineFileReader
 		 *
@@ -38,43 +116,40 @@ namespace stool
 			using difference_type = std::ptrdiff_t;
 
 		public:
-			std::ifstream *stream;
+			OnlineFileReader *reader;
 			std::vector<uint8_t> *buffer;
 			uint64_t text_size;
 			uint64_t current_position;
-			uint16_t current_position_in_buffer;
+			uint64_t current_position_in_buffer;
 
 			/**
 			 * @brief Constructs an OnlineFileReaderIterator for a given file \p F representing a text \p T[0..n-1]
-			 * @param _stream Pointer to the file stream
+			 * @param _reader The reader of the file
 			 * @param _buffer Pointer to the buffer for storing chunks
 			 * @param _text_size The total size of the file
 			 * @param is_end Whether this is an end iterator
 			 */
-			OnlineFileReaderIterator(std::ifstream *_stream, std::vector<uint8_t> *_buffer, uint64_t _text_size, bool is_end)
+			OnlineFileReaderIterator(OnlineFileReader *_reader, std::vector<uint8_t> *_buffer, uint64_t _text_size, bool is_end)
 			{
+				this->reader = _reader;
+				this->buffer = _buffer;
+				this->text_size = _text_size;
 				if (is_end)
 				{
-					this->stream = nullptr;
-					this->buffer = nullptr;
-					this->text_size = _text_size;
 					this->current_position = UINT64_MAX;
-					this->current_position_in_buffer = UINT16_MAX;
+					this->current_position_in_buffer = UINT64_MAX;
 				}
 				else
 				{
-					this->stream = _stream;
-					this->buffer = _buffer;
-					this->text_size = _text_size;
-					bool b = OnlineFileReader::read(*this->stream, *this->buffer, STATIC_BUFFER_SIZE, this->text_size);
+					bool b = this->reader->read_next_chunk(*this->buffer);
 					if (b)
 					{
 						this->current_position_in_buffer = 0;
-						this->current_position++;
+						this->current_position = 0;
 					}
 					else
 					{
-						this->current_position_in_buffer = UINT16_MAX;
+						this->current_position_in_buffer = UINT64_MAX;
 						this->current_position = UINT64_MAX;
 					}
 				}
@@ -93,14 +168,14 @@ namespace stool
 			 */
 			OnlineFileReaderIterator &operator++()
 			{
-				if ((uint64_t)(this->current_position_in_buffer + 1) < (uint64_t)this->buffer->size())
+				if (this->current_position_in_buffer + 1 < (uint64_t)this->buffer->size())
 				{
 					this->current_position_in_buffer++;
 					this->current_position++;
 				}
 				else
 				{
-					bool b = OnlineFileReader::read(*this->stream, *this->buffer, STATIC_BUFFER_SIZE, this->text_size);
+					bool b = this->reader->read_next_chunk(*this->buffer);
 					if (b)
 					{
 						this->current_position_in_buffer = 0;
@@ -108,7 +183,7 @@ namespace stool
 					}
 					else
 					{
-						this->current_position_in_buffer = UINT16_MAX;
+						this->current_position_in_buffer = UINT64_MAX;
 						this->current_position = UINT64_MAX;
 					}
 				}
@@ -138,12 +213,24 @@ namespace stool
 
 		/**
 		 * @brief Constructs an OnlineFileReader with the specified filepath \p filepath
+		 * @param _buffer_size The size of a chunk in bytes
+		 * @param _prefetch If true, the next chunk is read by a background thread (the prefetching mode)
 		 */
-		OnlineFileReader(std::string _filepath)
+		OnlineFileReader(std::string _filepath, uint64_t _buffer_size = STATIC_BUFFER_SIZE, bool _prefetch = false)
 		{
 			this->filepath = _filepath;
 			this->text_length = stool::OnlineFileReader::get_text_size(this->filepath);
 			this->is_used = false;
+			this->buffer_size = std::max(_buffer_size, (uint64_t)1);
+			this->prefetch = _prefetch;
+		}
+
+		OnlineFileReader(const OnlineFileReader &) = delete;
+		OnlineFileReader &operator=(const OnlineFileReader &) = delete;
+
+		~OnlineFileReader()
+		{
+			this->stop_prefetch_thread();
 		}
 
 		/**
@@ -155,11 +242,18 @@ namespace stool
 		}
 
 		/**
-		 * @brief Opens the file for reading
+		 * @brief Opens the file for reading. In the prefetching mode, the background thread starts reading the first chunk.
 		 */
 		void open()
 		{
 			this->stream.open(filepath, std::ios::binary);
+			if (this->prefetch)
+			{
+				this->prefetched_buffer_ready = false;
+				this->prefetch_finished = false;
+				this->stop_requested = false;
+				this->prefetch_thread = std::thread(&OnlineFileReader::prefetch_loop, this);
+			}
 		}
 
 		/**
@@ -167,9 +261,39 @@ namespace stool
 		 */
 		void close()
 		{
+			this->stop_prefetch_thread();
 			this->stream.close();
 		}
 
+		/**
+		 * @brief Reads the next chunk of the opened file into \p output
+		 * @return true if data was successfully read, false if end of file reached
+		 */
+		bool read_next_chunk(std::vector<uint8_t> &output)
+		{
+			if (!this->prefetch)
+			{
+				return OnlineFileReader::read(this->stream, output, this->buffer_size, this->text_length);
+			}
+			else
+			{
+				std::unique_lock<std::mutex> lock(this->prefetch_mutex);
+				this->prefetch_cv.wait(lock, [&]
+									   { return this->prefetched_buffer_ready || this->prefetch_finished; });
+				if (this->prefetched_buffer_ready)
+				{
+					output.swap(this->prefetched_buffer);
+					this->prefetched_buffer_ready = false;
+					this->prefetch_cv.notify_all();
+					return true;
+				}
+				else
+				{
+					return false;
+				}
+			}
+		}
+
 		/**
 		 * @brief Reads \p T[i..i+m-1] from a given file \p F and writes the read data into a vector \p output
 		 * @param file_F The input file stream. T[0..i-1] has been read.
@@ -268,26 +392,25 @@ namespace stool
 
 		/**
 		 * @brief Returns the alphabet \p U of the text \p T stored in the file \p filepath
-		 * @param buffer_size_m The size of the buffer for reading chunks (default: 16000)
+		 * @param buffer_size_m The size of the buffer for reading chunks. The file is read in the prefetching mode.
 		 * @return A vector containing all unique characters in \p U
 		 */
-		static std::vector<uint8_t> get_alphabet(std::string filepath, uint64_t buffer_size_m = 16000)
+		static std::vector<uint8_t> get_alphabet(std::string filepath, uint64_t buffer_size_m = PREFETCH_BUFFER_SIZE)
 		{
-			uint64_t text_size = get_text_size(filepath);
-			std::vector<bool> checker;
-			checker.resize(256, false);
+			std::vector<uint8_t> checker;
+			checker.resize(256, 0);
 
-			std::ifstream inputStream;
-			inputStream.open(filepath, std::ios::binary);
+			OnlineFileReader reader(filepath, buffer_size_m, true);
+			reader.open();
 			std::vector<uint8_t> buffer;
-			while (read(inputStream, buffer, buffer_size_m, text_size))
+			while (reader.read_next_chunk(buffer))
 			{
 				for (uint8_t c : buffer)
 				{
-					checker[c] = true;
+					checker[c] = 1;
 				}
 			}
-			inputStream.close();
+			reader.close();
 
 			std::vector<uint8_t> r;
 			for (size_t i = 0; i < checker.size(); i++)
@@ -379,7 +502,7 @@ namespace stool
 			else
 			{
 				this->is_used = true;
-				return OnlineFileReaderIterator(&this->stream, &this->buffer, this->text_length, false);
+				return OnlineFileReaderIterator(this, &this->buffer, this->text_length, false);
 			}
 		}
 
@@ -389,7 +512,7 @@ namespace stool
 		 */
 		OnlineFileReaderIterator end()
 		{
-			return OnlineFileReaderIterator(&this->stream, &this->buffer, this->text_length, true);
+			return OnlineFileReaderIterator(this, &this->buffer, this->text_length, true);
 		}
 	};
 } // namespace stool
\ No newline at end of file
@@ -0,0 +1,393 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+#include "./mapped_vector.hpp"
+
+namespace stool
+{
+    /**
+     * @brief The kind of array stored in a packed array file
+     * \ingroup IOClasses
+     */
+    enum class PackedArrayContent : uint32_t
+    {
+        /** @brief An integer array without a specific meaning */
+        Other = 0,
+        /** @brief A suffix array */
+        SuffixArray = 1,
+        /** @brief An inverse suffix array */
+        InverseSuffixArray = 2,
+        /** @brief An LCP array */
+        LCPArray = 3,
+        /** @brief A differential suffix array */
+        DifferentialSuffixArray = 4,
+        /** @brief A BWT */
+        BWT = 5
+    };
+
+    /**
+     * @brief The 64-byte header at the beginning of a packed array file
+     *
+     * A packed array file consists of the following sections, each of which is a sequence of 64-bit little-endian words:
+     * (1) this header, (2) the alphabet of the text (\p alphabet_size words), (3) the checksums of the blocks of \p block_size values
+     * (none if \p block_size is 0), and (4) the values packed in \p bit_width bits each from the least significant bit of the first word.
+     * Signed values are stored in the zigzag encoding (0, -1, 1, -2, ... are stored as 0, 1, 2, 3, ...).
+     * Since every section is aligned to 8 bytes, the file can be used through a memory mapping (see MappedPackedArray).
+     * \ingroup IOClasses
+     */
+    struct PackedArrayHeader
+    {
+        /** @brief "STOOLARR" */
+        char magic[8];
+        /** @brief The version of the file format */
+        uint32_t version;
+        /** @brief The kind of the array (PackedArrayContent) */
+        uint32_t content;
+        /** @brief 1 if the values are signed integers, 0 otherwise */
+        uint32_t is_signed;
+        /** @brief The number of bits per value */
+        uint32_t bit_width;
+        /** @brief The number of values */
+        uint64_t element_count;
+        /** @brief The length of the text the array was built from (0 if unknown) */
+        uint64_t text_length;
+        /** @brief The number of the characters in the alphabet section */
+        uint64_t alphabet_size;
+        /** @brief The number of values per checksum block (0 if the file has no block index) */
+        uint64_t block_size;
+        /** @brief The checksum of all the stored values */
+        uint64_t checksum;
+    };
+    static_assert(sizeof(PackedArrayHeader) == 64, "PackedArrayHeader must be 64 bytes");
+
+    /**
+     * @brief Constants and helper functions of the packed array file format
+     * \ingroup IOClasses
+     */
+    class PackedArrayFormat
+    {
+    public:
+        /** @brief The current version of the file format */
+        static inline constexpr uint32_t VERSION = 1;
+
+        /** @brief The default number of values per checksum block */
+        static inline constexpr uint64_t DEFAULT_BLOCK_SIZE = 1ULL << 16;
+
+        /** @brief The initial value of a checksum */
+        static inline constexpr uint64_t CHECKSUM_SEED = 14695981039346656037ULL;
+
+        /**
+         * @brief Returns the magic string at the beginning of a packed array file
+         */
+        static const char *get_magic()
+        {
+            return "STOOLARR";
+        }
+
+        /**
+         * @brief Adds the stored value \p value to the checksum \p checksum (FNV-1a on 64-bit words)
+         */
+        static uint64_t update_checksum(uint64_t checksum, uint64_t value)
+        {
+            return (checksum ^ value) * 1099511628211ULL;
+        }
+
+        /**
+         * @brief Returns the zigzag encoding of \p value
+         */
+        static uint64_t zigzag_encode(int64_t value)
+        {
+            return (((uint64_t)value) << 1) ^ (uint64_t)(value >> 63);
+        }
+
+        /**
+         * @brief Returns the value whose zigzag encoding is \p value
+         */
+        static int64_t zigzag_decode(uint64_t value)
+        {
+            return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+        }
+
+        /**
+         * @brief Returns the number of bits needed to represent \p value (0 for 0)
+         */
+        static uint32_t get_bit_width(uint64_t value)
+        {
+            return value == 0 ? 0 : 64 - __builtin_clzll(value);
+        }
+
+        /**
+         * @brief Returns the number of 64-bit words of the payload
+         */
+        static uint64_t get_payload_word_count(uint64_t element_count, uint64_t bit_width)
+        {
+            // element_count * bit_width may overflow for huge arrays, so the full words are counted separately.
+            uint64_t full_words = (element_count / 64) * bit_width;
+            uint64_t rest_bits = (element_count % 64) * bit_width;
+            return full_words + ((rest_bits + 63) / 64);
+        }
+
+        /**
+         * @brief Returns the number of checksum blocks
+         */
+        static uint64_t get_block_count(const PackedArrayHeader &header)
+        {
+            // element_count + block_size - 1 may overflow for a corrupted header, so the last partial block is counted separately.
+            return header.block_size == 0 ? 0 : (header.element_count / header.block_size) + (header.element_count % header.block_size != 0 ? 1 : 0);
+        }
+
+        /**
+         * @brief Returns the \p bit_width-bit value starting at the \p bit_pos-th bit of \p words
+         */
+        static uint64_t read_bits(const uint64_t *words, uint64_t bit_pos, uint64_t bit_width)
+        {
+            if (bit_width == 0)
+            {
+                return 0;
+            }
+            uint64_t word_index = bit_pos / 64;
+            uint64_t offset = bit_pos % 64;
+            uint64_t value = words[word_index] >> offset;
+            if (offset + bit_width > 64)
+            {
+                value |= words[word_index + 1] << (64 - offset);
+            }
+            return bit_width == 64 ? value : value & ((1ULL << bit_width) - 1);
+        }
+
+        /**
+         * @brief Returns the stored (i.e., zigzag-encoded if signed) value of \p value
+         */
+        template <typename T>
+        static uint64_t to_stored_value(const T &value)
+        {
+            if constexpr (std::is_signed<T>::value)
+            {
+                return zigzag_encode((int64_t)value);
+            }
+            else
+            {
+                return (uint64_t)value;
+            }
+        }
+
+        /**
+         * @brief Checks that \p header is the header of a packed array file that can be read by this version
+         * @throws std::runtime_error If the header is invalid
+         */
+        static void check_header(const PackedArrayHeader &header)
+        {
+            if (std::memcmp(header.magic, get_magic(), 8) != 0)
+            {
+                throw std::runtime_error("The file is not a packed array file");
+            }
+            if (header.version > VERSION)
+            {
+                throw std::runtime_error("Unsupported packed array file version: " + std::to_string(header.version));
+            }
+            if (header.bit_width > 64)
+            {
+                throw std::runtime_error("Invalid bit width in the packed array file: " + std::to_string(header.bit_width));
+            }
+        }
+    };
+
+    /**
+     * @brief A read-only view of a packed array file that is mapped into memory
+     *
+     * The values are unpacked on access, so opening the file costs O(1) time regardless of its size.
+     * \ingroup IOClasses
+     */
+    class MappedPackedArray
+    {
+        stool::MappedVector<uint64_t> words;
+        PackedArrayHeader header;
+        const uint64_t *alphabet_ptr = nullptr;
+        const uint64_t *block_checksums_ptr = nullptr;
+        const uint64_t *payload_ptr = nullptr;
+
+    public:
+        MappedPackedArray()
+        {
+            std::memset(&this->header, 0, sizeof(PackedArrayHeader));
+        }
+
+        /**
+         * @brief Maps the packed array file \p filename into memory
+         * @throws std::runtime_error If the file cannot be mapped or is not a valid packed array file
+         */
+        MappedPackedArray(const std::string &filename, stool::MappingAdvice advice = stool::MappingAdvice::Normal)
+        {
+            this->open(filename, advice);
+        }
+
+        /**
+         * @brief Maps the packed array file \p filename into memory
+         * @throws std::runtime_error If the file cannot be mapped or is not a valid packed array file
+         */
+        void open(const std::string &filename, stool::MappingAdvice advice = stool::MappingAdvice::Normal)
+        {
+            this->words.open(filename, advice);
+            uint64_t header_words = sizeof(PackedArrayHeader) / sizeof(uint64_t);
+            if (this->words.size() < header_words)
+            {
+                throw std::runtime_error("The file is not a packed array file: " + filename);
+            }
+            std::memcpy(&this->header, this->words.data(), sizeof(PackedArrayHeader));
+            PackedArrayFormat::check_header(this->header);
+
+            uint64_t block_count = PackedArrayFormat::get_block_count(this->header);
+            uint64_t payload_words = PackedArrayFormat::get_payload_word_count(this->header.element_count, this->header.bit_width);
+            // The sections are subtracted one by one from the file size so that a corrupted header cannot overflow the sum of their sizes.
+            uint64_t rest_words = this->words.size() - header_words;
+            bool consistent = this->header.alphabet_size <= rest_words;
+            rest_words -= consistent ? this->header.alphabet_size : 0;
+            consistent = consistent && block_count <= rest_words;
+            rest_words -= consistent ? block_count : 0;
+            consistent = consistent && payload_words == rest_words;
+            if (!consistent)
+            {
+                throw std::runtime_error("The size of the packed array file is inconsistent with its header: " + filename);
+            }
+            this->alphabet_ptr = this->words.data() + header_words;
+            this->block_checksums_ptr = this->alphabet_ptr + this->header.alphabet_size;
+            this->payload_ptr = this->block_checksums_ptr + block_count;
+        }
+
+        /**
+         * @brief Returns the header of the file
+         */
+        const PackedArrayHeader &get_header() const
+        {
+            return this->header;
+        }
+
+        /**
+         * @brief Returns the kind of the stored array
+         */
+        PackedArrayContent get_content() const
+        {
+            return (PackedArrayContent)this->header.content;
+        }
+
+        /**
+         * @brief Returns the number of values
+         */
+        uint64_t size() const
+        {
+            return this->header.element_count;
+        }
+
+        /**
+         * @brief Returns the alphabet of the text stored in the file
+         */
+        std::vector<uint64_t> get_alphabet() const
+        {
+            return std::vector<uint64_t>(this->alphabet_ptr, this->alphabet_ptr + this->header.alphabet_size);
+        }
+
+        /**
+         * @brief Returns the i-th stored value (for signed arrays, the zigzag encoding of the value)
+         */
+        uint64_t access_stored_value(uint64_t i) const
+        {
+            return PackedArrayFormat::read_bits(this->payload_ptr, i * this->header.bit_width, this->header.bit_width);
+        }
+
+        /**
+         * @brief Returns the i-th value of an unsigned array
+         */
+        uint64_t access(uint64_t i) const
+        {
+            return this->access_stored_value(i);
+        }
+
+        /**
+         * @brief Returns the i-th value of a signed array
+         */
+        int64_t access_signed(uint64_t i) const
+        {
+            return PackedArrayFormat::zigzag_decode(this->access_stored_value(i));
+        }
+
+        /**
+         * @brief Returns the i-th value of an unsigned array
+         */
+        uint64_t operator[](uint64_t i) const
+        {
+            return this->access(i);
+        }
+
+        /**
+         * @brief Returns true if the values of the \p block_index-th block match the checksum of the block
+         */
+        bool verify_block(uint64_t block_index) const
+        {
+            uint64_t begin = block_index * this->header.block_size;
+            uint64_t end = std::min(begin + this->header.block_size, this->header.element_count);
+            uint64_t checksum = PackedArrayFormat::CHECKSUM_SEED;
+            for (uint64_t i = begin; i < end; i++)
+            {
+                checksum = PackedArrayFormat::update_checksum(checksum, this->access_stored_value(i));
+            }
+            return checksum == this->block_checksums_ptr[block_index];
+        }
+
+        /**
+         * @brief Returns true if all the values match the checksum in the header (and the block checksums if any)
+         */
+        bool verify() const
+        {
+            uint64_t checksum = PackedArrayFormat::CHECKSUM_SEED;
+            for (uint64_t i = 0; i < this->header.element_count; i++)
+            {
+                checksum = PackedArrayFormat::update_checksum(checksum, this->access_stored_value(i));
+            }
+            if (checksum != this->header.checksum)
+            {
+                return false;
+            }
+            uint64_t block_count = PackedArrayFormat::get_block_count(this->header);
+            for (uint64_t b = 0; b < block_count; b++)
+            {
+                if (!this->verify_block(b))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Unpacks the values into a std::vector<T>
+         * @throws std::runtime_error If the values do not fit in T
+         */
+        template <typename T>
+        std::vector<T> to_vector() const
+        {
+            if (this->header.bit_width > sizeof(T) * 8)
+            {
+                throw std::runtime_error("The values of the packed array do not fit in the output type");
+            }
+            std::vector<T> r;
+            r.resize(this->header.element_count);
+            for (uint64_t i = 0; i < this->header.element_count; i++)
+            {
+                if (this->header.is_signed)
+                {
+                    r[i] = (T)this->access_signed(i);
+                }
+                else
+                {
+                    r[i] = (T)this->access(i);
+                }
+            }
+            return r;
+        }
+    };
+
+} // namespace stool
@@ -0,0 +1,396 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace stool
+{
+    /**
+     * @brief A writer that appends values to a file through a fixed-size buffer
+     *
+     * Values are pushed one at a time or in blocks, either in binary (the format of FileWriter::write_vector) or as decimal text
+     * (the format of FileWriter::write_vector_as_text). The buffer is reused, so the memory usage does not depend on the number of values.
+     * If the background flush is enabled, a full buffer is written by another thread while the caller fills a second buffer.
+     * \ingroup IOClasses
+     */
+    class StreamingFileWriter
+    {
+        std::ofstream stream;
+        std::vector<char> buffer;
+        uint64_t buffer_position = 0;
+        uint64_t text_value_count = 0;
+        std::string separator = "\n";
+
+        bool background_flush = false;
+        std::thread flush_thread;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::vector<char> flushing_buffer;
+        uint64_t flushing_size = 0;
+        bool flush_requested = false;
+        bool stop_requested = false;
+        bool write_failed = false;
+
+        void flush_loop()
+        {
+            std::unique_lock<std::mutex> lock(this->mtx);
+            while (true)
+            {
+                this->cv.wait(lock, [&]
+                              { return this->flush_requested || this->stop_requested; });
+                if (!this->flush_requested)
+                {
+                    break;
+                }
+                // The caller never touches flushing_buffer while flush_requested is true.
+                lock.unlock();
+                this->stream.write(&this->flushing_buffer[0], this->flushing_size);
+                bool failed = !this->stream;
+                lock.lock();
+                this->write_failed = this->write_failed || failed;
+                this->flush_requested = false;
+                this->cv.notify_all();
+            }
+        }
+
+        /**
+         * @brief Waits until the background thread has written the previous buffer
+         */
+        void wait_for_flush_thread()
+        {
+            std::unique_lock<std::mutex> lock(this->mtx);
+            this->cv.wait(lock, [&]
+                          { return !this->flush_requested; });
+            if (this->write_failed)
+            {
+                throw std::runtime_error("Failed to write to file");
+            }
+        }
+
+        /**
+         * @brief Writes the buffered bytes to the file (or hands them to the background thread)
+         */
+        void write_buffer()
+        {
+            if (this->buffer_position == 0)
+            {
+                return;
+            }
+            if (this->background_flush)
+            {
+                this->wait_for_flush_thread();
+                {
+                    std::lock_guard<std::mutex> lock(this->mtx);
+                    this->buffer.swap(this->flushing_buffer);
+                    this->flushing_size = this->buffer_position;
+                    this->flush_requested = true;
+                }
+                this->cv.notify_all();
+            }
+            else
+            {
+                this->stream.write(&this->buffer[0], this->buffer_position);
+                if (!this->stream)
+                {
+                    throw std::runtime_error("Failed to write to file");
+                }
+            }
+            this->buffer_position = 0;
+        }
+
+        /**
+         * @brief Makes at least \p len bytes of free space in the buffer (\p len must not exceed the buffer size)
+         */
+        void reserve_space(uint64_t len)
+        {
+            if (this->buffer_position + len > this->buffer.size())
+            {
+                this->write_buffer();
+            }
+        }
+
+        /**
+         * @brief Returns the number of decimal digits of \p value
+         */
+        static uint64_t get_decimal_length(uint64_t value)
+        {
+            uint64_t len = 1;
+            while (value >= 10000)
+            {
+                value /= 10000;
+                len += 4;
+            }
+            return len + (value >= 10) + (value >= 100) + (value >= 1000);
+        }
+
+        /**
+         * @brief Writes the decimal representation of \p value at \p dst and returns the number of written characters
+         */
+        static uint64_t write_decimal(uint64_t value, char *dst)
+        {
+            static constexpr char DIGIT_PAIRS[] =
+                "00010203040506070809"
+                "10111213141516171819"
+                "20212223242526272829"
+                "30313233343536373839"
+                "40414243444546474849"
+                "50515253545556575859"
+                "60616263646566676869"
+                "70717273747576777879"
+                "80818283848586878889"
+                "90919293949596979899";
+
+            // The digits are written from the last one, two digits at a time.
+            uint64_t len = get_decimal_length(value);
+            char *p = dst + len;
+            while (value >= 100)
+            {
+                uint64_t r = value % 100;
+                value /= 100;
+                p -= 2;
+                std::memcpy(p, &DIGIT_PAIRS[r * 2], 2);
+            }
+            if (value >= 10)
+            {
+                std::memcpy(p - 2, &DIGIT_PAIRS[value * 2], 2);
+            }
+            else
+            {
+                *(p - 1) = (char)('0' + value);
+            }
+            return len;
+        }
+
+    public:
+        /** @brief The default buffer size in bytes */
+        static inline constexpr uint64_t DEFAULT_BUFFER_SIZE = 1ULL << 20;
+
+        /** @brief The minimum buffer size in bytes; every single value (including its separator) must fit in the buffer */
+        static inline constexpr uint64_t MIN_BUFFER_SIZE = 1ULL << 8;
+
+        StreamingFileWriter()
+        {
+        }
+
+        /**
+         * @brief Opens \p filename for writing
+         * @param buffer_size The size of the buffer in bytes (two buffers are used if \p _background_flush is true)
+         * @param _background_flush If true, full buffers are written by a background thread
+         * @throws std::runtime_error If the file cannot be opened for writing
+         */
+        StreamingFileWriter(const std::string &filename, uint64_t buffer_size = DEFAULT_BUFFER_SIZE, bool _background_flush = false)
+        {
+            this->open(filename, buffer_size, _background_flush);
+        }
+
+        StreamingFileWriter(const StreamingFileWriter &) = delete;
+        StreamingFileWriter &operator=(const StreamingFileWriter &) = delete;
+
+        ~StreamingFileWriter()
+        {
+            try
+            {
+                this->close();
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+
+        /**
+         * @brief Opens \p filename for writing. The previously opened file is closed.
+         * @throws std::runtime_error If the file cannot be opened for writing
+         */
+        void open(const std::string &filename, uint64_t buffer_size = DEFAULT_BUFFER_SIZE, bool _background_flush = false)
+        {
+            this->close();
+            this->stream.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!this->stream)
+            {
+                throw std::runtime_error("Failed to open file for writing: " + filename);
+            }
+            buffer_size = std::max(buffer_size, MIN_BUFFER_SIZE);
+            this->buffer.resize(buffer_size);
+            this->buffer_position = 0;
+            this->text_value_count = 0;
+            this->background_flush = _background_flush;
+            this->flush_requested = false;
+            this->stop_requested = false;
+            this->write_failed = false;
+            if (this->background_flush)
+            {
+                this->flushing_buffer.resize(buffer_size);
+                this->flush_thread = std::thread(&StreamingFileWriter::flush_loop, this);
+            }
+        }
+
+        /**
+         * @brief Returns true if a file is opened
+         */
+        bool is_open() const
+        {
+            return this->stream.is_open();
+        }
+
+        /**
+         * @brief Sets the string written between two values by push_back_as_text (default: "\n")
+         */
+        void set_separator(const std::string &_separator)
+        {
+            if (_separator.size() + 20 > MIN_BUFFER_SIZE)
+            {
+                throw std::runtime_error("The separator is too long");
+            }
+            this->separator = _separator;
+        }
+
+        /**
+         * @brief Appends \p len bytes starting at \p data
+         */
+        void write_bytes(const void *data, uint64_t len)
+        {
+            const char *src = static_cast<const char *>(data);
+            while (len > 0)
+            {
+                if (this->buffer_position == this->buffer.size())
+                {
+                    this->write_buffer();
+                }
+                uint64_t w = std::min(len, (uint64_t)this->buffer.size() - this->buffer_position);
+                std::memcpy(&this->buffer[this->buffer_position], src, w);
+                this->buffer_position += w;
+                src += w;
+                len -= w;
+            }
+        }
+
+        /**
+         * @brief Appends \p value in binary
+         *
+         * The value is converted to \p T first, e.g., push_back<uint64_t>(x) writes x as a 64-bit integer.
+         */
+        template <typename T>
+        void push_back(const T &value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+            this->reserve_space(sizeof(T));
+            std::memcpy(&this->buffer[this->buffer_position], &value, sizeof(T));
+            this->buffer_position += sizeof(T);
+        }
+
+        /**
+         * @brief Appends the \p len values starting at \p data in binary
+         */
+        template <typename T>
+        void write_block(const T *data, uint64_t len)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+            this->write_bytes(data, len * sizeof(T));
+        }
+
+        /**
+         * @brief Appends the values of \p data in binary
+         */
+        template <typename T>
+        void write_block(const std::vector<T> &data)
+        {
+            if (data.size() > 0)
+            {
+                this->write_block(&data[0], data.size());
+            }
+        }
+
+        /**
+         * @brief Appends the decimal representation of the integer \p value, preceded by the separator unless it is the first value
+         * @tparam T An integer type, or a type convertible to uint64_t (e.g., stool::UInt40)
+         */
+        template <typename T>
+        void push_back_as_text(const T &value)
+        {
+            this->reserve_space(this->separator.size() + 21);
+            char *dst = &this->buffer[this->buffer_position];
+            if (this->text_value_count > 0)
+            {
+                std::memcpy(dst, this->separator.data(), this->separator.size());
+                dst += this->separator.size();
+            }
+            if constexpr (std::is_signed<T>::value)
+            {
+                int64_t x = (int64_t)value;
+                uint64_t abs = (uint64_t)x;
+                if (x < 0)
+                {
+                    *dst++ = '-';
+                    abs = ~abs + 1;
+                }
+                dst += write_decimal(abs, dst);
+            }
+            else
+            {
+                dst += write_decimal((uint64_t)value, dst);
+            }
+            this->buffer_position = dst - &this->buffer[0];
+            this->text_value_count++;
+        }
+
+        /**
+         * @brief Writes all the buffered bytes to the file
+         */
+        void flush()
+        {
+            this->write_buffer();
+            if (this->background_flush)
+            {
+                this->wait_for_flush_thread();
+            }
+            this->stream.flush();
+        }
+
+        /**
+         * @brief Flushes the buffer, stops the background thread, and closes the file
+         * @throws std::runtime_error If the buffered bytes cannot be written
+         */
+        void close()
+        {
+            if (!this->stream.is_open())
+            {
+                return;
+            }
+            bool failed = false;
+            try
+            {
+                this->flush();
+            }
+            catch (const std::runtime_error &)
+            {
+                failed = true;
+            }
+            if (this->flush_thread.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(this->mtx);
+                    this->stop_requested = true;
+                }
+                this->cv.notify_all();
+                this->flush_thread.join();
+            }
+            this->stream.close();
+            std::vector<char>().swap(this->buffer);
+            std::vector<char>().swap(this->flushing_buffer);
+            this->buffer_position = 0;
+            if (failed)
+            {
+                throw std::runtime_error("Failed to write to file");
+            }
+        }
+    };
+} // namespace stool
@@ -7,6 +7,7 @@
 //#include "rlbwt.hpp"
 #include "../bwt/backward_isa.hpp"
 #include "../debug/debug_printer.hpp"
+#include "../debug/message.hpp"
 #include "../specialized_collection/elias_fano_vector.hpp"
 
 
@@ -51,10 +52,7 @@ namespace stool
       public:
         iterator &operator++()
         {
-          uint64_t rank = _sa.sorted_end_ssa.rank(this->_sa_value + 1) - 1;
-          uint64_t diff = this->_sa_value - _sa.sorted_end_ssa[rank];
-
-          this->_sa_value = diff + _sa.next_sa_value_vec[rank];
+          this->_sa_value = _sa.get_next_sa_value(this->_sa_value);
           if (this->_sa_value == _sa._first_sa_value)
           {
             this->_sa_value = std::numeric_limits<INDEX>::max();
@@ -111,6 +109,23 @@ namespace stool
         return this->_str_size;
       }
 
+      /**
+       * @brief Returns SA[i+1] for the position i such that SA[i] = \p sa_value (i.e., the inverse of the φ function)
+       *
+       * The suffix array is regarded as circular, i.e., SA[0] is returned for the last position.
+       */
+      INDEX get_next_sa_value(INDEX sa_value) const
+      {
+        uint64_t rank = this->sorted_end_ssa.rank(sa_value + 1) - 1;
+        uint64_t diff = sa_value - this->sorted_end_ssa[rank];
+        return diff + this->next_sa_value_vec[rank];
+      }
+
+      uint64_t get_using_memory() const
+      {
+        return this->sorted_end_ssa.get_using_memory() + sdsl::size_in_bytes(this->next_sa_value_vec);
+      }
+
     public:
       stool::EliasFanoVector *get_sorted_end_ssa()
       {
@@ -122,7 +137,22 @@ namespace stool
       }
 
       template <typename LF_DATA_STRUCTURE>
-      void build(LF_DATA_STRUCTURE &lfds)
+      void build(LF_DATA_STRUCTURE &lfds, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+      {
+        this->build(lfds, [](uint64_t, uint64_t, uint64_t, uint64_t) {}, message_paragraph, thread_count);
+      }
+
+      /**
+       * @brief Builds this data structure by the ISA scan with the LF function of \p lfds
+       *
+       * \p on_scan(i, sa_value, run_index, diff) is called for every position i of the BWT in the order of the scan,
+       * where SA[i] = sa_value and i is the diff-th position of the run_index-th run.
+       *
+       * If \p thread_count > 1, the scan is divided into LF walks from checkpoints (see stool::bwt::ParallelLFWalk) and the samples are sorted by a parallel radix sort.
+       * In that case, \p lfds.lf and \p on_scan are called concurrently, and the order of the calls of \p on_scan is not specified.
+       */
+      template <typename LF_DATA_STRUCTURE, typename SCAN_FUNC>
+      void build(LF_DATA_STRUCTURE &lfds, SCAN_FUNC on_scan, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
       {
         std::vector<std::pair<INDEX, INDEX>> pmarr;
 
@@ -139,42 +169,70 @@ namespace stool
         //std::cout << dollerLpos << std::endl;
 
         uint64_t x = rlbwt->get_lpos(dollerLpos);
-        x = lfds.lf(x);
-        uint64_t sa_value = str_size - 1;
 
-        std::cout << "ISA SCAN" << std::endl;
+        if (message_paragraph >= 0)
+        {
+          std::cout << stool::Message::get_paragraph_string(message_paragraph) << "ISA SCAN" << std::endl;
+        }
         std::chrono::system_clock::time_point start = std::chrono::system_clock::now();
-        for (uint64_t i = 0; i < str_size; i++)
+        // The first (resp. second) element of pmarr[k] is the SA value at the end of the k-th run (resp. the start of the (k+1)-th run),
+        // so distinct positions update distinct elements.
+        auto scan = [&](uint64_t pos, uint64_t sa_value)
         {
-          uint64_t lindex = rlbwt->get_lindex_containing_the_position(x);
+          uint64_t lindex = rlbwt->get_lindex_containing_the_position(pos);
           uint64_t run = rlbwt->get_run(lindex);
-          uint64_t diff = x - rlbwt->get_lpos(lindex);
+          uint64_t diff = pos - rlbwt->get_lpos(lindex);
+          on_scan(pos, sa_value, lindex, diff);
 
           if (diff == 0)
           {
             uint64_t xindex = lindex > 0 ? lindex - 1 : rle_size - 1;
-            pmarr[xindex] = std::pair<INDEX, INDEX>(pmarr[xindex].first, sa_value);
+            pmarr[xindex].second = sa_value;
           }
 
           if (run == diff + 1)
           {
-            pmarr[lindex] = std::pair<INDEX, INDEX>(sa_value, pmarr[lindex].second);
+            pmarr[lindex].first = sa_value;
           }
+        };
+        if (thread_count > 1)
+        {
+          stool::bwt::ParallelLFWalk::walk(lfds, x, str_size, thread_count, [&](uint64_t, uint64_t text_position, uint64_t bwt_position)
+                                           { scan(bwt_position, text_position); });
+        }
+        else
+        {
           x = lfds.lf(x);
-          sa_value--;
+          uint64_t sa_value = str_size - 1;
+          for (uint64_t i = 0; i < str_size; i++)
+          {
+            scan(x, sa_value);
+            x = lfds.lf(x);
+            sa_value--;
+          }
         }
         std::chrono::system_clock::time_point end = std::chrono::system_clock::now();
-        std::cout << "FINISHED ISA SCAN" << std::endl;
-
-        double elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-        double pertime = elapsed / (double)this->_str_size;
-        std::cout << (elapsed / 1000) << "[ms]" << std::endl;
-        std::cout << pertime << "[micro/per]" << std::endl;
+        if (message_paragraph >= 0)
+        {
+          double elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+          double pertime = elapsed / (double)this->_str_size;
+          std::cout << stool::Message::get_paragraph_string(message_paragraph) << "FINISHED ISA SCAN" << std::endl;
+          std::cout << stool::Message::get_paragraph_string(message_paragraph) << (elapsed / 1000) << "[ms]" << std::endl;
+          std::cout << stool::Message::get_paragraph_string(message_paragraph) << pertime << "[micro/per]" << std::endl;
+        }
 
         this->_first_sa_value = pmarr[rle_size - 1].second;
 
-        std::sort(pmarr.begin(), pmarr.end(), [](const std::pair<INDEX, INDEX> &lhs, const std::pair<INDEX, INDEX> &rhs)
-                  { return lhs.first < rhs.first; });
+        if (thread_count > 1)
+        {
+          stool::ParallelFunctions::parallel_radix_sort(pmarr, [](const std::pair<INDEX, INDEX> &item)
+                                                        { return (uint64_t)item.first; }, str_size, thread_count);
+        }
+        else
+        {
+          std::sort(pmarr.begin(), pmarr.end(), [](const std::pair<INDEX, INDEX> &lhs, const std::pair<INDEX, INDEX> &rhs)
+                    { return lhs.first < rhs.first; });
+        }
 
         stool::EliasFanoVectorBuilder builder;
         builder.initialize(str_size + 1, rle_size + 1);
@@ -185,7 +243,10 @@ namespace stool
         builder.push(str_size);
         builder.finish();
         this->sorted_end_ssa.build_from_builder(builder);
-        std::cout << "finished" << std::endl;
+        if (message_paragraph >= 0)
+        {
+          std::cout << stool::Message::get_paragraph_string(message_paragraph) << "finished" << std::endl;
+        }
         this->next_sa_value_vec.resize(rle_size);
         for (uint64_t i = 0; i < rle_size; i++)
         {
@@ -0,0 +1,378 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include <iostream>
+#include "./rle.hpp"
+
+namespace stool
+{
+    namespace rlbwt2
+    {
+        /**
+         * @brief An LF data structure on the run-length BWT based on the move structure of Nishimoto and Tabei
+         *
+         * LF is linear on each run of the BWT, i.e., LF(p + d) = LF(p) + d for the starting position p of a run and every d less than the run length.
+         * The positions are divided into O(r) input intervals (the runs, some of which are split), and the table stores for each interval
+         * its starting position p, LF(p), the index of the input interval containing LF(p), and its character contiguously in one row.
+         * The intervals are balanced so that the image of each input interval contains less than BALANCE_THRESHOLD starting positions of the input intervals,
+         * so an LF step on a pair (position, interval index) reads the destination row and at most BALANCE_THRESHOLD - 1 following rows, which are consecutive in memory.
+         *
+         * count(pattern) performs the backward search with the move structure; it takes O(m log r) time because the next and previous intervals with a character
+         * are found by binary searches.
+         * \ingroup StringClasses
+         */
+        class MoveLFDataStructure
+        {
+        public:
+            /** @brief The maximum number of the starting positions of the input intervals in the image of an input interval (exclusive) */
+            static inline constexpr uint64_t BALANCE_THRESHOLD = 4;
+
+        private:
+            /**
+             * @brief A row of the move table
+             */
+            struct Row
+            {
+                uint64_t start;
+                uint64_t lf_start;
+                // (the index of the input interval containing lf_start) << 8 | (the character of the interval)
+                uint64_t destination_and_char;
+            };
+
+            // rows[rows.size() - 1] is a sentinel whose start is the length of the BWT.
+            std::vector<Row> rows;
+            std::vector<std::vector<uint64_t>> char_rows;
+            uint64_t text_size = 0;
+            uint64_t run_count = 0;
+
+            struct Interval
+            {
+                uint64_t start;
+                uint64_t lf_start;
+            };
+
+            /**
+             * @brief Splits the input intervals until every image contains less than BALANCE_THRESHOLD starting positions
+             */
+            static void balance(std::vector<Interval> &intervals, uint64_t n)
+            {
+                std::vector<uint64_t> starts;
+                std::vector<Interval> outputs;
+                std::vector<Interval> new_intervals;
+                while (true)
+                {
+                    starts.resize(intervals.size());
+                    outputs.resize(intervals.size());
+                    for (uint64_t x = 0; x < intervals.size(); x++)
+                    {
+                        starts[x] = intervals[x].start;
+                        outputs[x] = intervals[x];
+                    }
+                    std::sort(outputs.begin(), outputs.end(), [](const Interval &a, const Interval &b)
+                              { return a.lf_start < b.lf_start; });
+
+                    // The starts of the input intervals in (lf_start, lf_start + length) are starts[a..b).
+                    new_intervals.clear();
+                    uint64_t a = 0;
+                    for (const Interval &out : outputs)
+                    {
+                        auto it = std::upper_bound(starts.begin(), starts.end(), out.start);
+                        uint64_t end = it == starts.end() ? n : *it;
+                        uint64_t length = end - out.start;
+                        while (a < starts.size() && starts[a] <= out.lf_start)
+                        {
+                            a++;
+                        }
+                        uint64_t b = a;
+                        while (b < starts.size() && starts[b] < out.lf_start + length && b - a < BALANCE_THRESHOLD)
+                        {
+                            b++;
+                        }
+                        if (b - a >= BALANCE_THRESHOLD)
+                        {
+                            // The interval is split so that the image of its first half contains about half of the starts.
+                            uint64_t count = a;
+                            while (count < starts.size() && starts[count] < out.lf_start + length)
+                            {
+                                count++;
+                            }
+                            uint64_t middle = starts[a + (count - a) / 2];
+                            new_intervals.push_back(Interval{out.start + (middle - out.lf_start), middle});
+                        }
+                    }
+                    if (new_intervals.size() == 0)
+                    {
+                        break;
+                    }
+                    intervals.insert(intervals.end(), new_intervals.begin(), new_intervals.end());
+                    std::sort(intervals.begin(), intervals.end(), [](const Interval &x, const Interval &y)
+                              { return x.start < y.start; });
+                }
+            }
+
+        public:
+            MoveLFDataStructure()
+            {
+            }
+
+            /**
+             * @brief Builds the move table of the RLBWT \p rle
+             */
+            template <typename CHAR>
+            void build(const RLE<CHAR> &rle, int message_paragraph = stool::Message::SHOW_MESSAGE)
+            {
+                if (message_paragraph >= 0 && rle.rle_size() > 0)
+                {
+                    std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Constructing MoveLFDataStructure from RLBWT..." << std::flush;
+                }
+                std::chrono::system_clock::time_point st1, st2;
+                st1 = std::chrono::system_clock::now();
+
+                uint64_t CHARMAX = UINT8_MAX + 1;
+                uint64_t r = rle.rle_size();
+                uint64_t n = r == 0 ? 0 : rle.str_size();
+                this->text_size = n;
+                this->run_count = r;
+
+                std::vector<uint64_t> C(CHARMAX + 1, 0);
+                for (uint64_t x = 0; x < r; x++)
+                {
+                    C[(uint8_t)rle.get_char_by_run_index(x) + 1] += rle.get_run(x);
+                }
+                for (uint64_t c = 1; c <= CHARMAX; c++)
+                {
+                    C[c] += C[c - 1];
+                }
+
+                std::vector<Interval> intervals(r);
+                std::vector<uint64_t> rank(CHARMAX, 0);
+                for (uint64_t x = 0; x < r; x++)
+                {
+                    uint8_t c = rle.get_char_by_run_index(x);
+                    intervals[x] = Interval{rle.get_lpos(x), C[c] + rank[c]};
+                    rank[c] += rle.get_run(x);
+                }
+                balance(intervals, n);
+
+                // The characters of the split intervals are those of the runs containing them.
+                uint64_t m = intervals.size();
+                this->rows.resize(m + 1);
+                uint64_t run_index = 0;
+                for (uint64_t x = 0; x < m; x++)
+                {
+                    while (run_index + 1 < r && rle.get_lpos(run_index + 1) <= intervals[x].start)
+                    {
+                        run_index++;
+                    }
+                    this->rows[x].start = intervals[x].start;
+                    this->rows[x].lf_start = intervals[x].lf_start;
+                    this->rows[x].destination_and_char = (uint8_t)rle.get_char_by_run_index(run_index);
+                }
+                this->rows[m].start = n;
+                this->rows[m].lf_start = n;
+                this->rows[m].destination_and_char = 0;
+
+                std::vector<uint64_t> order(m);
+                for (uint64_t x = 0; x < m; x++)
+                {
+                    order[x] = x;
+                }
+                std::sort(order.begin(), order.end(), [&](uint64_t x, uint64_t y)
+                          { return this->rows[x].lf_start < this->rows[y].lf_start; });
+                uint64_t destination = 0;
+                for (uint64_t x : order)
+                {
+                    while (this->rows[destination + 1].start <= this->rows[x].lf_start)
+                    {
+                        destination++;
+                    }
+                    this->rows[x].destination_and_char |= destination << 8;
+                }
+
+                this->char_rows.clear();
+                this->char_rows.resize(CHARMAX);
+                for (uint64_t x = 0; x < m; x++)
+                {
+                    this->char_rows[this->get_char_by_row_index(x)].push_back(x);
+                }
+
+                st2 = std::chrono::system_clock::now();
+                if (message_paragraph >= 0 && r > 0)
+                {
+                    uint64_t ms_time = std::chrono::duration_cast<std::chrono::milliseconds>(st2 - st1).count();
+                    std::cout << "[DONE] (runs: " << r << ", rows: " << m << ", " << ms_time << " ms)" << std::endl;
+                }
+            }
+
+            /**
+             * @brief Returns the length of the BWT
+             */
+            uint64_t size() const
+            {
+                return this->text_size;
+            }
+
+            /**
+             * @brief Returns the number of the runs of the BWT
+             */
+            uint64_t get_run_count() const
+            {
+                return this->run_count;
+            }
+
+            /**
+             * @brief Returns the number of the rows (i.e., the input intervals after the balancing)
+             */
+            uint64_t get_row_count() const
+            {
+                return this->rows.size() - 1;
+            }
+
+            /**
+             * @brief Returns the starting position of the \p row_index-th input interval
+             */
+            uint64_t get_row_start(uint64_t row_index) const
+            {
+                return this->rows[row_index].start;
+            }
+
+            /**
+             * @brief Returns the character of the \p row_index-th input interval
+             */
+            uint8_t get_char_by_row_index(uint64_t row_index) const
+            {
+                return (uint8_t)(this->rows[row_index].destination_and_char & 0xFF);
+            }
+
+            /**
+             * @brief Returns the index of the first row with character \p c at or after \p row_index (UINT64_MAX if it does not exist)
+             */
+            uint64_t get_next_row_with_char(uint64_t row_index, uint8_t c) const
+            {
+                const std::vector<uint64_t> &v = this->char_rows[c];
+                auto it = std::lower_bound(v.begin(), v.end(), row_index);
+                return it == v.end() ? UINT64_MAX : *it;
+            }
+
+            /**
+             * @brief Returns the index of the last row with character \p c at or before \p row_index (UINT64_MAX if it does not exist)
+             */
+            uint64_t get_previous_row_with_char(uint64_t row_index, uint8_t c) const
+            {
+                const std::vector<uint64_t> &v = this->char_rows[c];
+                auto it = std::upper_bound(v.begin(), v.end(), row_index);
+                return it == v.begin() ? UINT64_MAX : *(it - 1);
+            }
+
+            /**
+             * @brief Returns the index of the input interval containing the position \p i (O(log r) time)
+             */
+            uint64_t get_row_index(uint64_t i) const
+            {
+                auto it = std::upper_bound(this->rows.begin(), this->rows.end() - 1, i, [](uint64_t value, const Row &row)
+                                           { return value < row.start; });
+                return (it - this->rows.begin()) - 1;
+            }
+
+            /**
+             * @brief Returns BWT[i]
+             */
+            uint8_t access(uint64_t i) const
+            {
+                return this->get_char_by_row_index(this->get_row_index(i));
+            }
+
+            /**
+             * @brief Replaces the pair (\p i, \p row_index) with (LF(i), the index of the input interval containing LF(i)) in O(1) time
+             *
+             * \p row_index must be the index of the input interval containing \p i.
+             */
+            void lf(uint64_t &i, uint64_t &row_index) const
+            {
+                const Row &row = this->rows[row_index];
+                uint64_t j = row.lf_start + (i - row.start);
+                uint64_t y = row.destination_and_char >> 8;
+                while (this->rows[y + 1].start <= j)
+                {
+                    y++;
+                }
+                i = j;
+                row_index = y;
+            }
+
+            /**
+             * @brief Returns LF(i) (O(log r) time to find the input interval containing \p i)
+             */
+            uint64_t lf(uint64_t i) const
+            {
+                uint64_t row_index = this->get_row_index(i);
+                this->lf(i, row_index);
+                return i;
+            }
+
+            /**
+             * @brief Computes the interval [\p sp, \p ep] of the suffix array for \p pattern by the backward search
+             * @return false if \p pattern does not occur in the text (\p sp and \p ep are undefined in that case)
+             */
+            template <typename PATTERN>
+            bool backward_search(const PATTERN &pattern, uint64_t &sp, uint64_t &ep) const
+            {
+                if (this->text_size == 0)
+                {
+                    return false;
+                }
+                uint64_t sp_row = 0;
+                uint64_t ep_row = this->get_row_count() - 1;
+                sp = 0;
+                ep = this->text_size - 1;
+                for (uint64_t x = pattern.size(); x > 0; x--)
+                {
+                    uint8_t c = (uint8_t)pattern[x - 1];
+                    if (this->get_char_by_row_index(sp_row) != c)
+                    {
+                        sp_row = this->get_next_row_with_char(sp_row + 1, c);
+                        if (sp_row == UINT64_MAX || this->rows[sp_row].start > ep)
+                        {
+                            return false;
+                        }
+                        sp = this->rows[sp_row].start;
+                    }
+                    if (this->get_char_by_row_index(ep_row) != c)
+                    {
+                        ep_row = this->get_previous_row_with_char(ep_row - 1, c);
+                        ep = this->rows[ep_row + 1].start - 1;
+                    }
+                    this->lf(sp, sp_row);
+                    this->lf(ep, ep_row);
+                }
+                return true;
+            }
+
+            /**
+             * @brief Returns the number of the occurrences of \p pattern in the text
+             */
+            template <typename PATTERN>
+            uint64_t count(const PATTERN &pattern) const
+            {
+                uint64_t sp, ep;
+                return this->backward_search(pattern, sp, ep) ? ep - sp + 1 : 0;
+            }
+
+            /**
+             * @brief Returns the size of this data structure in bytes
+             */
+            uint64_t get_using_memory() const
+            {
+                uint64_t x = this->rows.size() * sizeof(Row);
+                for (auto &v : this->char_rows)
+                {
+                    x += v.size() * sizeof(uint64_t);
+                }
+                return x;
+            }
+        };
+    } // namespace rlbwt2
+} // namespace stool
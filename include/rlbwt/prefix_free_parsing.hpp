@@ -0,0 +1,423 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <fstream>
+#include <chrono>
+#include <iostream>
+#include "../io/online_file_reader.hpp"
+#include "../debug/message.hpp"
+#include "../strings/sa_is.hpp"
+
+namespace stool
+{
+    /**
+     * @brief Constructs the RLBWT of a text by the prefix-free parsing (PFP) of Boucher et al. (Big-BWT) without the suffix array of the text
+     *
+     * The text T must end with a unique smallest character (the end marker). The text is regarded as the circular string R = T[n-1]T[0..n-2],
+     * and it is streamed once and divided into phrases at the windows of w characters whose Karp-Rabin fingerprints are divisible by a modulus;
+     * consecutive phrases overlap by w characters. The window starting with the end marker is always a boundary.
+     * The phrases form a prefix-free dictionary D, and the text is represented as the sequence P of the phrase identifiers (the parse).
+     *
+     * The BWT is computed from the suffix array of the concatenated dictionary and the suffix array of the parse:
+     * the suffixes of T are ordered by their proper phrase suffixes of length greater than w, and the ties are broken by the order of the following parse suffixes.
+     * The runs of the BWT are emitted one by one, so the working space is O(|D| + |P| + r) words instead of the O(n) words of a suffix array.
+     * \ingroup StringClasses
+     */
+    class PrefixFreeParsing
+    {
+    public:
+        /** @brief The default length of the windows */
+        static inline constexpr uint64_t DEFAULT_WINDOW_SIZE = 10;
+
+        /** @brief The default modulus; a window is a phrase boundary if its fingerprint is divisible by the modulus */
+        static inline constexpr uint64_t DEFAULT_MODULUS = 100;
+
+        /** @brief The prime used by the Karp-Rabin fingerprints */
+        static inline constexpr uint64_t PRIME = 1999999973ULL;
+
+    private:
+        uint64_t window_size;
+        uint64_t modulus;
+        uint64_t base_power = 1;
+
+        // The state of the parsing.
+        uint64_t text_size = 0;
+        uint64_t position = 0;
+        uint64_t fingerprint = 0;
+        std::string current_phrase;
+        std::string first_window;
+        std::unordered_map<std::string, uint64_t> phrase_map;
+
+        // dictionary[id] is the phrase with the identifier id, and parse[k] is the identifier of the k-th phrase of R.
+        std::vector<std::string> dictionary;
+        std::vector<uint64_t> parse;
+
+        PrefixFreeParsing(uint64_t _window_size, uint64_t _modulus, uint64_t _text_size) : window_size(_window_size), modulus(_modulus), text_size(_text_size)
+        {
+            for (uint64_t i = 1; i < this->window_size; i++)
+            {
+                this->base_power = (this->base_power * 256) % PRIME;
+            }
+        }
+
+        void add_phrase()
+        {
+            auto it = this->phrase_map.find(this->current_phrase);
+            if (it == this->phrase_map.end())
+            {
+                uint64_t id = this->dictionary.size();
+                this->phrase_map[this->current_phrase] = id;
+                this->dictionary.push_back(this->current_phrase);
+                this->parse.push_back(id);
+            }
+            else
+            {
+                this->parse.push_back(it->second);
+            }
+            this->current_phrase.erase(0, this->current_phrase.size() - this->window_size);
+        }
+
+        /**
+         * @brief Appends R'[position] to the current phrase, where R' is R followed by its first w characters
+         */
+        void push(uint8_t c)
+        {
+            uint64_t w = this->window_size;
+            if (this->position < w)
+            {
+                this->first_window.push_back((char)c);
+            }
+            this->current_phrase.push_back((char)c);
+            if (this->position >= w)
+            {
+                uint8_t removed = this->current_phrase[this->current_phrase.size() - 1 - w];
+                this->fingerprint = (this->fingerprint + PRIME - (removed * this->base_power) % PRIME) % PRIME;
+            }
+            this->fingerprint = (this->fingerprint * 256 + c) % PRIME;
+            this->position++;
+
+            if (this->position >= w)
+            {
+                uint64_t window_start = this->position - w;
+                if (window_start == this->text_size || (window_start > 0 && this->fingerprint % this->modulus == 0))
+                {
+                    this->add_phrase();
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the last character of the occurrence of the phrase \p id that is not shared with the next phrase
+         */
+        uint8_t get_last_owned_char(uint64_t id) const
+        {
+            const std::string &d = this->dictionary[id];
+            return (uint8_t)d[d.size() - this->window_size - 1];
+        }
+
+        static void push_run(uint8_t c, uint64_t length, std::vector<uint8_t> &output_chars, std::vector<uint64_t> &output_runs)
+        {
+            if (output_chars.size() > 0 && output_chars.back() == c)
+            {
+                output_runs.back() += length;
+            }
+            else
+            {
+                output_chars.push_back(c);
+                output_runs.push_back(length);
+            }
+        }
+
+        /**
+         * @brief Computes the runs of the BWT from the dictionary and the parse
+         */
+        void compute_BWT(std::vector<uint8_t> &output_chars, std::vector<uint64_t> &output_runs) const
+        {
+            uint64_t w = this->window_size;
+            uint64_t m = this->dictionary.size();
+            uint64_t t = this->parse.size();
+
+            // The concatenation of the phrases separated by 0 (the characters are shifted by one).
+            std::vector<uint64_t> phrase_starts(m + 1, 0);
+            for (uint64_t id = 0; id < m; id++)
+            {
+                phrase_starts[id + 1] = phrase_starts[id] + this->dictionary[id].size() + 1;
+            }
+            std::vector<uint16_t> concatenation(phrase_starts[m]);
+            for (uint64_t id = 0; id < m; id++)
+            {
+                const std::string &d = this->dictionary[id];
+                for (uint64_t i = 0; i < d.size(); i++)
+                {
+                    concatenation[phrase_starts[id] + i] = (uint8_t)d[i] + 1;
+                }
+                concatenation[phrase_starts[id + 1] - 1] = 0;
+            }
+            std::vector<uint64_t> dictionary_sa = stool::sais_suffix_array<uint16_t, uint64_t>(concatenation);
+            std::vector<uint16_t>().swap(concatenation);
+
+            // The phrases are ranked in lexicographic order (the dictionary is prefix-free).
+            std::vector<uint64_t> phrase_ranks(m);
+            uint64_t rank = 0;
+            for (uint64_t x : dictionary_sa)
+            {
+                uint64_t id = std::upper_bound(phrase_starts.begin(), phrase_starts.end(), x) - phrase_starts.begin() - 1;
+                if (x == phrase_starts[id])
+                {
+                    phrase_ranks[id] = rank++;
+                }
+            }
+
+            // The rotation of the circular parse starting at k corresponds to the suffix k-1 of P[1..t-1]P[0], because P[0] is the unique smallest phrase.
+            std::vector<uint64_t> rotated_parse(t);
+            for (uint64_t k = 0; k < t; k++)
+            {
+                rotated_parse[k] = phrase_ranks[this->parse[(k + 1) % t]];
+            }
+            std::vector<uint64_t> parse_sa = stool::sais_suffix_array<uint64_t, uint64_t>(rotated_parse);
+            std::vector<uint64_t>().swap(rotated_parse);
+
+            // occurrences[id] lists (the rank of the parse rotation following an occurrence of phrase id, the character preceding the occurrence) in increasing order.
+            std::vector<std::vector<std::pair<uint64_t, uint8_t>>> occurrences(m);
+            for (uint64_t s = 0; s < t; s++)
+            {
+                uint64_t rotation = (parse_sa[s] + 1) % t;
+                uint64_t k = (rotation + t - 1) % t;
+                uint8_t prev_char = this->get_last_owned_char(this->parse[(k + t - 1) % t]);
+                occurrences[this->parse[k]].push_back(std::pair<uint64_t, uint8_t>(s, prev_char));
+            }
+            std::vector<uint64_t>().swap(parse_sa);
+
+            // Each group consists of the occurrences (phrase id, offset) of an equal phrase suffix of length greater than w.
+            std::vector<std::pair<uint64_t, uint64_t>> group;
+            std::vector<std::pair<uint64_t, uint8_t>> merged;
+            auto flush_group = [&]()
+            {
+                if (group.size() == 0)
+                {
+                    return;
+                }
+                bool same_char = true;
+                uint64_t total = 0;
+                uint8_t first_char = 0;
+                for (uint64_t x = 0; x < group.size(); x++)
+                {
+                    auto [id, offset] = group[x];
+                    total += occurrences[id].size();
+                    if (offset == 0)
+                    {
+                        same_char = false;
+                    }
+                    else if (x == 0)
+                    {
+                        first_char = this->dictionary[id][offset - 1];
+                    }
+                    else if ((uint8_t)this->dictionary[id][offset - 1] != first_char)
+                    {
+                        same_char = false;
+                    }
+                }
+                if (same_char)
+                {
+                    push_run(first_char, total, output_chars, output_runs);
+                }
+                else
+                {
+                    merged.clear();
+                    for (auto [id, offset] : group)
+                    {
+                        for (auto &occ : occurrences[id])
+                        {
+                            merged.push_back(std::pair<uint64_t, uint8_t>(occ.first, offset == 0 ? occ.second : (uint8_t)this->dictionary[id][offset - 1]));
+                        }
+                    }
+                    std::sort(merged.begin(), merged.end());
+                    for (auto &it : merged)
+                    {
+                        push_run(it.second, 1, output_chars, output_runs);
+                    }
+                }
+                group.clear();
+            };
+
+            uint64_t prev_id = UINT64_MAX;
+            uint64_t prev_offset = 0;
+            for (uint64_t x : dictionary_sa)
+            {
+                uint64_t id = std::upper_bound(phrase_starts.begin(), phrase_starts.end(), x) - phrase_starts.begin() - 1;
+                uint64_t offset = x - phrase_starts[id];
+                const std::string &d = this->dictionary[id];
+                if (offset >= d.size() || d.size() - offset <= w)
+                {
+                    continue;
+                }
+                bool equal = false;
+                if (prev_id != UINT64_MAX)
+                {
+                    const std::string &pd = this->dictionary[prev_id];
+                    equal = pd.size() - prev_offset == d.size() - offset && std::memcmp(pd.data() + prev_offset, d.data() + offset, d.size() - offset) == 0;
+                }
+                if (!equal)
+                {
+                    flush_group();
+                }
+                group.push_back(std::pair<uint64_t, uint64_t>(id, offset));
+                prev_id = id;
+                prev_offset = offset;
+            }
+            flush_group();
+        }
+
+        static void check_end_marker(uint8_t end_marker, uint8_t c)
+        {
+            if (c <= end_marker)
+            {
+                throw std::runtime_error("PrefixFreeParsing: the last character of the text must be the unique smallest character");
+            }
+        }
+
+        /**
+         * @brief Computes the runs of the BWT of a short text by its suffix array
+         */
+        static void build_RLBWT_by_SA(const std::vector<uint8_t> &text, std::vector<uint8_t> &output_chars, std::vector<uint64_t> &output_runs)
+        {
+            std::vector<uint64_t> sa = stool::sais_suffix_array<uint8_t, uint64_t>(text);
+            for (uint64_t i = 0; i < sa.size(); i++)
+            {
+                push_run(text[sa[i] == 0 ? text.size() - 1 : sa[i] - 1], 1, output_chars, output_runs);
+            }
+        }
+
+        template <typename FEED>
+        static void build_RLBWT(uint64_t text_size, uint8_t end_marker, FEED feed, std::vector<uint8_t> &output_chars, std::vector<uint64_t> &output_runs, uint64_t window_size, uint64_t modulus, int message_paragraph)
+        {
+            if (window_size == 0 || modulus == 0)
+            {
+                throw std::runtime_error("PrefixFreeParsing: the window size and the modulus must be positive");
+            }
+            if (message_paragraph >= 0)
+            {
+                std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Constructing RLBWT by prefix-free parsing (w = " << window_size << ", p = " << modulus << ")..." << std::endl;
+            }
+            std::chrono::system_clock::time_point st1, st2;
+            st1 = std::chrono::system_clock::now();
+
+            output_chars.clear();
+            output_runs.clear();
+
+            PrefixFreeParsing pfp(window_size, modulus, text_size);
+            pfp.push(end_marker);
+            feed([&](uint8_t c)
+                 { pfp.push(c); });
+            std::string first_window = pfp.first_window;
+            for (uint64_t i = 0; i < window_size; i++)
+            {
+                pfp.push((uint8_t)first_window[i]);
+            }
+            std::unordered_map<std::string, uint64_t>().swap(pfp.phrase_map);
+            std::string().swap(pfp.current_phrase);
+
+            if (message_paragraph >= 0)
+            {
+                uint64_t dictionary_length = 0;
+                for (auto &d : pfp.dictionary)
+                {
+                    dictionary_length += d.size();
+                }
+                std::cout << stool::Message::get_paragraph_string(message_paragraph + 1) << "Dictionary: " << pfp.dictionary.size() << " phrases (" << dictionary_length << " characters), Parse: " << pfp.parse.size() << " phrases" << std::endl;
+            }
+            pfp.compute_BWT(output_chars, output_runs);
+
+            st2 = std::chrono::system_clock::now();
+            if (message_paragraph >= 0)
+            {
+                uint64_t ms_time = std::chrono::duration_cast<std::chrono::milliseconds>(st2 - st1).count();
+                std::cout << stool::Message::get_paragraph_string(message_paragraph) << "[END] r = " << output_chars.size() << ", Elapsed Time: " << ms_time << " ms" << std::endl;
+            }
+        }
+
+    public:
+        /**
+         * @brief Computes the runs of the BWT of \p text (the characters and the lengths of the runs are stored in \p output_chars and \p output_runs)
+         */
+        static void build_RLBWT(const std::vector<uint8_t> &text, std::vector<uint8_t> &output_chars, std::vector<uint64_t> &output_runs, uint64_t window_size = DEFAULT_WINDOW_SIZE, uint64_t modulus = DEFAULT_MODULUS, int message_paragraph = stool::Message::SHOW_MESSAGE)
+        {
+            if (text.size() == 0)
+            {
+                throw std::runtime_error("PrefixFreeParsing: the text is empty");
+            }
+            uint8_t end_marker = text.back();
+            for (uint64_t i = 0; i + 1 < text.size(); i++)
+            {
+                check_end_marker(end_marker, text[i]);
+            }
+            if (text.size() <= 2 * window_size)
+            {
+                output_chars.clear();
+                output_runs.clear();
+                build_RLBWT_by_SA(text, output_chars, output_runs);
+                return;
+            }
+            build_RLBWT(text.size(), end_marker, [&](auto push)
+                        {
+                            for (uint64_t i = 0; i + 1 < text.size(); i++)
+                            {
+                                push(text[i]);
+                            } },
+                        output_chars, output_runs, window_size, modulus, message_paragraph);
+        }
+
+        /**
+         * @brief Computes the runs of the BWT of the text stored in the file \p file_path, which is read once in a streaming manner
+         */
+        static void build_RLBWT_from_file(std::string file_path, std::vector<uint8_t> &output_chars, std::vector<uint64_t> &output_runs, uint64_t window_size = DEFAULT_WINDOW_SIZE, uint64_t modulus = DEFAULT_MODULUS, int message_paragraph = stool::Message::SHOW_MESSAGE)
+        {
+            uint64_t text_size = stool::OnlineFileReader::get_text_size(file_path);
+            if (text_size == 0)
+            {
+                throw std::runtime_error("PrefixFreeParsing: the text is empty");
+            }
+            if (text_size <= 2 * window_size)
+            {
+                std::ifstream file(file_path, std::ios::binary);
+                std::vector<uint8_t> text(text_size);
+                file.read((char *)text.data(), text_size);
+                build_RLBWT(text, output_chars, output_runs, window_size, modulus, message_paragraph);
+                return;
+            }
+
+            uint8_t end_marker;
+            {
+                std::ifstream file(file_path, std::ios::binary);
+                file.seekg(text_size - 1);
+                file.read((char *)&end_marker, 1);
+            }
+
+            build_RLBWT(text_size, end_marker, [&](auto push)
+                        {
+                            stool::OnlineFileReader ofr(file_path, stool::OnlineFileReader::PREFETCH_BUFFER_SIZE, true);
+                            ofr.open();
+                            std::vector<uint8_t> buffer;
+                            uint64_t pos = 0;
+                            while (ofr.read_next_chunk(buffer))
+                            {
+                                for (uint8_t c : buffer)
+                                {
+                                    if (pos + 1 < text_size)
+                                    {
+                                        check_end_marker(end_marker, c);
+                                        push(c);
+                                    }
+                                    pos++;
+                                }
+                            }
+                            ofr.close(); },
+                        output_chars, output_runs, window_size, modulus, message_paragraph);
+        }
+    };
+} // namespace stool
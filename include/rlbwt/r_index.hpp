@@ -0,0 +1,228 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include "./rle.hpp"
+#include "./forward_sa.hpp"
+#include "./move_lf_data_structure.hpp"
+
+namespace stool
+{
+    namespace rlbwt2
+    {
+        /**
+         * @brief A locate index on the run-length BWT (the r-index of Gagie, Navarro, and Prezza) in O(r) words
+         *
+         * The index consists of the following three components:
+         * (1) MoveLFDataStructure for the backward search;
+         * (2) the SA values at the starting positions of the runs (toroidal samples; the rows of the move table that start a run are sampled);
+         * (3) ForwardSA, which computes the inverse φ function (SA[i] -> SA[i+1]) from the SA values at the ends of the runs.
+         *
+         * locate(P) tracks SA[sp] during the backward search (the interval [sp, ep] moves to the first row with the next character, which starts a run, or SA[sp] decreases by one),
+         * and then computes SA[sp+1..ep] by the inverse φ function. All the samples are derived during the ISA scan of ForwardSA::build.
+         *
+         * The BWT must contain a unique end marker which is the smallest character, and the length of the text must be less than 2^32 (the limit of ForwardSA).
+         * \ingroup StringClasses
+         */
+        class RIndex
+        {
+        public:
+            /** @brief The sample value of the rows that do not start a run */
+            static inline constexpr uint64_t NO_SAMPLE = UINT64_MAX;
+
+        private:
+            MoveLFDataStructure lf_data_structure;
+            ForwardSA forward_sa;
+            std::vector<uint64_t> row_samples;
+            uint64_t first_sa_value = 0;
+
+            /**
+             * @brief The interface used by ForwardSA::build (consecutive LF steps are computed by the move structure)
+             *
+             * If \p concurrent is true, the row of the previous step is not cached, so lf can be called by multiple threads.
+             */
+            template <typename CHAR>
+            struct LFAdapter
+            {
+                const RLE<CHAR> *rlbwt;
+                const MoveLFDataStructure *lfds;
+                bool concurrent = false;
+                uint64_t position = UINT64_MAX;
+                uint64_t row_index = 0;
+
+                const RLE<CHAR> *get_rlbwt() const
+                {
+                    return this->rlbwt;
+                }
+                uint64_t lf(uint64_t i)
+                {
+                    if (this->concurrent)
+                    {
+                        return this->lfds->lf(i);
+                    }
+                    if (i != this->position)
+                    {
+                        this->row_index = this->lfds->get_row_index(i);
+                    }
+                    this->lfds->lf(i, this->row_index);
+                    this->position = i;
+                    return i;
+                }
+            };
+
+        public:
+            RIndex()
+            {
+            }
+
+            /**
+             * @brief Builds the r-index of the RLBWT \p rle (the ISA scan uses \p thread_count threads)
+             */
+            template <typename CHAR>
+            void build(const RLE<CHAR> &rle, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+            {
+                if (message_paragraph >= 0)
+                {
+                    std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Constructing RIndex from RLBWT..." << std::endl;
+                }
+                std::chrono::system_clock::time_point st1, st2;
+                st1 = std::chrono::system_clock::now();
+
+                this->lf_data_structure.build(rle, stool::Message::increment_paragraph_level(message_paragraph));
+                uint64_t r = rle.rle_size();
+                if (r == 0)
+                {
+                    throw std::runtime_error("RIndex: the RLBWT is empty");
+                }
+
+                std::vector<uint64_t> run_samples(r, NO_SAMPLE);
+                LFAdapter<CHAR> adapter{&rle, &this->lf_data_structure, thread_count > 1};
+                this->forward_sa.build(adapter, [&](uint64_t, uint64_t sa_value, uint64_t run_index, uint64_t diff)
+                                       {
+                                           if (diff == 0)
+                                           {
+                                               run_samples[run_index] = sa_value;
+                                           } },
+                                       stool::Message::increment_paragraph_level(message_paragraph), thread_count);
+                this->first_sa_value = run_samples[0];
+
+                uint64_t row_count = this->lf_data_structure.get_row_count();
+                this->row_samples.resize(row_count, NO_SAMPLE);
+                uint64_t run_index = 0;
+                for (uint64_t x = 0; x < row_count; x++)
+                {
+                    uint64_t start = this->lf_data_structure.get_row_start(x);
+                    while (run_index < r && rle.get_lpos(run_index) < start)
+                    {
+                        run_index++;
+                    }
+                    if (run_index < r && rle.get_lpos(run_index) == start)
+                    {
+                        this->row_samples[x] = run_samples[run_index];
+                    }
+                }
+
+                st2 = std::chrono::system_clock::now();
+                if (message_paragraph >= 0)
+                {
+                    uint64_t ms_time = std::chrono::duration_cast<std::chrono::milliseconds>(st2 - st1).count();
+                    std::cout << stool::Message::get_paragraph_string(message_paragraph) << "[END] Elapsed Time: " << ms_time << " ms" << std::endl;
+                }
+            }
+
+            /**
+             * @brief Returns the length of the text
+             */
+            uint64_t size() const
+            {
+                return this->lf_data_structure.size();
+            }
+
+            /**
+             * @brief Returns the move structure used for the backward search
+             */
+            const MoveLFDataStructure &get_lf_data_structure() const
+            {
+                return this->lf_data_structure;
+            }
+
+            /**
+             * @brief Computes the interval [\p sp, \p ep] of the suffix array for \p pattern and SA[\p sp] (\p sa_sp)
+             * @return false if \p pattern does not occur in the text
+             */
+            template <typename PATTERN>
+            bool backward_search(const PATTERN &pattern, uint64_t &sp, uint64_t &ep, uint64_t &sa_sp) const
+            {
+                const MoveLFDataStructure &lfds = this->lf_data_structure;
+                uint64_t sp_row = 0;
+                uint64_t ep_row = lfds.get_row_count() - 1;
+                sp = 0;
+                ep = lfds.size() - 1;
+                sa_sp = this->first_sa_value;
+                for (uint64_t x = pattern.size(); x > 0; x--)
+                {
+                    uint8_t c = (uint8_t)pattern[x - 1];
+                    if (lfds.get_char_by_row_index(sp_row) != c)
+                    {
+                        // The previous row has another character, so the next row with c starts a run.
+                        sp_row = lfds.get_next_row_with_char(sp_row + 1, c);
+                        if (sp_row == UINT64_MAX || lfds.get_row_start(sp_row) > ep)
+                        {
+                            return false;
+                        }
+                        sp = lfds.get_row_start(sp_row);
+                        sa_sp = this->row_samples[sp_row];
+                    }
+                    if (lfds.get_char_by_row_index(ep_row) != c)
+                    {
+                        ep_row = lfds.get_previous_row_with_char(ep_row - 1, c);
+                        ep = lfds.get_row_start(ep_row + 1) - 1;
+                    }
+                    lfds.lf(sp, sp_row);
+                    lfds.lf(ep, ep_row);
+                    sa_sp = sa_sp == 0 ? lfds.size() - 1 : sa_sp - 1;
+                }
+                return true;
+            }
+
+            /**
+             * @brief Returns the number of the occurrences of \p pattern in the text
+             */
+            template <typename PATTERN>
+            uint64_t count(const PATTERN &pattern) const
+            {
+                return this->lf_data_structure.count(pattern);
+            }
+
+            /**
+             * @brief Returns the starting positions of the occurrences of \p pattern in the text, in the order of the suffix array
+             */
+            template <typename PATTERN>
+            std::vector<uint64_t> locate(const PATTERN &pattern) const
+            {
+                std::vector<uint64_t> output;
+                uint64_t sp, ep, sa_value;
+                if (this->backward_search(pattern, sp, ep, sa_value))
+                {
+                    output.resize(ep - sp + 1);
+                    output[0] = sa_value;
+                    for (uint64_t i = 1; i < output.size(); i++)
+                    {
+                        sa_value = this->forward_sa.get_next_sa_value(sa_value);
+                        output[i] = sa_value;
+                    }
+                }
+                return output;
+            }
+
+            /**
+             * @brief Returns the size of this data structure in bytes
+             */
+            uint64_t get_using_memory() const
+            {
+                return this->lf_data_structure.get_using_memory() + this->forward_sa.get_using_memory() + this->row_samples.size() * sizeof(uint64_t);
+            }
+        };
+    } // namespace rlbwt2
+} // namespace stool
@@ -164,11 +164,48 @@ namespace stool
                 return rle;
             }
 
+            /**
+             * @brief Builds the RLE from the characters and the lengths of the runs of a BWT (e.g., the output of PrefixFreeParsing::build_RLBWT)
+             */
+            static RLE<uint8_t> build_from_runs(const std::vector<uint8_t> &run_chars, const std::vector<uint64_t> &run_lengths)
+            {
+                uint64_t run_count = run_chars.size();
+                uint64_t str_size = 0;
+                uint8_t smallest_character = UINT8_MAX;
+                for (uint64_t i = 0; i < run_count; i++)
+                {
+                    str_size += run_lengths[i];
+                    smallest_character = std::min(smallest_character, run_chars[i]);
+                }
+
+                sdsl::int_vector<8> head_char_vec;
+                stool::EliasFanoVector lpos_vec;
+                stool::EliasFanoVectorBuilder run_bits;
+                head_char_vec.resize(run_count);
+                run_bits.initialize(str_size + 1, run_count + 1);
+                for (uint64_t i = 0; i < run_count; i++)
+                {
+                    run_bits.push_bit(true);
+                    for (uint64_t j = 0; j < run_lengths[i]; j++)
+                    {
+                        run_bits.push_bit(false);
+                    }
+                    head_char_vec[i] = run_chars[i];
+                }
+                run_bits.push_bit(true);
+                run_bits.finish();
+                lpos_vec.build_from_builder(run_bits);
+
+                RLE<uint8_t> rle;
+                rle.initialize(head_char_vec, lpos_vec, smallest_character);
+                return rle;
+            }
+
             static RLE<uint8_t> build_from_file(std::string filename, int message_paragraph = stool::Message::SHOW_MESSAGE)
             {
                 TextStatistics ar = TextStatistics::build(filename, message_paragraph);
 
-                stool::OnlineFileReader ofr(filename);
+                stool::OnlineFileReader ofr(filename, stool::OnlineFileReader::PREFETCH_BUFFER_SIZE, true);
                 ofr.open();
                 stool::ForwardRLE frle(ofr.begin(), ofr.end(), ofr.size());
                 RLE<uint8_t> r = RLE::build(frle, ar.run_count, ar.get_smallest_character(), message_paragraph);
@@ -75,7 +75,7 @@ namespace stool
             output_chars.resize(ar.run_count, UINT8_MAX);
             output_runs.resize(ar.run_count, UINT64_MAX);
 
-            stool::OnlineFileReader ofr(file_path);
+            stool::OnlineFileReader ofr(file_path, stool::OnlineFileReader::PREFETCH_BUFFER_SIZE, true);
             ofr.open();
             stool::ForwardRLE frle(ofr.begin(), ofr.end(), ofr.size());
             uint64_t i = 0;
@@ -99,6 +99,35 @@ namespace stool
             }
 
         }
+
+        /**
+         * @brief Writes the BWT represented by the runs (\p run_chars, \p run_lengths) to the file \p file_path without decompressing it in memory
+         */
+        static void write_BWT_from_RLBWT(std::string file_path, const std::vector<uint8_t> &run_chars, const std::vector<uint64_t> &run_lengths)
+        {
+            std::ofstream out(file_path, std::ios::out | std::ios::binary);
+            if (!out)
+            {
+                throw std::runtime_error("Cannot open the file: " + file_path);
+            }
+            std::vector<uint8_t> buffer;
+            uint64_t buffer_size = 1ULL << 20;
+            buffer.reserve(buffer_size);
+            for (uint64_t i = 0; i < run_chars.size(); i++)
+            {
+                for (uint64_t j = 0; j < run_lengths[i]; j++)
+                {
+                    buffer.push_back(run_chars[i]);
+                    if (buffer.size() == buffer_size)
+                    {
+                        out.write((const char *)buffer.data(), buffer.size());
+                        buffer.clear();
+                    }
+                }
+            }
+            out.write((const char *)buffer.data(), buffer.size());
+            out.close();
+        }
     };
 
 } // namespace stool
\ No newline at end of file
@@ -0,0 +1,371 @@
+/**
+ * @file rmq_compact.hpp
+ * @brief Implementation of a compact O(n)-bit index for Range Minimum Query (RMQ).
+ */
+
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include "../basic/parallel_functions.hpp"
+#include "../debug/message.hpp"
+
+namespace stool
+{
+    /**
+     * @brief A compact RMQ index that answers rmq_index(i, j) in O(1) time with O(n) bits in addition to the array
+     *
+     * The array is divided into micro blocks of 8 elements and macro blocks of 256 elements (32 micro blocks).
+     * (1) Each micro block stores the shape of its Cartesian tree as an identifier of 16 bits,
+     *     and the queries in a micro block are answered by a table shared by all the instances (1430 shapes x 64 queries).
+     * (2) Each micro block stores a 32-bit mask of the stack of the leftmost minima of the micro blocks from the start of its macro block,
+     *     so the minimum of the consecutive micro blocks of a macro block is found by a count-trailing-zeros instruction.
+     * (3) A sparse table of 32-bit macro block indexes answers the queries over the consecutive macro blocks.
+     *
+     * The index uses about 6 + 32 log(n/256) / 256 bits per element (less than 10 bits per element for n = 10^10), instead of 64 log n bits of RMQSparseTable,
+     * and each query reads at most five elements of the array. The leftmost position of the minimum is returned as RMQSparseTable::naive_rmq_index.
+     *
+     * @tparam T The data type of the array elements (default: uint64_t)
+     */
+    template <typename T = uint64_t>
+    class RMQCompact
+    {
+    public:
+        /** @brief The number of the elements in a micro block */
+        static inline constexpr uint64_t MICRO_BLOCK_SIZE = 8;
+
+        /** @brief The number of the micro blocks in a macro block */
+        static inline constexpr uint64_t MICRO_BLOCKS_PER_MACRO_BLOCK = 32;
+
+        /** @brief The number of the elements in a macro block */
+        static inline constexpr uint64_t MACRO_BLOCK_SIZE = MICRO_BLOCK_SIZE * MICRO_BLOCKS_PER_MACRO_BLOCK;
+
+    private:
+        /**
+         * @brief The answers of the queries in a micro block for every shape of the Cartesian tree
+         */
+        struct MicroTable
+        {
+            /** @brief The number of the shapes of the Cartesian trees of 8 nodes (the 8th Catalan number) */
+            static inline constexpr uint64_t SHAPE_COUNT = 1430;
+
+            // shape_ids[code] is the identifier of the shape with the stack code, and answers[id * 64 + i * 8 + j] is the answer of the query [i, j].
+            std::vector<uint16_t> shape_ids;
+            std::vector<uint8_t> answers;
+
+            MicroTable()
+            {
+                this->shape_ids.resize(1ULL << 16, UINT16_MAX);
+                this->answers.resize(SHAPE_COUNT * MICRO_BLOCK_SIZE * MICRO_BLOCK_SIZE, 0);
+
+                // Every shape is the shape of a permutation, and the ties of an array are broken to the left, as the permutations ranked by (value, position).
+                std::array<uint64_t, MICRO_BLOCK_SIZE> perm;
+                std::iota(perm.begin(), perm.end(), 0);
+                uint64_t shape_count = 0;
+                do
+                {
+                    uint64_t code = compute_code(perm.data(), MICRO_BLOCK_SIZE);
+                    if (this->shape_ids[code] != UINT16_MAX)
+                    {
+                        continue;
+                    }
+                    this->shape_ids[code] = shape_count;
+                    uint8_t *ans = &this->answers[shape_count * MICRO_BLOCK_SIZE * MICRO_BLOCK_SIZE];
+                    for (uint64_t i = 0; i < MICRO_BLOCK_SIZE; i++)
+                    {
+                        uint64_t min_pos = i;
+                        for (uint64_t j = i; j < MICRO_BLOCK_SIZE; j++)
+                        {
+                            if (perm[j] < perm[min_pos])
+                            {
+                                min_pos = j;
+                            }
+                            ans[i * MICRO_BLOCK_SIZE + j] = min_pos;
+                        }
+                    }
+                    shape_count++;
+                } while (std::next_permutation(perm.begin(), perm.end()));
+                if (shape_count != SHAPE_COUNT)
+                {
+                    throw std::runtime_error("RMQCompact: invalid table of micro blocks");
+                }
+            }
+        };
+
+        std::vector<uint16_t> _micro_shapes;
+        std::vector<uint32_t> _micro_stacks;
+        std::vector<uint8_t> _macro_offsets;
+        // _macro_levels[k-1][m] is the macro block with the leftmost minimum in the macro blocks [m, m + 2^k).
+        std::vector<std::vector<uint32_t>> _macro_levels;
+        uint64_t _size = 0;
+
+        /**
+         * @brief Returns the stack code of the Cartesian tree of \p values[0..size-1] followed by 8 - \p size elements larger than all of them
+         *
+         * The code starts with the bit 1, and each element appends a 0 for each popped element and a 1 for itself.
+         */
+        template <typename VALUE>
+        static uint64_t compute_code(const VALUE *values, uint64_t size)
+        {
+            std::array<VALUE, MICRO_BLOCK_SIZE> stack;
+            uint64_t stack_size = 0;
+            uint64_t code = 1;
+            for (uint64_t i = 0; i < size; i++)
+            {
+                while (stack_size > 0 && stack[stack_size - 1] > values[i])
+                {
+                    stack_size--;
+                    code <<= 1;
+                }
+                stack[stack_size++] = values[i];
+                code = (code << 1) | 1;
+            }
+            for (uint64_t i = size; i < MICRO_BLOCK_SIZE; i++)
+            {
+                code = (code << 1) | 1;
+            }
+            return code;
+        }
+
+        /**
+         * @brief Returns the table of the micro blocks, which is constructed at the first call
+         */
+        static const MicroTable &get_micro_table()
+        {
+            static const MicroTable table;
+            return table;
+        }
+
+        /**
+         * @brief Returns the leftmost minimum of [\p i, \p j] in the \p x-th micro block (positions relative to the micro block)
+         */
+        static uint64_t micro_rmq(const std::vector<uint16_t> &micro_shapes, uint64_t x, uint64_t i, uint64_t j)
+        {
+            return get_micro_table().answers[micro_shapes[x] * (MICRO_BLOCK_SIZE * MICRO_BLOCK_SIZE) + i * MICRO_BLOCK_SIZE + j];
+        }
+
+        /**
+         * @brief Returns the leftmost minimum position of the micro blocks [\p x, \p y] of the same macro block
+         */
+        uint64_t micro_blocks_rmq_index(uint64_t x, uint64_t y) const
+        {
+            uint64_t first = x - (x % MICRO_BLOCKS_PER_MACRO_BLOCK);
+            uint32_t stack = this->_micro_stacks[y] >> (x - first);
+            uint64_t z = x + __builtin_ctz(stack);
+            return z * MICRO_BLOCK_SIZE + micro_rmq(this->_micro_shapes, z, 0, MICRO_BLOCK_SIZE - 1);
+        }
+
+        /**
+         * @brief Returns the leftmost minimum position of [\p i, \p j] in the same macro block
+         */
+        uint64_t macro_block_rmq_index(uint64_t i, uint64_t j, const std::vector<T> &array) const
+        {
+            uint64_t x = i / MICRO_BLOCK_SIZE;
+            uint64_t y = j / MICRO_BLOCK_SIZE;
+            if (x == y)
+            {
+                return x * MICRO_BLOCK_SIZE + micro_rmq(this->_micro_shapes, x, i % MICRO_BLOCK_SIZE, j % MICRO_BLOCK_SIZE);
+            }
+            uint64_t r = x * MICRO_BLOCK_SIZE + micro_rmq(this->_micro_shapes, x, i % MICRO_BLOCK_SIZE, MICRO_BLOCK_SIZE - 1);
+            if (x + 1 < y)
+            {
+                uint64_t center = this->micro_blocks_rmq_index(x + 1, y - 1);
+                r = array[center] < array[r] ? center : r;
+            }
+            uint64_t right = y * MICRO_BLOCK_SIZE + micro_rmq(this->_micro_shapes, y, 0, j % MICRO_BLOCK_SIZE);
+            return array[right] < array[r] ? right : r;
+        }
+
+        uint64_t get_macro_minimum_position(uint64_t m) const
+        {
+            return m * MACRO_BLOCK_SIZE + this->_macro_offsets[m];
+        }
+
+    public:
+        /**
+         * @brief Default constructor
+         */
+        RMQCompact()
+        {
+        }
+
+        /**
+         * @brief Clears the index
+         */
+        void clear()
+        {
+            this->_micro_shapes.clear();
+            this->_micro_stacks.clear();
+            this->_macro_offsets.clear();
+            this->_macro_levels.clear();
+            this->_size = 0;
+        }
+
+        /**
+         * @brief Returns the length of the array of the index
+         */
+        uint64_t size() const
+        {
+            return this->_size;
+        }
+
+        /**
+         * @brief Builds the index of the given array by \p thread_count threads
+         */
+        void build(const std::vector<T> &array, int message_paragraph = stool::Message::NO_MESSAGE, uint64_t thread_count = 1)
+        {
+            if (message_paragraph >= 0)
+            {
+                std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Constructing RMQ index... " << std::flush;
+            }
+            std::chrono::system_clock::time_point st1, st2;
+            st1 = std::chrono::system_clock::now();
+
+            this->clear();
+            const MicroTable &table = get_micro_table();
+            uint64_t n = array.size();
+            uint64_t micro_count = (n + MICRO_BLOCK_SIZE - 1) / MICRO_BLOCK_SIZE;
+            uint64_t macro_count = (n + MACRO_BLOCK_SIZE - 1) / MACRO_BLOCK_SIZE;
+            if (macro_count > UINT32_MAX)
+            {
+                throw std::runtime_error("RMQCompact: the array is too long");
+            }
+            this->_size = n;
+            this->_micro_shapes.resize(micro_count);
+            this->_micro_stacks.resize(micro_count);
+            this->_macro_offsets.resize(macro_count);
+
+            stool::ParallelFunctions::parallel_for_ranges(macro_count, thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+                                                          {
+                std::array<T, MICRO_BLOCKS_PER_MACRO_BLOCK> minima;
+                for (uint64_t m = begin; m < end; m++)
+                {
+                    uint64_t first = m * MICRO_BLOCKS_PER_MACRO_BLOCK;
+                    uint64_t last = std::min(first + MICRO_BLOCKS_PER_MACRO_BLOCK, micro_count);
+                    uint32_t stack = 0;
+                    uint64_t macro_min = 0;
+                    for (uint64_t x = first; x < last; x++)
+                    {
+                        uint64_t start = x * MICRO_BLOCK_SIZE;
+                        uint64_t len = std::min(MICRO_BLOCK_SIZE, n - start);
+                        this->_micro_shapes[x] = table.shape_ids[compute_code(&array[start], len)];
+                        uint64_t min_pos = start + micro_rmq(this->_micro_shapes, x, 0, MICRO_BLOCK_SIZE - 1);
+
+                        // The bit of a micro block is removed if a later micro block has a smaller minimum.
+                        uint64_t y = x - first;
+                        minima[y] = array[min_pos];
+                        while (stack != 0 && minima[31 - __builtin_clz(stack)] > minima[y])
+                        {
+                            stack &= ~(1U << (31 - __builtin_clz(stack)));
+                        }
+                        stack |= 1U << y;
+                        this->_micro_stacks[x] = stack;
+                        if (y == 0 || minima[y] < array[macro_min])
+                        {
+                            macro_min = min_pos;
+                        }
+                    }
+                    this->_macro_offsets[m] = macro_min - m * MACRO_BLOCK_SIZE;
+                } });
+
+            for (uint64_t len = 2; len <= macro_count; len *= 2)
+            {
+                uint64_t half = len / 2;
+                std::vector<uint32_t> level(macro_count - len + 1);
+                const std::vector<uint32_t> *prev = this->_macro_levels.size() > 0 ? &this->_macro_levels.back() : nullptr;
+                stool::ParallelFunctions::parallel_for_ranges(level.size(), thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+                                                              {
+                    for (uint64_t m = begin; m < end; m++)
+                    {
+                        uint64_t left = prev == nullptr ? m : (*prev)[m];
+                        uint64_t right = prev == nullptr ? m + half : (*prev)[m + half];
+                        level[m] = array[this->get_macro_minimum_position(right)] < array[this->get_macro_minimum_position(left)] ? right : left;
+                    } });
+                this->_macro_levels.push_back(std::move(level));
+            }
+
+            st2 = std::chrono::system_clock::now();
+            if (message_paragraph >= 0)
+            {
+                uint64_t ms_time = std::chrono::duration_cast<std::chrono::milliseconds>(st2 - st1).count();
+                std::cout << "[END] Elapsed Time: " << ms_time << " ms" << std::endl;
+            }
+        }
+
+        /**
+         * @brief Finds the index of the (leftmost) minimum element in the range [i, j]
+         *
+         * @param i The starting index of the range (inclusive)
+         * @param j The ending index of the range (inclusive)
+         * @param array The array used to build the index
+         * @throws std::out_of_range if j < i or j >= array.size()
+         */
+        uint64_t rmq_index(uint64_t i, uint64_t j, const std::vector<T> &array) const
+        {
+            if (j < i)
+            {
+                throw std::out_of_range("rmq_index error: j < i");
+            }
+            if (j >= this->_size)
+            {
+                throw std::out_of_range("rmq_index error: j >= array.size()");
+            }
+            uint64_t mi = i / MACRO_BLOCK_SIZE;
+            uint64_t mj = j / MACRO_BLOCK_SIZE;
+            if (mi == mj)
+            {
+                return this->macro_block_rmq_index(i, j, array);
+            }
+
+            uint64_t r = this->macro_block_rmq_index(i, (mi + 1) * MACRO_BLOCK_SIZE - 1, array);
+            if (mi + 1 < mj)
+            {
+                uint64_t a = mi + 1;
+                uint64_t b = mj - 1;
+                uint64_t center;
+                if (a == b)
+                {
+                    center = this->get_macro_minimum_position(a);
+                }
+                else
+                {
+                    uint64_t k = 63 - __builtin_clzll(b - a + 1);
+                    const std::vector<uint32_t> &level = this->_macro_levels[k - 1];
+                    uint64_t left = this->get_macro_minimum_position(level[a]);
+                    uint64_t right = this->get_macro_minimum_position(level[b + 1 - (1ULL << k)]);
+                    center = array[right] < array[left] ? right : left;
+                }
+                r = array[center] < array[r] ? center : r;
+            }
+            uint64_t right = this->macro_block_rmq_index(mj * MACRO_BLOCK_SIZE, j, array);
+            return array[right] < array[r] ? right : r;
+        }
+
+        /**
+         * @brief Returns the minimum element in the range [i, j]
+         */
+        T rmq(uint64_t i, uint64_t j, const std::vector<T> &array) const
+        {
+            return array[this->rmq_index(i, j, array)];
+        }
+
+        /**
+         * @brief Returns the size of this index in bytes (the table of the micro blocks is shared and not included)
+         */
+        uint64_t get_using_memory() const
+        {
+            uint64_t x = this->_micro_shapes.size() * sizeof(uint16_t) + this->_micro_stacks.size() * sizeof(uint32_t) + this->_macro_offsets.size();
+            for (const std::vector<uint32_t> &level : this->_macro_levels)
+            {
+                x += level.size() * sizeof(uint32_t);
+            }
+            return x;
+        }
+    };
+}
@@ -10,16 +10,48 @@ namespace stool
 {
     /**
      * @class RMQSmallSparseTable
-     * @brief A class for performing Range Minimum Query (RMQ) using a small sparse table. [Unchecked AI's Comment] 
+     * @brief A class for performing Range Minimum Query (RMQ) using a small sparse table. [Unchecked AI's Comment]
+     *
+     * The array is divided into blocks of log n elements. The minima of the blocks are stored with their offsets in the blocks,
+     * and RMQSparseTable is built on the minima, so a query scans at most the two blocks containing i and j.
      * @tparam T The data type of the elements in the array, defaulting to uint64_t.
      */
     template <typename T = uint64_t>
     class RMQSmallSparseTable
     {
-        std::vector<uint64_t> _sub_array; ///< Sub-array for storing minimum values.
+        std::vector<T> _sub_array; ///< Sub-array for storing minimum values.
+        std::vector<uint8_t> _sub_offsets; ///< The offsets of the minimum values in the blocks.
         RMQSparseTable<T> _rmq; ///< Sparse table for RMQ operations.
+        uint64_t _block_size = 0;
+
+        /**
+         * @brief Finds the index of the (leftmost) minimum element in the range [i, j] of a block by a branch-free scan
+         */
+        static uint64_t block_rmq_index(uint64_t i, uint64_t j, const std::vector<T> &array)
+        {
+            uint64_t min_index = i;
+            T min_value = array[i];
+            for (uint64_t k = i + 1; k <= j; k++)
+            {
+                bool b = array[k] < min_value;
+                min_value = b ? array[k] : min_value;
+                min_index = b ? k : min_index;
+            }
+            return min_index;
+        }
+
+        /**
+         * @brief Returns the leftmost one of the minimum positions \p x and \p y (x < y)
+         */
+        static uint64_t select_min(uint64_t x, uint64_t y, const std::vector<T> &array)
+        {
+            return array[x] <= array[y] ? x : y;
+        }
 
     public:
+        /** @brief The number of the queries processed together by rmq_index_batch */
+        static inline constexpr uint64_t BATCH_GROUP_SIZE = RMQSparseTable<T>::BATCH_GROUP_SIZE;
+
         /**
          * @brief Default constructor.
          */
@@ -34,23 +66,29 @@ namespace stool
         void build(const std::vector<T> &array)
         {
             _sub_array.clear();
+            _sub_offsets.clear();
             uint64_t logn = stool::Log::log2_floor(array.size());
+            _block_size = logn;
             uint64_t counter = 0;
             T current_minimum = std::numeric_limits<T>::max();
+            uint64_t current_offset = 0;
 
             for(auto p : array){
-                if(current_minimum > p){
+                if(counter == 0 || current_minimum > p){
                     current_minimum = p;
+                    current_offset = counter;
                 }
                 counter++;
                 if(counter == logn){
                     _sub_array.push_back(current_minimum);
+                    _sub_offsets.push_back(current_offset);
                     current_minimum = std::numeric_limits<T>::max();
                     counter = 0;
                 }
             }
             if(counter > 0){
                 _sub_array.push_back(current_minimum);
+                _sub_offsets.push_back(current_offset);
                 counter = 0;
             }
 
@@ -63,47 +101,120 @@ namespace stool
          * @param j The end index of the range.
          * @param array The input array.
          * @return The index of the minimum element in the specified range.
-         * @throws std::out_of_range if j < i.
+         * @throws std::out_of_range if j < i or j >= array.size().
          */
         uint64_t rmq_index(uint64_t i, uint64_t j, const std::vector<T> &array) const
         {
             if(j < i){
                 throw std::out_of_range("rmq_index error: j < i");
             }
+            if(j >= array.size()){
+                throw std::out_of_range("rmq_index error: j >= array.size()");
+            }
             if(array.size() < 2){
                 return RMQSparseTable<T>::naive_rmq_index(i, j, array);
             }
-            uint64_t logn = stool::Log::log2_floor(array.size());
-            //uint64_t len = j - i + 1;
+            uint64_t logn = _block_size;
 
             uint64_t i_pos = i / logn;
             uint64_t j_pos = j / logn;
 
             if(i_pos == j_pos){
-                return RMQSparseTable<T>::naive_rmq_index(i, j, array);
+                return block_rmq_index(i, j, array);
             }else{
-                uint64_t left_rmq_index = RMQSparseTable<T>::naive_rmq_index(i, ((i_pos+1) * logn - 1), array);
-                uint64_t right_rmq_index = RMQSparseTable<T>::naive_rmq_index(j_pos * logn, j, array);
+                uint64_t left_rmq_index = block_rmq_index(i, ((i_pos+1) * logn - 1), array);
+                uint64_t right_rmq_index = block_rmq_index(j_pos * logn, j, array);
 
                 if(i_pos + 1 == j_pos){
-                    return array[left_rmq_index] <= array[right_rmq_index] ? left_rmq_index : right_rmq_index;
+                    return select_min(left_rmq_index, right_rmq_index, array);
                 }else{
                     assert(i_pos+1 <= j_pos-1);
                     uint64_t center_sub_rmq_index = _rmq.rmq_index(i_pos+1, j_pos-1, _sub_array);
-                    uint64_t center_rmq_index = RMQSparseTable<T>::naive_rmq_index(center_sub_rmq_index * logn, ((center_sub_rmq_index+1) * logn) - 1, array);
+                    uint64_t center_rmq_index = center_sub_rmq_index * logn + _sub_offsets[center_sub_rmq_index];
+                    return select_min(select_min(left_rmq_index, center_rmq_index, array), right_rmq_index, array);
+                }
+            }
+        }
 
-                    if(array[left_rmq_index] <= array[right_rmq_index]){
-                        if(array[left_rmq_index] <= array[center_rmq_index]){
-                            return left_rmq_index;
-                        }else{
-                            return center_rmq_index;
-                        }
-                    }else{
-                        if(array[center_rmq_index] <= array[right_rmq_index]){
-                            return center_rmq_index;
-                        }else{
-                            return right_rmq_index;
+        /**
+         * @brief Computes rmq_index(i, j) for every query (i, j) of \p queries and writes the answers to \p output
+         *
+         * The queries crossing blocks are processed in groups of BATCH_GROUP_SIZE queries: the queries on the block minima are answered by RMQSparseTable::rmq_index_batch,
+         * and the boundary blocks and the minima of the center blocks are prefetched before they are scanned.
+         * @throws std::out_of_range if j < i or j >= array.size() for a query
+         */
+        void rmq_index_batch(const std::vector<std::pair<uint64_t, uint64_t>> &queries, std::vector<uint64_t> &output, const std::vector<T> &array) const
+        {
+            output.resize(queries.size());
+            if(array.size() < 2){
+                for (uint64_t x = 0; x < queries.size(); x++)
+                {
+                    output[x] = this->rmq_index(queries[x].first, queries[x].second, array);
+                }
+                return;
+            }
+            uint64_t logn = _block_size;
+            std::vector<std::pair<uint64_t, uint64_t>> sub_queries;
+            std::vector<uint64_t> sub_query_ids;
+            std::vector<uint64_t> sub_output;
+            for (uint64_t begin = 0; begin < queries.size(); begin += BATCH_GROUP_SIZE)
+            {
+                uint64_t end = std::min(begin + BATCH_GROUP_SIZE, (uint64_t)queries.size());
+                sub_queries.clear();
+                sub_query_ids.clear();
+                for (uint64_t x = begin; x < end; x++)
+                {
+                    uint64_t i = queries[x].first;
+                    uint64_t j = queries[x].second;
+                    if (j < i)
+                    {
+                        throw std::out_of_range("rmq_index error: j < i");
+                    }
+                    if (j >= array.size())
+                    {
+                        throw std::out_of_range("rmq_index error: j >= array.size()");
+                    }
+                    __builtin_prefetch(&array[i]);
+                    __builtin_prefetch(&array[j]);
+                    if (i / logn + 1 < j / logn)
+                    {
+                        sub_queries.push_back(std::pair<uint64_t, uint64_t>(i / logn + 1, j / logn - 1));
+                        sub_query_ids.push_back(x);
+                    }
+                }
+                _rmq.rmq_index_batch(sub_queries, sub_output, _sub_array);
+                for (uint64_t y = 0; y < sub_output.size(); y++)
+                {
+                    uint64_t b = sub_output[y];
+                    __builtin_prefetch(&_sub_offsets[b]);
+                }
+                for (uint64_t y = 0; y < sub_output.size(); y++)
+                {
+                    uint64_t b = sub_output[y];
+                    sub_output[y] = b * logn + _sub_offsets[b];
+                    __builtin_prefetch(&array[sub_output[y]]);
+                }
+
+                uint64_t y = 0;
+                for (uint64_t x = begin; x < end; x++)
+                {
+                    uint64_t i = queries[x].first;
+                    uint64_t j = queries[x].second;
+                    uint64_t i_pos = i / logn;
+                    uint64_t j_pos = j / logn;
+                    if (i_pos == j_pos)
+                    {
+                        output[x] = block_rmq_index(i, j, array);
+                    }
+                    else
+                    {
+                        uint64_t r = block_rmq_index(i, ((i_pos + 1) * logn - 1), array);
+                        if (y < sub_query_ids.size() && sub_query_ids[y] == x)
+                        {
+                            r = select_min(r, sub_output[y], array);
+                            y++;
                         }
+                        output[x] = select_min(r, block_rmq_index(j_pos * logn, j, array), array);
                     }
                 }
             }
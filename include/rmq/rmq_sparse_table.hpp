@@ -2,6 +2,9 @@
 #include "../basic/log.hpp"
 #include "../debug/debug_printer.hpp"
 #include <cassert>
+#include <utility>
+#include <array>
+#include <vector>
 
 namespace stool
 {
@@ -13,14 +16,35 @@ namespace stool
      * the sparse table technique. It preprocesses the array in O(n log n) time and
      * can answer RMQ queries in O(1) time.
      * 
+     * The table is stored level by level in a single array: the y-th level stores, for each position j,
+     * the 32-bit offset from j to the minimum of [j, j + 2^{y+1}), so it uses 4n log n bytes without per-position allocations.
+     * 
      * @tparam T The data type of the array elements (default: uint64_t)
      */
     template <typename T = uint64_t>
     class RMQSparseTable
     {
-        std::vector<std::vector<uint64_t>> _sparse_table;
+        std::vector<uint32_t> _sparse_table;
+        uint64_t _size = 0;
+        uint64_t _level_count = 0;
+
+        /**
+         * @brief Returns the level whose two entries at \p i and j - 2^{level+1} + 1 cover [i, j], or UINT64_MAX if i == j
+         */
+        static uint64_t get_level(uint64_t i, uint64_t j)
+        {
+            uint64_t k = stool::Log::log2_floor(j - i + 1);
+            return k == 0 ? UINT64_MAX : k - 1;
+        }
+        const uint32_t *get_entry(uint64_t level, uint64_t position) const
+        {
+            return &this->_sparse_table[level * this->_size + position];
+        }
 
     public:
+        /** @brief The number of the queries processed together by rmq_index_batch */
+        static inline constexpr uint64_t BATCH_GROUP_SIZE = 32;
+
         /**
          * @brief Default constructor
          * 
@@ -37,6 +61,8 @@ namespace stool
          */
         void clear(){
             _sparse_table.clear();
+            _size = 0;
+            _level_count = 0;
         }
 
         /**
@@ -50,50 +76,39 @@ namespace stool
         void build(const std::vector<T> &array)
         {
             this->clear();
-            _sparse_table.resize(array.size());
-
-            uint64_t logn = stool::Log::log2_floor(array.size());
-            for (uint64_t i = 0; i < array.size(); i++)
-            {
-                _sparse_table[i].resize(logn, std::numeric_limits<T>::max());
-            }
-            /*
-            for (uint64_t j = 0; j < array.size(); j++)
+            uint64_t n = array.size();
+            uint64_t logn = stool::Log::log2_floor(n);
+            if (logn > 32)
             {
-                _sparse_table[j][0] = array[j];
+                throw std::runtime_error("RMQSparseTable: the array is too long for 32-bit offsets");
             }
-            */
+            this->_size = n;
+            this->_level_count = logn;
+            _sparse_table.resize(n * logn);
 
             uint64_t len = 1;
             for (uint64_t y = 0; y < logn; y++)
             {
-                std::cout << "y: " << y << "/" << logn << std::endl;
-                for (uint64_t j = 0; j < array.size(); j++)
+                uint32_t *level = &_sparse_table[y * n];
+                const uint32_t *prev_level = y > 0 ? &_sparse_table[(y - 1) * n] : nullptr;
+                for (uint64_t j = 0; j < n; j++)
                 {
-                    if (j + len < array.size())
+                    if (j + len < n)
                     {
                         if (y > 0)
                         {
-                            uint64_t left = _sparse_table[j][y - 1];
-                            uint64_t right = _sparse_table[j + len][y - 1];
-
-                            _sparse_table[j][y] = array[left] <= array[right] ? left : right;
+                            uint64_t left = j + prev_level[j];
+                            uint64_t right = j + len + prev_level[j + len];
+                            level[j] = (array[left] <= array[right] ? left : right) - j;
                         }
                         else
                         {
-                            _sparse_table[j][y] = array[j] <= array[j + len] ? j : j + len;
+                            level[j] = array[j] <= array[j + len] ? 0 : len;
                         }
                     }
                     else
                     {
-                        if (y > 0)
-                        {
-                            _sparse_table[j][y] = _sparse_table[j][y - 1];
-                        }
-                        else
-                        {
-                            _sparse_table[j][y] = j;
-                        }
+                        level[j] = y > 0 ? prev_level[j] : 0;
                     }
                 }
                 len *= 2;
@@ -133,18 +148,71 @@ namespace stool
             }
             else
             {
-                uint64_t mlen = 1 << k;
-                //std::cout << "i: " << i << ", j: " << j << ", k: " << k << ", mlen: " << mlen  << std::endl;
-
-                assert(_sparse_table[i].size() > k-1);
-                uint64_t left = _sparse_table[i][k-1];
-                uint64_t right = _sparse_table[j - mlen + 1][k-1];
-                //std::cout << ", left: " << left << ", right: " << right << std::endl;
+                uint64_t left = i + *this->get_entry(k - 1, i);
+                uint64_t right_start = j - (1ULL << k) + 1;
+                uint64_t right = right_start + *this->get_entry(k - 1, right_start);
                 assert(i <= left && left <= j);
                 assert(i <= right && right <= j);
                 return array[left] <= array[right] ? left : right;
             }
         }
+
+        /**
+         * @brief Computes rmq_index(i, j) for every query (i, j) of \p queries and writes the answers to \p output
+         * 
+         * The queries are processed in groups of BATCH_GROUP_SIZE queries in three stages: the table entries of all the queries of a group are prefetched,
+         * then the array elements of the candidates are prefetched, and then the candidates are compared,
+         * so the cache misses of the queries of a group overlap.
+         * 
+         * @throws std::out_of_range if j < i or j >= array.size() for a query
+         */
+        void rmq_index_batch(const std::vector<std::pair<uint64_t, uint64_t>> &queries, std::vector<uint64_t> &output, const std::vector<T> &array) const
+        {
+            output.resize(queries.size());
+            std::array<uint64_t, BATCH_GROUP_SIZE> levels, lefts, rights;
+            for (uint64_t begin = 0; begin < queries.size(); begin += BATCH_GROUP_SIZE)
+            {
+                uint64_t end = std::min(begin + BATCH_GROUP_SIZE, (uint64_t)queries.size());
+                for (uint64_t x = begin; x < end; x++)
+                {
+                    uint64_t i = queries[x].first;
+                    uint64_t j = queries[x].second;
+                    if (j < i)
+                    {
+                        throw std::out_of_range("rmq_index error: j < i");
+                    }
+                    if (j >= array.size())
+                    {
+                        throw std::out_of_range("rmq_index error: j >= array.size()");
+                    }
+                    uint64_t y = x - begin;
+                    levels[y] = get_level(i, j);
+                    lefts[y] = i;
+                    rights[y] = levels[y] == UINT64_MAX ? i : j - (2ULL << levels[y]) + 1;
+                    if (levels[y] != UINT64_MAX)
+                    {
+                        __builtin_prefetch(this->get_entry(levels[y], lefts[y]));
+                        __builtin_prefetch(this->get_entry(levels[y], rights[y]));
+                    }
+                }
+                for (uint64_t x = begin; x < end; x++)
+                {
+                    uint64_t y = x - begin;
+                    if (levels[y] != UINT64_MAX)
+                    {
+                        lefts[y] += *this->get_entry(levels[y], lefts[y]);
+                        rights[y] += *this->get_entry(levels[y], rights[y]);
+                    }
+                    __builtin_prefetch(&array[lefts[y]]);
+                    __builtin_prefetch(&array[rights[y]]);
+                }
+                for (uint64_t x = begin; x < end; x++)
+                {
+                    uint64_t y = x - begin;
+                    output[x] = array[lefts[y]] <= array[rights[y]] ? lefts[y] : rights[y];
+                }
+            }
+        }
         
         /**
          * @brief Finds the minimum value in the range [i, j]
@@ -219,8 +287,9 @@ namespace stool
          */
         void print() const{
             std::cout << "sparse table" << std::endl;
-            for(uint64_t i = 0; i < _sparse_table.size(); i++){
-                stool::DebugPrinter::print_integers(this->_sparse_table[i], "sparse table");
+            for(uint64_t y = 0; y < this->_level_count; y++){
+                std::vector<uint64_t> level(this->_sparse_table.begin() + y * this->_size, this->_sparse_table.begin() + (y + 1) * this->_size);
+                stool::DebugPrinter::print_integers(level, "sparse table");
             }
         }
     };
@@ -0,0 +1,357 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace stool
+{
+    /**
+     * @brief A rank data structure for a byte sequence that stores the occurrence counts next to the characters
+     *
+     * The sequence is divided into blocks of B characters, where B is the smallest power of two such that B >= 64 and B >= 4σ (σ is the number of distinct characters).
+     * Each block is stored as a record consisting of the occurrence counts of all the characters before the block (16 bits each, relative to the superblock)
+     * followed by the characters of the block, so a rank query touches one record and one superblock entry.
+     * Superblocks of SUPERBLOCK_SIZE characters store the absolute counts.
+     * The space is at most 1.5n + O(σn / SUPERBLOCK_SIZE) bytes for a sequence of length n.
+     *
+     * rank(i, c) and interval_symbols(i, j, ...) take O(σ + B) time, regardless of the number of distinct characters in the range.
+     * \ingroup CollectionClasses
+     */
+    class ByteRankDirectory
+    {
+    public:
+        /** @brief The number of characters in a superblock */
+        static inline constexpr uint64_t SUPERBLOCK_SIZE = 1ULL << 16;
+
+        /** @brief The minimum number of characters in a block */
+        static inline constexpr uint64_t MIN_BLOCK_SIZE = 64;
+
+        /** @brief The identifier of a character that does not occur in the sequence */
+        static inline constexpr uint16_t ABSENT_CHAR = UINT16_MAX;
+
+    private:
+        uint64_t text_size = 0;
+        uint64_t block_size = MIN_BLOCK_SIZE;
+        uint64_t log_block_size = 6;
+        uint64_t counts_byte_size = 0;
+        uint64_t record_byte_size = 0;
+
+        // alphabet[id] is the id-th smallest character of the sequence, and char_ids[c] is the identifier of c (ABSENT_CHAR if c does not occur).
+        std::vector<uint8_t> alphabet;
+        std::array<uint16_t, 256> char_ids;
+
+        // The records are stored in 64-bit words so that the counts are aligned; the characters are stored as their identifiers.
+        std::vector<uint64_t> records;
+        std::vector<uint64_t> superblock_counts;
+
+        const uint8_t *get_record(uint64_t block_index) const
+        {
+            return reinterpret_cast<const uint8_t *>(this->records.data()) + block_index * this->record_byte_size;
+        }
+        uint8_t *get_record(uint64_t block_index)
+        {
+            return reinterpret_cast<uint8_t *>(this->records.data()) + block_index * this->record_byte_size;
+        }
+
+        /**
+         * @brief Returns the number of occurrences of \p id in chars[0..len-1], where \p chars is the block of a record and \p len < block_size
+         *
+         * Eight characters are compared at once; a byte of w ^ (id * 0x0101...) is zero iff the character is \p id,
+         * and the zero bytes are detected without carries between the bytes. The matches are accumulated per byte (at most block_size / 8 <= 128 each),
+         * the byte counters are folded into 16-bit counters, and these are summed by a multiplication at the end, so no popcount instruction is required.
+         * The result can exceed 255 when the block is longer than 256 characters, so the bytes are not summed by a multiplication directly.
+         */
+        static uint64_t count_id(const uint8_t *chars, uint64_t len, uint8_t id)
+        {
+            constexpr uint64_t LOW7 = 0x7F7F7F7F7F7F7F7FULL;
+            constexpr uint64_t ONES = 0x0101010101010101ULL;
+            uint64_t pattern = ONES * id;
+            uint64_t byte_counts = 0;
+            uint64_t word_count = len >> 3;
+            uint64_t w, x;
+            for (uint64_t p = 0; p < word_count; p++)
+            {
+                std::memcpy(&w, chars + (p << 3), sizeof(uint64_t));
+                x = w ^ pattern;
+                byte_counts += (~(((x & LOW7) + LOW7) | x | LOW7)) >> 7;
+            }
+            // The last word is in the block because len < block_size.
+            std::memcpy(&w, chars + (word_count << 3), sizeof(uint64_t));
+            x = w ^ pattern;
+            uint64_t mask = (1ULL << ((len & 7) * 8)) - 1;
+            byte_counts += ((~(((x & LOW7) + LOW7) | x | LOW7)) & mask) >> 7;
+            constexpr uint64_t LOW_BYTES = 0x00FF00FF00FF00FFULL;
+            constexpr uint64_t ONES16 = 0x0001000100010001ULL;
+            uint64_t short_counts = (byte_counts & LOW_BYTES) + ((byte_counts >> 8) & LOW_BYTES);
+            return (short_counts * ONES16) >> 48;
+        }
+
+        /**
+         * @brief Stores rank(i, alphabet[id]) in \p output[id] for every id
+         */
+        void compute_all_ranks(uint64_t i, uint64_t *output) const
+        {
+            uint64_t sigma = this->alphabet.size();
+            uint64_t block_index = i >> this->log_block_size;
+            const uint64_t *super = &this->superblock_counts[(i / SUPERBLOCK_SIZE) * sigma];
+            const uint8_t *record = this->get_record(block_index);
+            const uint16_t *counts = reinterpret_cast<const uint16_t *>(record);
+            for (uint64_t id = 0; id < sigma; id++)
+            {
+                output[id] = super[id] + counts[id];
+            }
+            const uint8_t *chars = record + this->counts_byte_size;
+            uint64_t len = i - (block_index << this->log_block_size);
+            for (uint64_t p = 0; p < len; p++)
+            {
+                output[chars[p]]++;
+            }
+        }
+
+        /**
+         * @brief Adds the occurrences of the characters in [i, j) to \p output (indexed by the identifiers)
+         */
+        void add_occurrences(uint64_t i, uint64_t j, uint64_t *output) const
+        {
+            while (i < j)
+            {
+                uint64_t block_index = i >> this->log_block_size;
+                uint64_t block_end = std::min(j, (block_index + 1) << this->log_block_size);
+                const uint8_t *chars = this->get_record(block_index) + this->counts_byte_size;
+                uint64_t begin = i - (block_index << this->log_block_size);
+                uint64_t end = block_end - (block_index << this->log_block_size);
+                for (uint64_t p = begin; p < end; p++)
+                {
+                    output[chars[p]]++;
+                }
+                i = block_end;
+            }
+        }
+
+    public:
+        ByteRankDirectory()
+        {
+            this->char_ids.fill(ABSENT_CHAR);
+        }
+
+        /**
+         * @brief Builds this data structure for \p text
+         * @tparam TEXT A type providing size() and operator[] that returns a value in [0, 255] (e.g., std::vector<uint8_t> or sdsl::wt_huff<>)
+         */
+        template <typename TEXT>
+        void build(const TEXT &text)
+        {
+            uint64_t n = text.size();
+            this->text_size = n;
+
+            std::array<bool, 256> occurs;
+            occurs.fill(false);
+            for (uint64_t i = 0; i < n; i++)
+            {
+                uint64_t c = text[i];
+                if (c > UINT8_MAX)
+                {
+                    throw std::runtime_error("ByteRankDirectory: the sequence contains a character greater than 255");
+                }
+                occurs[c] = true;
+            }
+            this->alphabet.clear();
+            this->char_ids.fill(ABSENT_CHAR);
+            for (uint64_t c = 0; c < 256; c++)
+            {
+                if (occurs[c])
+                {
+                    this->char_ids[c] = this->alphabet.size();
+                    this->alphabet.push_back(c);
+                }
+            }
+            uint64_t sigma = this->alphabet.size();
+
+            this->block_size = MIN_BLOCK_SIZE;
+            this->log_block_size = 6;
+            while (this->block_size < 4 * sigma)
+            {
+                this->block_size *= 2;
+                this->log_block_size++;
+            }
+            this->counts_byte_size = ((sigma * sizeof(uint16_t) + 7) / 8) * 8;
+            this->record_byte_size = this->counts_byte_size + this->block_size;
+
+            // The last record stores the counts at position n when n is a multiple of the block size.
+            uint64_t block_count = (n >> this->log_block_size) + 1;
+            uint64_t superblock_count = (n / SUPERBLOCK_SIZE) + 1;
+            this->records.clear();
+            this->records.resize((block_count * this->record_byte_size) / sizeof(uint64_t), 0);
+            this->superblock_counts.clear();
+            this->superblock_counts.resize(superblock_count * sigma, 0);
+
+            std::vector<uint64_t> total(sigma, 0);
+            std::vector<uint64_t> superblock_start(sigma, 0);
+            for (uint64_t b = 0; b < block_count; b++)
+            {
+                uint64_t start = b << this->log_block_size;
+                if (start % SUPERBLOCK_SIZE == 0)
+                {
+                    superblock_start = total;
+                    std::memcpy(&this->superblock_counts[(start / SUPERBLOCK_SIZE) * sigma], total.data(), sigma * sizeof(uint64_t));
+                }
+                uint8_t *record = this->get_record(b);
+                uint16_t *counts = reinterpret_cast<uint16_t *>(record);
+                for (uint64_t id = 0; id < sigma; id++)
+                {
+                    counts[id] = total[id] - superblock_start[id];
+                }
+                uint8_t *chars = record + this->counts_byte_size;
+                uint64_t end = std::min(n, start + this->block_size);
+                for (uint64_t i = start; i < end; i++)
+                {
+                    uint8_t id = this->char_ids[(uint8_t)text[i]];
+                    chars[i - start] = id;
+                    total[id]++;
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the length of the sequence
+         */
+        uint64_t size() const
+        {
+            return this->text_size;
+        }
+
+        /**
+         * @brief Returns the number of distinct characters in the sequence
+         */
+        uint64_t get_alphabet_size() const
+        {
+            return this->alphabet.size();
+        }
+
+        /**
+         * @brief Returns the number of characters in a block
+         */
+        uint64_t get_block_size() const
+        {
+            return this->block_size;
+        }
+
+        /**
+         * @brief Returns the i-th character of the sequence
+         */
+        uint8_t access(uint64_t i) const
+        {
+            uint64_t block_index = i >> this->log_block_size;
+            return this->alphabet[this->get_record(block_index)[this->counts_byte_size + (i - (block_index << this->log_block_size))]];
+        }
+
+        /**
+         * @brief Returns the i-th character of the sequence
+         */
+        uint8_t operator[](uint64_t i) const
+        {
+            return this->access(i);
+        }
+
+        /**
+         * @brief Returns the number of occurrences of \p c in the first \p i characters of the sequence
+         */
+        uint64_t rank(uint64_t i, uint8_t c) const
+        {
+            uint16_t id = this->char_ids[c];
+            if (id == ABSENT_CHAR)
+            {
+                return 0;
+            }
+            uint64_t block_index = i >> this->log_block_size;
+            const uint8_t *record = this->get_record(block_index);
+            uint64_t r = this->superblock_counts[(i / SUPERBLOCK_SIZE) * this->alphabet.size() + id] + reinterpret_cast<const uint16_t *>(record)[id];
+            uint64_t len = i - (block_index << this->log_block_size);
+            return r + count_id(record + this->counts_byte_size, len, id);
+        }
+
+        /**
+         * @brief Returns the pair (rank(i, c), c) for the i-th character c (the same interface as sdsl::wt_huff::inverse_select)
+         *
+         * The character and its rank are read from the same record, so LF(i) = C[c] + rank(i, c) needs a single record access.
+         */
+        std::pair<uint64_t, uint8_t> inverse_select(uint64_t i) const
+        {
+            uint64_t block_index = i >> this->log_block_size;
+            const uint8_t *record = this->get_record(block_index);
+            const uint8_t *chars = record + this->counts_byte_size;
+            uint64_t len = i - (block_index << this->log_block_size);
+            uint8_t id = chars[len];
+            uint64_t r = this->superblock_counts[(i / SUPERBLOCK_SIZE) * this->alphabet.size() + id] + reinterpret_cast<const uint16_t *>(record)[id] + count_id(chars, len, id);
+            return std::pair<uint64_t, uint8_t>(r, this->alphabet[id]);
+        }
+
+        /**
+         * @brief Prefetches the beginning of the counts and the character at \p i of the record read by rank(i, c) and inverse_select(i) into the cache
+         *
+         * This function is always inlined: GCC regards a function consisting of prefetches as a const function and removes the calls of it otherwise.
+         */
+        __attribute__((always_inline)) inline void prefetch(uint64_t i) const
+        {
+            uint64_t block_index = i >> this->log_block_size;
+            const uint8_t *record = this->get_record(block_index);
+            __builtin_prefetch(record);
+            __builtin_prefetch(record + this->counts_byte_size + (i - (block_index << this->log_block_size)));
+            __builtin_prefetch(&this->superblock_counts[(i / SUPERBLOCK_SIZE) * this->alphabet.size()]);
+        }
+
+        /**
+         * @brief Computes the distinct characters in [i, j) and their ranks (the same interface as sdsl::interval_symbols)
+         *
+         * The number of the distinct characters is stored in \p k. For each x in [0, k), \p cs[x] is the x-th smallest distinct character,
+         * and \p rank_c_i[x] and \p rank_c_j[x] are rank(i, cs[x]) and rank(j, cs[x]), respectively. The output vectors must have 256 elements.
+         */
+        template <typename CHAR_VEC, typename RANK_VEC1, typename RANK_VEC2>
+        void interval_symbols(uint64_t i, uint64_t j, uint64_t &k, CHAR_VEC &cs, RANK_VEC1 &rank_c_i, RANK_VEC2 &rank_c_j) const
+        {
+            k = 0;
+            if (i >= j)
+            {
+                return;
+            }
+            uint64_t sigma = this->alphabet.size();
+            std::array<uint64_t, 256> ranks_i;
+            std::array<uint64_t, 256> ranks_j;
+            this->compute_all_ranks(i, ranks_i.data());
+
+            // A short interval is scanned from i, and a long one is answered by another rank computation.
+            if (j - i <= this->block_size + sigma)
+            {
+                std::memcpy(ranks_j.data(), ranks_i.data(), sigma * sizeof(uint64_t));
+                this->add_occurrences(i, j, ranks_j.data());
+            }
+            else
+            {
+                this->compute_all_ranks(j, ranks_j.data());
+            }
+
+            for (uint64_t id = 0; id < sigma; id++)
+            {
+                if (ranks_j[id] > ranks_i[id])
+                {
+                    cs[k] = this->alphabet[id];
+                    rank_c_i[k] = ranks_i[id];
+                    rank_c_j[k] = ranks_j[id];
+                    k++;
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the size of this data structure in bytes
+         */
+        uint64_t size_in_bytes() const
+        {
+            return sizeof(ByteRankDirectory) + this->alphabet.size() + (this->records.size() + this->superblock_counts.size()) * sizeof(uint64_t);
+        }
+    };
+} // namespace stool
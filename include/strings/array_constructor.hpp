@@ -8,6 +8,9 @@
 #include <stack>
 #include <chrono>
 #include "../debug/message.hpp"
+#include "../basic/parallel_functions.hpp"
+#include "./compressed_plcp_array.hpp"
+#include "../io/mapped_vector.hpp"
 
 namespace stool
 {
@@ -40,6 +43,9 @@ namespace stool
 		}
 
 	public:
+		/** @brief The sampling interval of the PLCP values used by compute_LCP_statistics */
+		static inline constexpr uint64_t LCP_STATISTICS_SAMPLING_INTERVAL = 32;
+
 		/**
 		 * @brief Constructs the suffix array of a text \p T[0..n-1] in a naive way.
 		 */
@@ -67,10 +73,250 @@ namespace stool
 		 * @tparam INDEX The index type for positions (defaults to uint64_t)
 		 * @param sa text's suffix array
 		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
+		 * @param thread_count The number of threads. Each thread scatters a contiguous range of SA into ISA.
 		 * @return ISA
 		 */
 		template <typename INDEX = uint64_t>
-		static std::vector<INDEX> construct_ISA(const std::vector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE)
+		static std::vector<INDEX> construct_ISA(const std::vector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_ISA_impl<INDEX>(sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the Inverse Suffix Array (ISA) from a suffix array (SA) mapped from a file
+		 */
+		template <typename INDEX = uint64_t>
+		static std::vector<INDEX> construct_ISA(const stool::MappedVector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_ISA_impl<INDEX>(sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the LCP of text T array from T, SA, and ISA
+		 *
+		 *
+		 * @tparam TEXT The type of the text (e.g., std::vector<uint8_t>, std::vector<char>, std::string)
+		 * @tparam INDEX The index type for positions (defaults to uint64_t)
+		 * @param text The input text T
+		 * @param sa The SA of T
+		 * @param isa The ISA of T
+		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
+		 * @param thread_count The number of threads. The text positions are split into contiguous ranges, and Kasai's algorithm is run on each range independently.
+		 * @return The LCP array of T
+		 */
+
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static std::vector<INDEX> construct_LCP_array(const TEXT &text, const std::vector<INDEX> &sa, const std::vector<INDEX> &isa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_LCP_array_impl<TEXT, INDEX>(text, sa, isa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the LCP of text T array from T, SA, and ISA, where SA and ISA are mapped from files
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static std::vector<INDEX> construct_LCP_array(const TEXT &text, const stool::MappedVector<INDEX> &sa, const stool::MappedVector<INDEX> &isa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_LCP_array_impl<TEXT, INDEX>(text, sa, isa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the LCP of text T array from T, SA, and ISA. Here, ISA is constructed internally.
+		 *
+		 * @tparam TEXT The type of the text (e.g., std::vector<uint8_t>, std::vector<char>, std::string)
+		 * @tparam INDEX The index type for positions (defaults to uint64_t)
+		 * @param text The input text T
+		 * @param sa The SA of T
+		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
+		 * @param thread_count The number of threads
+		 * @return The LCP array of T
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static std::vector<INDEX> construct_LCP_array(const TEXT &text, const std::vector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_LCP_array_with_ISA_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the LCP of text T array from T and SA mapped from a file. Here, ISA is constructed internally.
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static std::vector<INDEX> construct_LCP_array(const TEXT &text, const stool::MappedVector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_LCP_array_with_ISA_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the permuted LCP array (PLCP) of text T from T and SA by the Φ algorithm
+		 *
+		 * PLCP[SA[i]] = LCP[i] holds. The Φ array (Φ[SA[i]] = SA[i-1]) is computed in the output array and is overwritten by PLCP in text order,
+		 * so this function uses no working space other than the output array.
+		 *
+		 * @tparam TEXT The type of the text (e.g., std::vector<uint8_t>, std::vector<char>, std::string)
+		 * @tparam INDEX The index type for positions (defaults to uint64_t)
+		 * @param text The input text T
+		 * @param sa The SA of T
+		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
+		 * @param thread_count The number of threads
+		 * @return The PLCP array of T
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static std::vector<INDEX> construct_PLCP_array(const TEXT &text, const std::vector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_PLCP_array_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the permuted LCP array (PLCP) of text T from T and SA mapped from a file
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static std::vector<INDEX> construct_PLCP_array(const TEXT &text, const stool::MappedVector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_PLCP_array_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the compressed (2n-bit) PLCP array of text T from T and SA
+		 *
+		 * @tparam TEXT The type of the text (e.g., std::vector<uint8_t>, std::vector<char>, std::string)
+		 * @tparam INDEX The index type for positions (defaults to uint64_t)
+		 * @param text The input text T
+		 * @param sa The SA of T
+		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
+		 * @param thread_count The number of threads
+		 * @return The compressed PLCP array of T
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static stool::CompressedPLCPArray construct_compressed_PLCP_array(const TEXT &text, const std::vector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_compressed_PLCP_array_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the compressed (2n-bit) PLCP array of text T from T and SA mapped from a file
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static stool::CompressedPLCPArray construct_compressed_PLCP_array(const TEXT &text, const stool::MappedVector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_compressed_PLCP_array_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the LCP array of text T from T and SA via the PLCP array
+		 *
+		 * Unlike construct_LCP_array(text, sa), this function does not construct ISA.
+		 * The working space is a single array of n integers, which is returned as the LCP array, and the 2n-bit compressed PLCP array.
+		 *
+		 * @tparam TEXT The type of the text (e.g., std::vector<uint8_t>, std::vector<char>, std::string)
+		 * @tparam INDEX The index type for positions (defaults to uint64_t)
+		 * @param text The input text T
+		 * @param sa The SA of T
+		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
+		 * @param thread_count The number of threads
+		 * @return The LCP array of T
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static std::vector<INDEX> construct_LCP_array_by_PLCP(const TEXT &text, const std::vector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_LCP_array_by_PLCP_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the LCP array of text T from T and SA mapped from a file via the PLCP array
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static std::vector<INDEX> construct_LCP_array_by_PLCP(const TEXT &text, const stool::MappedVector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_LCP_array_by_PLCP_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Computes the LCP statistics (LCPS) array of text T from T and SA without constructing the LCP array
+		 *
+		 * LCPS[d] is the number of the LCP values equal to d. The PLCP values are computed only for every LCP_STATISTICS_SAMPLING_INTERVAL-th text position
+		 * by the sparse Φ algorithm, and each LCP[i] is computed in SA order by extending the lower bound PLCP[SA[i]] >= PLCP[s] - (SA[i] - s),
+		 * where s is the sampled position at or before SA[i]. The LCP values are counted and discarded immediately,
+		 * so the working space is n / LCP_STATISTICS_SAMPLING_INTERVAL integers in addition to T and SA (the running time is O(n * LCP_STATISTICS_SAMPLING_INTERVAL) in the worst case).
+		 *
+		 * @tparam TEXT The type of the text (e.g., std::vector<uint8_t>, std::vector<char>, std::string)
+		 * @tparam INDEX The index type for positions (defaults to uint64_t)
+		 * @param text The input text T
+		 * @param sa The SA of T
+		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
+		 * @param thread_count The number of threads
+		 * @return The LCPS array of T (the same as SubstringComplexityFunctions::compute_LCP_statistics(LCP array of T))
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static std::vector<uint64_t> compute_LCP_statistics(const TEXT &text, const std::vector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return compute_LCP_statistics_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Computes the LCP statistics (LCPS) array of text T from T and SA mapped from a file without constructing the LCP array
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static std::vector<uint64_t> compute_LCP_statistics(const TEXT &text, const stool::MappedVector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return compute_LCP_statistics_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+		/**
+		 * @brief Constructs the Differential Suffix Array (DSA) from a SA
+		 *
+		 * The Differential Suffix Array stores the differences between consecutive
+		 * elements in the suffix array. For position i, DSA[i] = SA[i] - SA[i-1]
+		 * (with DSA[0] = SA[0]). This representation is useful for compression
+		 * and certain string processing algorithms.
+		 *
+		 * @param sa The SA of T
+		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
+		 * @param thread_count The number of threads
+		 * @return The DSA of T
+		 */
+		static std::vector<int64_t> construct_DSA(const std::vector<uint64_t> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_DSA_impl(sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the Differential Suffix Array (DSA) from a SA mapped from a file
+		 */
+		static std::vector<int64_t> construct_DSA(const stool::MappedVector<uint64_t> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_DSA_impl(sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the Burrows-Wheeler Transform (BWT) from a text and its SA
+		 *
+		 * @tparam TEXT The type of the text (e.g., std::vector<uint8_t>, std::vector<char>, std::string)
+		 * @tparam INDEX The integer type used for the SA (defaults to uint64_t)
+		 * @param text The input text T
+		 * @param sa The SA of T
+		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
+		 * @param thread_count The number of threads. TEXT must support concurrent writes to distinct elements (e.g., std::vector<bool> is not allowed).
+		 * @return The BWT of T
+		 */
+
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static TEXT construct_BWT(const TEXT &text, const std::vector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_BWT_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+		/*!
+		 * @brief Constructs the Burrows-Wheeler Transform (BWT) from a text and its SA mapped from a file
+		 */
+		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
+		static TEXT construct_BWT(const TEXT &text, const stool::MappedVector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+		{
+			return construct_BWT_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+		}
+
+	private:
+		template <typename INDEX, typename SA_ARRAY>
+		static std::vector<INDEX> construct_ISA_impl(const SA_ARRAY &sa, int message_paragraph, uint64_t thread_count)
 		{
 			if (message_paragraph >= 0 && sa.size() > 0)
 			{
@@ -83,10 +329,13 @@ namespace stool
 			uint64_t n = sa.size();
 			isa.resize(n);
 
-			for (uint64_t i = 0; i < sa.size(); ++i)
-			{
-				isa[sa[i]] = i;
-			}
+			// The threads write to distinct positions of ISA because SA is a permutation.
+			stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+														  {
+															  for (uint64_t i = begin; i < end; ++i)
+															  {
+																  isa[sa[i]] = i;
+															  } });
 			st2 = std::chrono::system_clock::now();
 
 			if (message_paragraph >= 0 && sa.size() > 0)
@@ -101,21 +350,8 @@ namespace stool
 			return isa;
 		}
 
-		/*!
-		 * @brief Constructs the LCP of text T array from T, SA, and ISA
-		 *
-		 *
-		 * @tparam TEXT The type of the text (e.g., std::vector<uint8_t>, std::vector<char>, std::string)
-		 * @tparam INDEX The index type for positions (defaults to uint64_t)
-		 * @param text The input text T
-		 * @param sa The SA of T
-		 * @param isa The ISA of T
-		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
-		 * @return The LCP array of T
-		 */
-
-		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
-		static std::vector<INDEX> construct_LCP_array(const TEXT &text, const std::vector<INDEX> &sa, const std::vector<INDEX> &isa, int message_paragraph = stool::Message::SHOW_MESSAGE)
+		template <typename TEXT, typename INDEX, typename SA_ARRAY, typename ISA_ARRAY>
+		static std::vector<INDEX> construct_LCP_array_impl(const TEXT &text, const SA_ARRAY &sa, const ISA_ARRAY &isa, int message_paragraph, uint64_t thread_count)
 		{
 			if (message_paragraph >= 0 && text.size() > 0)
 			{
@@ -126,37 +362,153 @@ namespace stool
 
 			std::vector<INDEX> lcp;
 			lcp.resize(text.size(), 0);
-			INDEX n = text.size();
-			INDEX k = 0;
+			uint64_t n = text.size();
+
+			// Kasai's algorithm only needs a lower bound of LCP[ISA[i]] when it starts at position i.
+			// Each range starts with the trivial bound 0, which costs at most LCP[ISA[begin]] extra comparisons per range.
+			stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+														  {
+				uint64_t k = 0;
+				for (uint64_t i = begin; i < end; i++)
+				{
+					uint64_t x = isa[i];
+					assert(x < n);
+
+					if (x == 0)
+					{
+						k = 0;
+					}
+					else
+					{
+						uint64_t y = sa[x - 1];
+						while (i + k < n && y + k < n && text[i + k] == text[y + k])
+						{
+							k++;
+						}
+					}
+					lcp[x] = k;
 
-			for (INDEX i = 0; i < n; i++)
+					assert(x == 0 || (x > 0 && ((n - sa[x - 1]) >= k)));
+
+					if (k > 0)
+						k--;
+				} });
+
+			st2 = std::chrono::system_clock::now();
+
+			if (message_paragraph >= 0 && text.size() > 0)
 			{
+				uint64_t sec_time = std::chrono::duration_cast<std::chrono::seconds>(st2 - st1).count();
+				uint64_t ms_time = std::chrono::duration_cast<std::chrono::milliseconds>(st2 - st1).count();
+				uint64_t per_time = ((double)ms_time / (double)text.size()) * 1000000;
 
-				assert(i < n);
-				INDEX x = isa[i];
-				assert(x < n);
+				std::cout << "[END] Elapsed Time: " << sec_time << " sec (" << per_time << " ms/MB)" << std::endl;
+			}
+			return lcp;
+		}
 
-				if (x == 0)
-				{
-					lcp[x] = 0;
-				}
-				else
+		template <typename TEXT, typename INDEX, typename SA_ARRAY>
+		static std::vector<INDEX> construct_LCP_array_with_ISA_impl(const TEXT &text, const SA_ARRAY &sa, int message_paragraph, uint64_t thread_count)
+		{
+			std::vector<INDEX> isa = construct_ISA_impl<INDEX>(sa, message_paragraph, thread_count);
+			return construct_LCP_array_impl<TEXT, INDEX>(text, sa, isa, message_paragraph, thread_count);
+		}
+
+		template <typename TEXT, typename INDEX, typename SA_ARRAY>
+		static std::vector<INDEX> construct_PLCP_array_impl(const TEXT &text, const SA_ARRAY &sa, int message_paragraph, uint64_t thread_count)
+		{
+			if (message_paragraph >= 0 && text.size() > 0)
+			{
+				std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Constructing PLCP Array from SA... " << std::flush;
+			}
+			std::chrono::system_clock::time_point st1, st2;
+			st1 = std::chrono::system_clock::now();
+
+			uint64_t n = text.size();
+			std::vector<INDEX> plcp;
+			plcp.resize(n, 0);
+
+			// Φ[SA[0]] = n represents that T[SA[0]..n-1] has no predecessor.
+			stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+														  {
+															  for (uint64_t i = begin; i < end; i++)
+															  {
+																  plcp[sa[i]] = i == 0 ? n : (uint64_t)sa[i - 1];
+															  } });
+
+			// PLCP[i+1] >= PLCP[i] - 1 holds, and each range starts with the trivial bound 0.
+			stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+														  {
+				uint64_t k = 0;
+				for (uint64_t i = begin; i < end; i++)
 				{
-					while (sa[x] + k < n && sa[x - 1] + k < n && text[sa[x] + k] == text[sa[x - 1] + k])
+					uint64_t j = plcp[i];
+					if (j == n)
 					{
-						assert(sa[x] + k < n);
-						assert(sa[x - 1] + k < n);
-
-						k++;
+						k = 0;
 					}
-				}
-				lcp[x] = k;
+					else
+					{
+						while (i + k < n && j + k < n && text[i + k] == text[j + k])
+						{
+							k++;
+						}
+					}
+					plcp[i] = k;
+					if (k > 0)
+						k--;
+				} });
+
+			st2 = std::chrono::system_clock::now();
 
-				assert(x == 0 || (x > 0 && ((n - sa[x - 1]) >= k)));
+			if (message_paragraph >= 0 && text.size() > 0)
+			{
+				uint64_t sec_time = std::chrono::duration_cast<std::chrono::seconds>(st2 - st1).count();
+				uint64_t ms_time = std::chrono::duration_cast<std::chrono::milliseconds>(st2 - st1).count();
+				uint64_t per_time = ((double)ms_time / (double)text.size()) * 1000000;
 
-				if (k > 0)
-					k--;
+				std::cout << "[END] Elapsed Time: " << sec_time << " sec (" << per_time << " ms/MB)" << std::endl;
+			}
+			return plcp;
+		}
+
+		template <typename TEXT, typename INDEX, typename SA_ARRAY>
+		static stool::CompressedPLCPArray construct_compressed_PLCP_array_impl(const TEXT &text, const SA_ARRAY &sa, int message_paragraph, uint64_t thread_count)
+		{
+			stool::CompressedPLCPArray r;
+			{
+				std::vector<INDEX> plcp = construct_PLCP_array_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+				r.build(plcp);
 			}
+			return r;
+		}
+
+		template <typename TEXT, typename INDEX, typename SA_ARRAY>
+		static std::vector<INDEX> construct_LCP_array_by_PLCP_impl(const TEXT &text, const SA_ARRAY &sa, int message_paragraph, uint64_t thread_count)
+		{
+			std::vector<INDEX> lcp = construct_PLCP_array_impl<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+
+			if (message_paragraph >= 0 && text.size() > 0)
+			{
+				std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Constructing LCP Array from PLCP Array... " << std::flush;
+			}
+			std::chrono::system_clock::time_point st1, st2;
+			st1 = std::chrono::system_clock::now();
+
+			// The PLCP array is compressed so that the same array can be reused for the LCP array.
+			stool::CompressedPLCPArray plcp;
+			plcp.build(lcp);
+			stool::ParallelFunctions::parallel_for_ranges(lcp.size(), thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+														  {
+															  constexpr uint64_t PREFETCH_DISTANCE = 32;
+															  for (uint64_t i = begin; i < end; i++)
+															  {
+																  if (i + PREFETCH_DISTANCE < end)
+																  {
+																	  plcp.prefetch(sa[i + PREFETCH_DISTANCE]);
+																  }
+																  lcp[i] = plcp.access(sa[i]);
+															  } });
 
 			st2 = std::chrono::system_clock::now();
 
@@ -171,39 +523,120 @@ namespace stool
 			return lcp;
 		}
 
-		/*!
-		 * @brief Constructs the LCP of text T array from T, SA, and ISA. Here, ISA is constructed internally.
-		 *
-		 * @tparam TEXT The type of the text (e.g., std::vector<uint8_t>, std::vector<char>, std::string)
-		 * @tparam INDEX The index type for positions (defaults to uint64_t)
-		 * @param text The input text T
-		 * @param sa The SA of T
-		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
-		 * @return The LCP array of T
-		 */
-		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
-		static std::vector<INDEX> construct_LCP_array(const TEXT &text, const std::vector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE)
+		template <typename TEXT, typename INDEX, typename SA_ARRAY>
+		static std::vector<uint64_t> compute_LCP_statistics_impl(const TEXT &text, const SA_ARRAY &sa, int message_paragraph, uint64_t thread_count)
 		{
+			if (message_paragraph >= 0 && text.size() > 0)
+			{
+				std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Computing LCP statistics from SA... " << std::flush;
+			}
+			std::chrono::system_clock::time_point st1, st2;
+			st1 = std::chrono::system_clock::now();
+
+			constexpr uint64_t q = LCP_STATISTICS_SAMPLING_INTERVAL;
+			uint64_t n = text.size();
+			std::vector<uint64_t> lcp_statistics;
+			if (n == 0)
+			{
+				return lcp_statistics;
+			}
+
+			// samples[x] = Φ[xq] (n if xq = SA[0]), which is then overwritten by PLCP[xq].
+			uint64_t sample_count = (n + q - 1) / q;
+			std::vector<INDEX> samples;
+			samples.resize(sample_count, 0);
+			stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+														  {
+															  for (uint64_t i = begin; i < end; i++)
+															  {
+																  uint64_t p = sa[i];
+																  if (p % q == 0)
+																  {
+																	  samples[p / q] = i == 0 ? n : (uint64_t)sa[i - 1];
+																  }
+															  } });
+
+			// PLCP[(x+1)q] >= PLCP[xq] - q holds, and each range starts with the trivial bound 0.
+			stool::ParallelFunctions::parallel_for_ranges(sample_count, thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+														  {
+				uint64_t k = 0;
+				for (uint64_t x = begin; x < end; x++)
+				{
+					uint64_t i = x * q;
+					uint64_t j = samples[x];
+					if (j == n)
+					{
+						k = 0;
+					}
+					else
+					{
+						while (i + k < n && j + k < n && text[i + k] == text[j + k])
+						{
+							k++;
+						}
+					}
+					samples[x] = k;
+					k = k > q ? k - q : 0;
+				} });
+
+			uint64_t range_count = stool::ParallelFunctions::get_range_count(n, thread_count);
+			std::vector<std::vector<uint64_t>> local_statistics(range_count);
+			stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t begin, uint64_t end)
+														  {
+															  std::vector<uint64_t> &counts = local_statistics[t];
+															  for (uint64_t i = begin; i < end; i++)
+															  {
+																  uint64_t k = 0;
+																  if (i > 0)
+																  {
+																	  uint64_t p = sa[i];
+																	  uint64_t y = sa[i - 1];
+																	  uint64_t sample = samples[p / q];
+																	  uint64_t distance = p % q;
+																	  k = sample > distance ? sample - distance : 0;
+																	  while (p + k < n && y + k < n && text[p + k] == text[y + k])
+																	  {
+																		  k++;
+																	  }
+																  }
+																  if (k >= counts.size())
+																  {
+																	  counts.resize(std::max(k + 1, counts.size() * 2), 0);
+																  }
+																  counts[k]++;
+															  } });
+
+			for (const std::vector<uint64_t> &counts : local_statistics)
+			{
+				if (counts.size() > lcp_statistics.size())
+				{
+					lcp_statistics.resize(counts.size(), 0);
+				}
+				for (uint64_t d = 0; d < counts.size(); d++)
+				{
+					lcp_statistics[d] += counts[d];
+				}
+			}
+			while (lcp_statistics.size() > 1 && lcp_statistics.back() == 0)
+			{
+				lcp_statistics.pop_back();
+			}
 
-			std::vector<INDEX> isa = stool::ArrayConstructor::construct_ISA<INDEX>(sa, message_paragraph);
-			return construct_LCP_array<TEXT, INDEX>(text, sa, isa, message_paragraph);
+			st2 = std::chrono::system_clock::now();
+
+			if (message_paragraph >= 0 && text.size() > 0)
+			{
+				uint64_t sec_time = std::chrono::duration_cast<std::chrono::seconds>(st2 - st1).count();
+				uint64_t ms_time = std::chrono::duration_cast<std::chrono::milliseconds>(st2 - st1).count();
+				uint64_t per_time = ((double)ms_time / (double)text.size()) * 1000000;
 
-			// lcp.resize(text.size(), 0);
+				std::cout << "[END] Elapsed Time: " << sec_time << " sec (" << per_time << " ms/MB)" << std::endl;
+			}
+			return lcp_statistics;
 		}
 
-		/**
-		 * @brief Constructs the Differential Suffix Array (DSA) from a SA
-		 *
-		 * The Differential Suffix Array stores the differences between consecutive
-		 * elements in the suffix array. For position i, DSA[i] = SA[i] - SA[i-1]
-		 * (with DSA[0] = SA[0]). This representation is useful for compression
-		 * and certain string processing algorithms.
-		 *
-		 * @param sa The SA of T
-		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
-		 * @return The DSA of T
-		 */
-		static std::vector<int64_t> construct_DSA(const std::vector<uint64_t> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE)
+		template <typename SA_ARRAY>
+		static std::vector<int64_t> construct_DSA_impl(const SA_ARRAY &sa, int message_paragraph, uint64_t thread_count)
 		{
 			if (message_paragraph >= 0 && sa.size() > 0)
 			{
@@ -214,17 +647,19 @@ namespace stool
 
 			std::vector<int64_t> dsa;
 			dsa.resize(sa.size(), 0);
-			for (uint64_t i = 0; i < sa.size(); i++)
-			{
-				if (i == 0)
-				{
-					dsa[i] = sa[i];
-				}
-				else
-				{
-					dsa[i] = ((int64_t)sa[i]) - ((int64_t)sa[i - 1]);
-				}
-			}
+			stool::ParallelFunctions::parallel_for_ranges(sa.size(), thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+														  {
+															  for (uint64_t i = begin; i < end; i++)
+															  {
+																  if (i == 0)
+																  {
+																	  dsa[i] = sa[i];
+																  }
+																  else
+																  {
+																	  dsa[i] = ((int64_t)sa[i]) - ((int64_t)sa[i - 1]);
+																  }
+															  } });
 
 			st2 = std::chrono::system_clock::now();
 
@@ -240,19 +675,8 @@ namespace stool
 			return dsa;
 		}
 
-		/*!
-		 * @brief Constructs the Burrows-Wheeler Transform (BWT) from a text and its SA
-		 *
-		 * @tparam TEXT The type of the text (e.g., std::vector<uint8_t>, std::vector<char>, std::string)
-		 * @tparam INDEX The integer type used for the SA (defaults to uint64_t)
-		 * @param text The input text T
-		 * @param sa The SA of T
-		 * @param message_paragraph The paragraph depth of message logs (-1 for no output)
-		 * @return The BWT of T
-		 */
-
-		template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
-		static TEXT construct_BWT(const TEXT &text, const std::vector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE)
+		template <typename TEXT, typename INDEX, typename SA_ARRAY>
+		static TEXT construct_BWT_impl(const TEXT &text, const SA_ARRAY &sa, int message_paragraph, uint64_t thread_count)
 		{
 			if (message_paragraph >= 0 && text.size() > 0)
 			{
@@ -263,18 +687,14 @@ namespace stool
 
 			TEXT bwt;
 			bwt.resize(text.size());
-			INDEX n = text.size();
-			for (INDEX i = 0; i < text.size(); i++)
-			{
-				if (sa[i] == 0)
-				{
-					bwt[i] = text[n - 1];
-				}
-				else
-				{
-					bwt[i] = text[sa[i] - 1];
-				}
-			}
+			uint64_t n = text.size();
+			stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t, uint64_t begin, uint64_t end)
+														  {
+															  for (uint64_t i = begin; i < end; i++)
+															  {
+																  uint64_t p = sa[i];
+																  bwt[i] = p == 0 ? text[n - 1] : text[p - 1];
+															  } });
 
 			st2 = std::chrono::system_clock::now();
 
@@ -0,0 +1,115 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "../basic/byte.hpp"
+#include "../basic/lsb_byte.hpp"
+
+namespace stool
+{
+    /**
+     * @brief A 2n-bit representation of the permuted LCP array (PLCP) of a text \p T[0..n-1]
+     *
+     * PLCP[i] is the length of the longest common prefix between T[i..n-1] and its predecessor in the suffix order.
+     * Since PLCP[i+1] >= PLCP[i] - 1, the values PLCP[i] + 2i are strictly increasing and at most 2n.
+     * This class stores them as the positions of 1s in a bit vector B[0..2n], and PLCP[i] is computed as select1(B, i) - 2i.
+     * The position of every SAMPLING_INTERVAL-th 1 is sampled, so accessing all the values costs O(n) time in total.
+     * \ingroup StringClasses
+     */
+    class CompressedPLCPArray
+    {
+        std::vector<uint64_t> bits;
+        std::vector<uint64_t> select_samples;
+        uint64_t n = 0;
+
+    public:
+        /** @brief The interval of the sampled 1s */
+        static inline constexpr uint64_t SAMPLING_INTERVAL = 64;
+
+        CompressedPLCPArray()
+        {
+        }
+
+        /**
+         * @brief Builds this data structure from the PLCP array \p plcp
+         * @tparam VEC A random access container of integers (e.g., std::vector<uint64_t>)
+         */
+        template <typename VEC>
+        void build(const VEC &plcp)
+        {
+            this->n = plcp.size();
+            uint64_t bit_size = (2 * this->n) + 1;
+            this->bits.clear();
+            this->bits.resize((bit_size + 63) / 64, 0);
+            this->select_samples.clear();
+            this->select_samples.reserve((this->n / SAMPLING_INTERVAL) + 1);
+
+            for (uint64_t i = 0; i < this->n; i++)
+            {
+                uint64_t pos = (uint64_t)plcp[i] + (2 * i);
+                assert(pos < bit_size);
+                this->bits[pos / 64] |= (1ULL << (pos % 64));
+                if (i % SAMPLING_INTERVAL == 0)
+                {
+                    this->select_samples.push_back(pos);
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the length n of the text
+         */
+        uint64_t size() const
+        {
+            return this->n;
+        }
+
+        /**
+         * @brief Returns PLCP[i]
+         */
+        uint64_t access(uint64_t i) const
+        {
+            assert(i < this->n);
+            uint64_t pos = this->select_samples[i / SAMPLING_INTERVAL];
+            uint64_t rest = i % SAMPLING_INTERVAL;
+            uint64_t word_index = pos / 64;
+            uint64_t word = this->bits[word_index] & (UINT64_MAX << (pos % 64));
+            while (true)
+            {
+                uint64_t count = stool::Byte::popcount(word);
+                if (rest < count)
+                {
+                    uint64_t select_pos = (word_index * 64) + stool::LSBByte::select1(word, rest);
+                    return select_pos - (2 * i);
+                }
+                rest -= count;
+                word_index++;
+                word = this->bits[word_index];
+            }
+        }
+
+        /**
+         * @brief Prefetches the sampled position used by access(i)
+         */
+        void prefetch(uint64_t i) const
+        {
+            __builtin_prefetch(&this->select_samples[i / SAMPLING_INTERVAL]);
+        }
+
+        /**
+         * @brief Returns PLCP[i]
+         */
+        uint64_t operator[](uint64_t i) const
+        {
+            return this->access(i);
+        }
+
+        /**
+         * @brief Returns the size of this data structure in bytes
+         */
+        uint64_t size_in_bytes() const
+        {
+            return sizeof(CompressedPLCPArray) + (this->bits.capacity() * sizeof(uint64_t)) + (this->select_samples.capacity() * sizeof(uint64_t));
+        }
+    };
+}
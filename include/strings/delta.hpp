@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <set>
 #include "../basic/rational.hpp"
+#include "./array_constructor.hpp"
 
 namespace stool
 {
@@ -24,78 +25,22 @@ namespace stool
         * @brief Constructs a distinct substring counter array (DSCA) from a text and its suffix array 
         * 
         * This function constructs a DSCA from a text and its suffix array.
-        * Here, DSCA[i] contains the number of distinct substrings of length i, and its length is the same as the text.
+        * Here, DSCA[i] contains the number of distinct substrings of length i.
+        * The LCP values are counted by ArrayConstructor::compute_LCP_statistics without constructing the LCP array.
         * 
 		 * @tparam TEXT The type of the text (e.g., std::vector<uint8_t>, std::vector<char>, std::string)
         * @tparam INDEX The index type for positions (defaults to uint64_t)
         * @param text The input text T
         * @param sa The SA of T
+        * @param message_paragraph The paragraph depth of message logs (-1 for no output)
+        * @param thread_count The number of threads
         * @return The DSCA of T
         */
         template <typename TEXT = std::vector<uint8_t>, typename INDEX = uint64_t>
-        static std::vector<uint64_t> construct_distinct_substring_counter_array(const TEXT &text, const std::vector<INDEX> &sa)
+        static std::vector<uint64_t> construct_distinct_substring_counter_array(const TEXT &text, const std::vector<INDEX> &sa, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
         {
-            std::vector<uint64_t> DSCA;
-            DSCA.resize(text.size() + 1, 0);
-            std::cout << "Computing delta: "
-                      << "0/" << text.size() << std::flush;
-            for (uint64_t i = 0; i < text.size(); i++)
-            {
-                bool b = true;
-                if (i % 100 == 0)
-                {
-                    std::cout << "\r"
-                              << "Computing delta: " << i << "/" << text.size() << std::flush;
-                }
-
-                uint64_t max = text.size() - sa[i];
-                // std::cout << std::endl;
-                for (uint64_t j = 0; j < max; j++)
-                {
-                    if (i == 0)
-                    {
-                        b = false;
-                    }
-                    else if (b)
-                    {
-                        uint64_t prevpos = sa[i - 1] + j;
-                        if (prevpos < text.size())
-                        {
-                            auto c1 = text[sa[i - 1] + j];
-                            auto c2 = text[sa[i] + j];
-                            if (c1 != c2)
-                            {
-                                b = false;
-                            }
-                        }
-                        else
-                        {
-                            b = false;
-                        }
-                    }
-                    if (!b)
-                    {
-
-                        DSCA[j + 1]++;
-                    }
-                }
-            }
-            std::cout << "[End]" << std::endl;
-            uint64_t k = 1;
-            while (true)
-            {
-                uint64_t suf_count = text.size() - k + 1;
-                if (DSCA[k] == suf_count)
-                {
-                    break;
-                }
-                else
-                {
-                    k++;
-                }
-            }
-            DSCA.resize(k + 1);
-            return DSCA;
+            std::vector<uint64_t> lcp_statistics = stool::ArrayConstructor::compute_LCP_statistics<TEXT, INDEX>(text, sa, message_paragraph, thread_count);
+            return construct_distinct_substring_counter_array_from_lcp_statistics(lcp_statistics, text.size());
         }
 
         /*! 
@@ -0,0 +1,418 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include "../basic/parallel_functions.hpp"
+#include "../debug/message.hpp"
+#include "../io/online_file_reader.hpp"
+
+namespace stool
+{
+    /*!
+     * @brief Estimates the substring complexity delta of a text without its suffix array
+     *
+     * For each length k in a given set, the number d_k of the distinct substrings of length k is estimated by a KMV (k minimum values) sketch
+     * of the Karp-Rabin fingerprints of all the windows of length k. The fingerprint of T[e-k..e-1] is computed as H(e) - H(e-k) * B^k
+     * from the fingerprints H of the prefixes, so a single pass over the text serves all the lengths, and the text is read in a streaming manner.
+     * The sketches of disjoint ranges are merged, so the text can be processed by multiple threads.
+     *
+     * If a sketch has never dropped a value (at most 2K - 1 distinct values for its capacity K), d_k is counted exactly (up to collisions of the fingerprints).
+     * Otherwise d_k is estimated as (K-1)/U, where U is the K-th smallest normalized hash value, and its relative standard error is about 1/sqrt(K-2).
+     * The estimate of delta is the maximum of the estimates of d_k/k for the given lengths, so it is a lower bound of delta if the lengths do not contain the maximizer.
+     * \ingroup StringClasses
+     */
+    class DeltaEstimator
+    {
+    public:
+        /** @brief The default number of the hash values kept by each sketch */
+        static inline constexpr uint64_t DEFAULT_SKETCH_SIZE = 4096;
+
+        /** @brief The modulus of the Karp-Rabin fingerprints (2^61 - 1) */
+        static inline constexpr uint64_t PRIME = (1ULL << 61) - 1;
+
+        /** @brief The bounds of an estimate are the estimate -/+ this number of standard errors */
+        static inline constexpr double ERROR_BOUND_FACTOR = 2.0;
+
+        /**
+         * @brief The estimate of the number of the distinct substrings of a length
+         */
+        struct Estimate
+        {
+            uint64_t length;
+            double count;
+            double lower_bound;
+            double upper_bound;
+            bool is_exact;
+        };
+
+        /**
+         * @brief The estimate of delta and the length k at which max d_k/k is attained
+         */
+        struct DeltaEstimate
+        {
+            double delta;
+            double lower_bound;
+            double upper_bound;
+            uint64_t length;
+        };
+
+    private:
+        /**
+         * @brief A KMV sketch that keeps the distinct hash values smaller than a threshold, which include the \p capacity smallest ones
+         *
+         * The values are stored in an open addressing hash table. When 2 * \p capacity values are stored,
+         * the threshold is lowered to the (\p capacity + 1)-th smallest value and the larger values are removed.
+         */
+        struct KMVSketch
+        {
+            static inline constexpr uint64_t EMPTY = UINT64_MAX;
+
+            uint64_t capacity = 0;
+            uint64_t threshold = UINT64_MAX;
+            uint64_t count = 0;
+            std::vector<uint64_t> table;
+
+            void initialize(uint64_t _capacity)
+            {
+                this->capacity = _capacity;
+                uint64_t table_size = 1;
+                while (table_size < 4 * _capacity)
+                {
+                    table_size *= 2;
+                }
+                this->table.resize(table_size, EMPTY);
+            }
+            void insert(uint64_t value)
+            {
+                if (value >= this->threshold)
+                {
+                    return;
+                }
+                // The stored values are smaller than the threshold, so their lower bits are used as the hash.
+                uint64_t mask = this->table.size() - 1;
+                uint64_t i = value & mask;
+                while (this->table[i] != EMPTY)
+                {
+                    if (this->table[i] == value)
+                    {
+                        return;
+                    }
+                    i = (i + 1) & mask;
+                }
+                this->table[i] = value;
+                this->count++;
+                if (this->count == 2 * this->capacity)
+                {
+                    std::vector<uint64_t> values = this->get_values();
+                    std::nth_element(values.begin(), values.begin() + this->capacity, values.end());
+                    this->threshold = values[this->capacity];
+                    std::fill(this->table.begin(), this->table.end(), EMPTY);
+                    this->count = 0;
+                    for (uint64_t x = 0; x < this->capacity; x++)
+                    {
+                        this->insert(values[x]);
+                    }
+                }
+            }
+            std::vector<uint64_t> get_values() const
+            {
+                std::vector<uint64_t> r;
+                r.reserve(this->count);
+                for (uint64_t value : this->table)
+                {
+                    if (value != EMPTY)
+                    {
+                        r.push_back(value);
+                    }
+                }
+                return r;
+            }
+        };
+
+        std::vector<uint64_t> lengths;
+        uint64_t max_length = 0;
+        uint64_t sketch_size;
+        uint64_t base;
+        std::vector<uint64_t> base_powers;
+
+        // sketches[t][x] is the sketch of the x-th length built by the t-th thread.
+        std::vector<std::vector<KMVSketch>> sketches;
+        uint64_t text_size = 0;
+
+        static uint64_t mul_mod(uint64_t x, uint64_t y)
+        {
+            __uint128_t z = (__uint128_t)x * y;
+            uint64_t r = (uint64_t)(z & PRIME) + (uint64_t)(z >> 61);
+            return r >= PRIME ? r - PRIME : r;
+        }
+        static uint64_t mix(uint64_t x)
+        {
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return x;
+        }
+
+        /**
+         * @brief Adds the windows T[e-k..e-1] with \p lo < e <= \p hi and e - k >= 0 to \p local_sketches, where T[i] = \p text[i]
+         */
+        template <typename TEXT>
+        void process(const TEXT &text, uint64_t lo, uint64_t hi, std::vector<KMVSketch> &local_sketches) const
+        {
+            uint64_t m = this->max_length;
+            uint64_t ring_size = 1;
+            while (ring_size <= m)
+            {
+                ring_size *= 2;
+            }
+            uint64_t mask = ring_size - 1;
+            std::vector<uint64_t> prefix_hashes(ring_size, 0);
+
+            // The fingerprint of a window does not depend on the starting position of the prefixes.
+            uint64_t start = lo + 1 > m ? lo + 1 - m : 0;
+            uint64_t h = 0;
+            prefix_hashes[start & mask] = 0;
+            for (uint64_t e = start + 1; e <= hi; e++)
+            {
+                h = mul_mod(h, this->base) + (uint8_t)text[e - 1] + 1;
+                h = h >= PRIME ? h - PRIME : h;
+                prefix_hashes[e & mask] = h;
+                if (e <= lo)
+                {
+                    continue;
+                }
+                for (uint64_t x = 0; x < this->lengths.size(); x++)
+                {
+                    uint64_t k = this->lengths[x];
+                    if (e < start + k)
+                    {
+                        break;
+                    }
+                    uint64_t y = mul_mod(prefix_hashes[(e - k) & mask], this->base_powers[x]);
+                    uint64_t fingerprint = h >= y ? h - y : h + PRIME - y;
+                    local_sketches[x].insert(mix(fingerprint));
+                }
+            }
+        }
+
+        /**
+         * @brief Adds the windows ending in (\p lo, \p hi] by \p thread_count threads
+         */
+        template <typename TEXT>
+        void process_parallel(const TEXT &text, uint64_t lo, uint64_t hi, uint64_t thread_count)
+        {
+            stool::ParallelFunctions::parallel_for_ranges(hi - lo, thread_count, [&](uint64_t t, uint64_t begin, uint64_t end)
+                                                          { this->process(text, lo + begin, lo + end, this->sketches[t]); });
+        }
+
+    public:
+        /**
+         * @brief Constructs an estimator for the given lengths (sorted and deduplicated; 0 is ignored)
+         * @param _seed The seed of the base of the fingerprints
+         */
+        DeltaEstimator(const std::vector<uint64_t> &_lengths, uint64_t _sketch_size = DEFAULT_SKETCH_SIZE, uint64_t thread_count = 1, uint64_t _seed = 0)
+        {
+            for (uint64_t k : _lengths)
+            {
+                if (k > 0)
+                {
+                    this->lengths.push_back(k);
+                }
+            }
+            std::sort(this->lengths.begin(), this->lengths.end());
+            this->lengths.erase(std::unique(this->lengths.begin(), this->lengths.end()), this->lengths.end());
+            if (this->lengths.size() == 0)
+            {
+                throw std::runtime_error("DeltaEstimator: no length is given");
+            }
+            if (_sketch_size < 3)
+            {
+                throw std::runtime_error("DeltaEstimator: the sketch size must be at least 3");
+            }
+            this->max_length = this->lengths.back();
+            this->sketch_size = _sketch_size;
+            this->base = 256 + mix(_seed + 0x9e3779b97f4a7c15ULL) % (PRIME - 512);
+            for (uint64_t k : this->lengths)
+            {
+                uint64_t p = 1;
+                uint64_t b = this->base;
+                for (uint64_t e = k; e > 0; e >>= 1)
+                {
+                    if (e & 1)
+                    {
+                        p = mul_mod(p, b);
+                    }
+                    b = mul_mod(b, b);
+                }
+                this->base_powers.push_back(p);
+            }
+            this->sketches.resize(std::max(thread_count, (uint64_t)1));
+            for (std::vector<KMVSketch> &local_sketches : this->sketches)
+            {
+                local_sketches.resize(this->lengths.size());
+                for (KMVSketch &sketch : local_sketches)
+                {
+                    sketch.initialize(this->sketch_size);
+                }
+            }
+        }
+
+        /**
+         * @brief Returns the default lengths: 1, 2, ..., 16 and the powers of two up to \p max_length
+         */
+        static std::vector<uint64_t> get_default_lengths(uint64_t max_length = 1024)
+        {
+            std::vector<uint64_t> r;
+            for (uint64_t k = 1; k <= std::min(max_length, (uint64_t)16); k++)
+            {
+                r.push_back(k);
+            }
+            for (uint64_t k = 32; k <= max_length; k *= 2)
+            {
+                r.push_back(k);
+            }
+            return r;
+        }
+
+        /**
+         * @brief Adds the substrings of the byte string \p text (this function or add_file is called once)
+         */
+        template <typename TEXT>
+        void add_text(const TEXT &text)
+        {
+            this->text_size = text.size();
+            this->process_parallel(text, 0, text.size(), this->sketches.size());
+        }
+
+        /**
+         * @brief Adds the substrings of the text stored in the file \p filepath, which is read once in a streaming manner (this function or add_text is called once)
+         *
+         * The last max_length - 1 characters of each chunk are kept, so that the windows crossing the chunks are added.
+         */
+        void add_file(std::string filepath)
+        {
+            stool::OnlineFileReader ofr(filepath, stool::OnlineFileReader::PREFETCH_BUFFER_SIZE, true);
+            ofr.open();
+            std::vector<uint8_t> chunk;
+            std::vector<uint8_t> buffer;
+            uint64_t position = 0;
+            while (ofr.read_next_chunk(chunk))
+            {
+                uint64_t carry_size = buffer.size();
+                buffer.insert(buffer.end(), chunk.begin(), chunk.end());
+                this->process_parallel(buffer, carry_size, buffer.size(), this->sketches.size());
+                position += chunk.size();
+
+                uint64_t keep_size = std::min((uint64_t)buffer.size(), this->max_length - 1);
+                buffer.erase(buffer.begin(), buffer.end() - keep_size);
+            }
+            ofr.close();
+            this->text_size = position;
+        }
+
+        /**
+         * @brief Returns the estimates of the numbers of the distinct substrings of the lengths
+         */
+        std::vector<Estimate> get_estimates() const
+        {
+            std::vector<Estimate> r;
+            double sigma = 1.0 / std::sqrt((double)(this->sketch_size - 2));
+            for (uint64_t x = 0; x < this->lengths.size(); x++)
+            {
+                // Every sketch keeps all of its values smaller than the smallest threshold, so they are the values of the union smaller than it.
+                uint64_t threshold = UINT64_MAX;
+                for (const std::vector<KMVSketch> &local_sketches : this->sketches)
+                {
+                    threshold = std::min(threshold, local_sketches[x].threshold);
+                }
+                std::vector<uint64_t> values;
+                for (const std::vector<KMVSketch> &local_sketches : this->sketches)
+                {
+                    for (uint64_t value : local_sketches[x].get_values())
+                    {
+                        if (value < threshold)
+                        {
+                            values.push_back(value);
+                        }
+                    }
+                }
+                std::sort(values.begin(), values.end());
+                values.erase(std::unique(values.begin(), values.end()), values.end());
+
+                uint64_t k = this->lengths[x];
+                double window_count = this->text_size >= k ? (double)(this->text_size - k + 1) : 0;
+                Estimate e;
+                e.length = k;
+                // All the distinct values are kept if no threshold has been lowered.
+                e.is_exact = threshold == UINT64_MAX;
+                if (e.is_exact)
+                {
+                    e.count = values.size();
+                    e.lower_bound = e.count;
+                    e.upper_bound = e.count;
+                }
+                else
+                {
+                    double u = ((double)values[this->sketch_size - 1] + 1.0) / 18446744073709551616.0;
+                    e.count = std::min((double)(this->sketch_size - 1) / u, window_count);
+                    e.lower_bound = std::max(e.count * (1.0 - ERROR_BOUND_FACTOR * sigma), (double)this->sketch_size);
+                    e.upper_bound = std::min(e.count * (1.0 + ERROR_BOUND_FACTOR * sigma), window_count);
+                }
+                r.push_back(e);
+            }
+            return r;
+        }
+
+        /**
+         * @brief Returns the estimate of delta from \p estimates
+         */
+        static DeltaEstimate compute_delta(const std::vector<Estimate> &estimates)
+        {
+            DeltaEstimate r{0, 0, 0, 0};
+            for (const Estimate &e : estimates)
+            {
+                double k = (double)e.length;
+                if (e.count / k > r.delta)
+                {
+                    r.delta = e.count / k;
+                    r.length = e.length;
+                }
+                r.lower_bound = std::max(r.lower_bound, e.lower_bound / k);
+                r.upper_bound = std::max(r.upper_bound, e.upper_bound / k);
+            }
+            return r;
+        }
+
+        /**
+         * @brief Estimates delta of the text stored in the file \p filepath for the lengths \p lengths
+         */
+        static DeltaEstimate estimate_delta_from_file(std::string filepath, const std::vector<uint64_t> &lengths, uint64_t sketch_size = DEFAULT_SKETCH_SIZE, uint64_t thread_count = 1, int message_paragraph = stool::Message::SHOW_MESSAGE)
+        {
+            if (message_paragraph >= 0)
+            {
+                std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Estimating delta... " << std::flush;
+            }
+            std::chrono::system_clock::time_point st1, st2;
+            st1 = std::chrono::system_clock::now();
+
+            DeltaEstimator estimator(lengths, sketch_size, thread_count);
+            estimator.add_file(filepath);
+            DeltaEstimate r = compute_delta(estimator.get_estimates());
+
+            st2 = std::chrono::system_clock::now();
+            if (message_paragraph >= 0)
+            {
+                uint64_t ms_time = std::chrono::duration_cast<std::chrono::milliseconds>(st2 - st1).count();
+                std::cout << "[END] Elapsed Time: " << ms_time << " ms" << std::endl;
+            }
+            return r;
+        }
+    };
+}
@@ -0,0 +1,334 @@
+#pragma once
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <type_traits>
+#include <unistd.h>
+#include "../debug/message.hpp"
+#include "../io/external_sorter.hpp"
+#include "../io/streaming_file_writer.hpp"
+
+namespace stool
+{
+    namespace external_sa_detail
+    {
+        /**
+         * @brief A sequential reader of a binary file storing values of type \p T
+         */
+        template <typename T>
+        class BufferedSequentialReader
+        {
+            std::ifstream stream;
+            std::vector<T> buffer;
+            uint64_t position = 0;
+            uint64_t capacity;
+
+            void fill()
+            {
+                this->buffer.resize(this->capacity);
+                this->stream.read(reinterpret_cast<char *>(&this->buffer[0]), this->capacity * sizeof(T));
+                this->buffer.resize(this->stream.gcount() / sizeof(T));
+                this->position = 0;
+            }
+
+        public:
+            /**
+             * @brief Opens \p path and skips the first \p offset values
+             */
+            BufferedSequentialReader(const std::string &path, uint64_t _capacity, uint64_t offset = 0) : capacity(std::max(_capacity, (uint64_t)1))
+            {
+                this->stream.open(path, std::ios::binary);
+                if (!this->stream)
+                {
+                    throw std::runtime_error("Failed to open file for reading: " + path);
+                }
+                this->stream.seekg(offset * sizeof(T), std::ios::beg);
+                this->fill();
+            }
+
+            /**
+             * @brief Returns true if all the values have been read
+             */
+            bool empty() const
+            {
+                return this->position >= this->buffer.size();
+            }
+
+            /**
+             * @brief Returns the next value and advances the reader
+             */
+            T next()
+            {
+                T v = this->buffer[this->position++];
+                if (this->position == this->buffer.size())
+                {
+                    this->fill();
+                }
+                return v;
+            }
+        };
+
+        /**
+         * @brief Removes the temporary file \p path when it goes out of scope, also when an exception is thrown
+         */
+        struct TemporaryFileGuard
+        {
+            std::string path;
+
+            TemporaryFileGuard(const std::string &_path) : path(_path)
+            {
+            }
+            ~TemporaryFileGuard()
+            {
+                std::remove(this->path.c_str());
+            }
+            TemporaryFileGuard(const TemporaryFileGuard &) = delete;
+            TemporaryFileGuard &operator=(const TemporaryFileGuard &) = delete;
+        };
+
+        /**
+         * @brief A suffix of the text represented by a pair of ranks, i.e., (rank of T[i..i+h-1], rank of T[i+h..i+2h-1])
+         */
+        struct RankPair
+        {
+            uint64_t first;
+            uint64_t second;
+            uint64_t index;
+        };
+
+        struct RankPairComparator
+        {
+            bool operator()(const RankPair &x, const RankPair &y) const
+            {
+                if (x.first != y.first)
+                {
+                    return x.first < y.first;
+                }
+                else
+                {
+                    return x.second < y.second;
+                }
+            }
+        };
+
+        /**
+         * @brief A position of the text with its new rank
+         */
+        struct IndexRank
+        {
+            uint64_t index;
+            uint64_t rank;
+        };
+
+        struct IndexComparator
+        {
+            bool operator()(const IndexRank &x, const IndexRank &y) const
+            {
+                return x.index < y.index;
+            }
+        };
+    }
+
+    /**
+     * @brief A class for constructing the suffix array of a text stored in a file whose suffix array does not fit in memory
+     *
+     * The suffix array is computed by prefix doubling on disk. After the k-th round, every suffix T[i..n-1] has the rank of
+     * its prefix of length h = 2^k * (8 / sizeof(CHAR)), and the ranks are stored in a temporary file in text order.
+     * Each round creates the pairs (rank of T[i..i+h-1], rank of T[i+h..i+2h-1]) by reading the rank file twice,
+     * sorts them with ExternalSorter, and sorts the new ranks back into text order.
+     * The memory usage is bounded by the given limit, and the text, the rank file, and the output are accessed sequentially.
+     * The number of rounds is O(log L), where L is the length of the longest repeated substring of the text.
+     *
+     * The suffixes are compared as in sais_suffix_array, i.e., every character is compared as an unsigned integer of the same width.
+     * \ingroup StringClasses
+     */
+    class ExternalSuffixArrayConstructor
+    {
+        static constexpr uint64_t IO_BUFFER_SIZE = 1ULL << 16;
+        static constexpr uint64_t MIN_IO_BUFFER_SIZE = 256;
+
+        /**
+         * @brief The memory assigned to the parts of a round
+         *
+         * At most two sorters (the pair sorter and the index sorter) and two I/O buffers (the two readers of the rank file,
+         * or a writer and the buffer it flushes in the background) are alive at the same time, so their sizes add up to the memory limit.
+         */
+        struct MemoryBudget
+        {
+            uint64_t io_buffer_size;
+            uint64_t sorter_bytes;
+
+            MemoryBudget(uint64_t memory_limit_bytes)
+            {
+                this->io_buffer_size = std::max(std::min(memory_limit_bytes / (16 * sizeof(uint64_t)), IO_BUFFER_SIZE), MIN_IO_BUFFER_SIZE);
+                uint64_t io_bytes = 2 * this->io_buffer_size * sizeof(uint64_t);
+                this->sorter_bytes = memory_limit_bytes > io_bytes ? (memory_limit_bytes - io_bytes) / 2 : 0;
+            }
+        };
+
+        template <typename CHAR>
+        static uint64_t to_unsigned(CHAR c)
+        {
+            using UCHAR = typename std::make_unsigned<CHAR>::type;
+            return (uint64_t)((UCHAR)c);
+        }
+
+        /**
+         * @brief Returns the rank pairs representing the first 64 bits of every suffix
+         */
+        template <typename CHAR, typename SORTER>
+        static uint64_t push_initial_pairs(const std::string &input_path, SORTER &sorter, const MemoryBudget &budget)
+        {
+            constexpr uint64_t k = 8 / sizeof(CHAR);
+            constexpr uint64_t bits = sizeof(CHAR) * 8;
+
+            external_sa_detail::BufferedSequentialReader<CHAR> reader(input_path, budget.io_buffer_size * sizeof(uint64_t) / sizeof(CHAR));
+            std::vector<uint64_t> window(k, 0);
+            uint64_t n = 0;
+
+            auto push_pair = [&](uint64_t i, uint64_t len)
+            {
+                uint64_t packed = 0;
+                for (uint64_t t = 0; t < k; t++)
+                {
+                    uint64_t c = t < len ? window[(i + t) % k] : 0;
+                    if constexpr (bits == 64)
+                    {
+                        packed = c;
+                    }
+                    else
+                    {
+                        packed = (packed << bits) | c;
+                    }
+                }
+                // Two prefixes of length at most k are identical iff their packed values and their lengths are identical.
+                sorter.push(external_sa_detail::RankPair{packed, len, i});
+            };
+
+            while (!reader.empty())
+            {
+                window[n % k] = to_unsigned<CHAR>(reader.next());
+                n++;
+                if (n >= k)
+                {
+                    push_pair(n - k, k);
+                }
+            }
+            uint64_t p = n >= k ? n - k + 1 : 0;
+            for (; p < n; p++)
+            {
+                push_pair(p, n - p);
+            }
+            return n;
+        }
+
+        /**
+         * @brief Assigns the new ranks to the sorted pairs, writes the suffixes in the sorted order to \p output_path, and writes the new ranks in text order to \p rank_path
+         * @return The number of distinct ranks
+         */
+        template <typename SORTER>
+        static uint64_t update_ranks(SORTER &pair_sorter, const std::string &output_path, const std::string &rank_path, const std::string &tmp_dir, const MemoryBudget &budget)
+        {
+            using namespace external_sa_detail;
+            ExternalSorter<IndexRank, IndexComparator> index_sorter(tmp_dir, budget.sorter_bytes);
+            uint64_t distinct_count = 0;
+            {
+                StreamingFileWriter sa_writer(output_path, budget.io_buffer_size * sizeof(uint64_t), true);
+                uint64_t x = 0;
+                uint64_t current_rank = 0;
+                RankPair prev{0, 0, 0};
+                pair_sorter.sort_and_consume([&](const RankPair &p)
+                                             {
+                                                 // Rank 0 is reserved for the empty suffix.
+                                                 if (x == 0 || p.first != prev.first || p.second != prev.second)
+                                                 {
+                                                     current_rank = x + 1;
+                                                     distinct_count++;
+                                                 }
+                                                 sa_writer.push_back<uint64_t>(p.index);
+                                                 index_sorter.push(IndexRank{p.index, current_rank});
+                                                 prev = p;
+                                                 x++; });
+                sa_writer.close();
+            }
+
+            StreamingFileWriter rank_writer(rank_path, budget.io_buffer_size * sizeof(uint64_t), true);
+            index_sorter.sort_and_consume([&](const IndexRank &p)
+                                          { rank_writer.push_back<uint64_t>(p.rank); });
+            rank_writer.close();
+            return distinct_count;
+        }
+
+    public:
+        /**
+         * @brief Constructs the suffix array of the text stored in \p input_path and writes it to \p output_path in the std::vector<uint64_t> format
+         *
+         * @tparam CHAR The character type of the text
+         * @param memory_limit_bytes The memory budget for the construction in bytes (the sorters and the I/O buffers keep a small minimum size for very small budgets)
+         * @param tmp_dir The directory for the temporary files
+         * @param message_paragraph The paragraph depth of message logs (-1 for no output)
+         * @return The length of the text
+         */
+        template <typename CHAR = uint8_t>
+        static uint64_t construct(const std::string &input_path, const std::string &output_path, uint64_t memory_limit_bytes, const std::string &tmp_dir = ".", int message_paragraph = stool::Message::SHOW_MESSAGE)
+        {
+            using namespace external_sa_detail;
+            std::chrono::system_clock::time_point st1, st2;
+            st1 = std::chrono::system_clock::now();
+
+            if (message_paragraph >= 0)
+            {
+                std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Constructing Suffix Array on disk (memory limit: " << (memory_limit_bytes / (1024 * 1024)) << "MB, tmp dir: " << tmp_dir << ")" << std::endl;
+            }
+
+            std::string rank_path = tmp_dir + "/stool_external_sa_" + std::to_string(getpid()) + "_" + std::to_string(external_sorter_detail::get_next_file_id()) + "_rank.tmp";
+            TemporaryFileGuard rank_file_guard(rank_path);
+            MemoryBudget budget(memory_limit_bytes);
+            uint64_t n = 0;
+            uint64_t distinct_count = 0;
+            uint64_t h = 8 / sizeof(CHAR);
+            {
+                ExternalSorter<RankPair, RankPairComparator> pair_sorter(tmp_dir, budget.sorter_bytes);
+                n = push_initial_pairs<CHAR>(input_path, pair_sorter, budget);
+                distinct_count = update_ranks(pair_sorter, output_path, rank_path, tmp_dir, budget);
+            }
+            if (message_paragraph >= 0)
+            {
+                std::cout << stool::Message::get_paragraph_string(message_paragraph + 1) << "h = " << h << ", distinct ranks: " << distinct_count << "/" << n << std::endl;
+            }
+
+            while (distinct_count < n)
+            {
+                ExternalSorter<RankPair, RankPairComparator> pair_sorter(tmp_dir, budget.sorter_bytes);
+                {
+                    BufferedSequentialReader<uint64_t> first_reader(rank_path, budget.io_buffer_size);
+                    BufferedSequentialReader<uint64_t> second_reader(rank_path, budget.io_buffer_size, std::min(h, n));
+                    for (uint64_t i = 0; i < n; i++)
+                    {
+                        uint64_t r1 = first_reader.next();
+                        uint64_t r2 = i + h < n ? second_reader.next() : 0;
+                        pair_sorter.push(RankPair{r1, r2, i});
+                    }
+                }
+                distinct_count = update_ranks(pair_sorter, output_path, rank_path, tmp_dir, budget);
+                h *= 2;
+                if (message_paragraph >= 0)
+                {
+                    std::cout << stool::Message::get_paragraph_string(message_paragraph + 1) << "h = " << h << ", distinct ranks: " << distinct_count << "/" << n << std::endl;
+                }
+            }
+
+            st2 = std::chrono::system_clock::now();
+            if (message_paragraph >= 0)
+            {
+                uint64_t ms_count = std::chrono::duration_cast<std::chrono::milliseconds>(st2 - st1).count();
+                std::cout << stool::Message::get_paragraph_string(message_paragraph) << "[END] Elapsed Time: " << ms_count << " ms" << std::endl;
+            }
+            return n;
+        }
+    };
+}
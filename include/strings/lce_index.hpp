@@ -0,0 +1,172 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include "../debug/message.hpp"
+#include "../rmq/rmq_compact.hpp"
+#include "./sa_is.hpp"
+#include "./array_constructor.hpp"
+
+namespace stool
+{
+    /**
+     * @brief An index that answers the longest common extension (LCE) queries on a text in O(1) time
+     *
+     * lce(i, j) is the length of the longest common prefix of T[i..n-1] and T[j..n-1], which is the minimum of LCP[ISA[i]+1..ISA[j]] (ISA[i] < ISA[j]).
+     * The index consists of the text, ISA, the LCP array, and RMQCompact on the LCP array.
+     *
+     * Most of the LCE values are short in practice, and then the random accesses to ISA, the LCP array, and the RMQ index cost more than the comparison of the characters.
+     * Hence lce(i, j) first compares the first HYBRID_PREFIX_LENGTH characters 8 bytes at a time, and uses the RMQ only if they match.
+     * lce_by_rmq(i, j) always uses the RMQ.
+     * \ingroup StringClasses
+     */
+    template <typename INDEX = uint64_t>
+    class LCEIndex
+    {
+    public:
+        /** @brief The number of the characters compared directly by lce before the RMQ is used */
+        static inline constexpr uint64_t HYBRID_PREFIX_LENGTH = 64;
+
+    private:
+        std::vector<uint8_t> text;
+        std::vector<INDEX> isa;
+        std::vector<INDEX> lcp_array;
+        stool::RMQCompact<INDEX> rmq;
+
+        /**
+         * @brief Returns the length of the longest common prefix of T[i..i+max-1] and T[j..j+max-1], where \p max <= HYBRID_PREFIX_LENGTH
+         */
+        uint64_t compare_prefixes(uint64_t i, uint64_t j, uint64_t max) const
+        {
+            const uint8_t *x = this->text.data() + i;
+            const uint8_t *y = this->text.data() + j;
+            uint64_t k = 0;
+            for (; k + 8 <= max; k += 8)
+            {
+                uint64_t a, b;
+                std::memcpy(&a, x + k, 8);
+                std::memcpy(&b, y + k, 8);
+                if (a != b)
+                {
+                    // The first different byte is the lowest one on a little-endian machine.
+                    return k + (__builtin_ctzll(a ^ b) / 8);
+                }
+            }
+            for (; k < max; k++)
+            {
+                if (x[k] != y[k])
+                {
+                    return k;
+                }
+            }
+            return max;
+        }
+
+    public:
+        LCEIndex()
+        {
+        }
+
+        /**
+         * @brief Builds the index of the text \p _text (the suffix array and the LCP array are constructed by \p thread_count threads)
+         */
+        void build(const std::vector<uint8_t> &_text, int message_paragraph = stool::Message::SHOW_MESSAGE, uint64_t thread_count = 1)
+        {
+            if (message_paragraph >= 0)
+            {
+                std::cout << stool::Message::get_paragraph_string(message_paragraph) << "Constructing LCEIndex..." << std::endl;
+            }
+            std::chrono::system_clock::time_point st1, st2;
+            st1 = std::chrono::system_clock::now();
+
+            this->text = _text;
+            this->isa.clear();
+            this->lcp_array.clear();
+            this->rmq.clear();
+            if (this->text.size() > 0)
+            {
+                int child_paragraph = stool::Message::increment_paragraph_level(message_paragraph);
+                std::vector<INDEX> sa = stool::parallel_sais_suffix_array<uint8_t, INDEX>(this->text, thread_count);
+                this->isa = stool::ArrayConstructor::construct_ISA<INDEX>(sa, child_paragraph, thread_count);
+                this->lcp_array = stool::ArrayConstructor::construct_LCP_array<std::vector<uint8_t>, INDEX>(this->text, sa, this->isa, child_paragraph, thread_count);
+                std::vector<INDEX>().swap(sa);
+                this->rmq.build(this->lcp_array, child_paragraph, thread_count);
+            }
+
+            st2 = std::chrono::system_clock::now();
+            if (message_paragraph >= 0)
+            {
+                uint64_t ms_time = std::chrono::duration_cast<std::chrono::milliseconds>(st2 - st1).count();
+                std::cout << stool::Message::get_paragraph_string(message_paragraph) << "[END] Elapsed Time: " << ms_time << " ms" << std::endl;
+            }
+        }
+
+        /**
+         * @brief Returns the length of the text
+         */
+        uint64_t size() const
+        {
+            return this->text.size();
+        }
+
+        /**
+         * @brief Returns lce(\p i, \p j) by the RMQ on the LCP array
+         */
+        uint64_t lce_by_rmq(uint64_t i, uint64_t j) const
+        {
+            uint64_t n = this->text.size();
+            if (i >= n || j >= n)
+            {
+                throw std::out_of_range("LCEIndex: the position is out of range");
+            }
+            if (i == j)
+            {
+                return n - i;
+            }
+            uint64_t x = this->isa[i];
+            uint64_t y = this->isa[j];
+            if (x > y)
+            {
+                std::swap(x, y);
+            }
+            return this->lcp_array[this->rmq.rmq_index(x + 1, y, this->lcp_array)];
+        }
+
+        /**
+         * @brief Returns the length of the longest common prefix of T[i..n-1] and T[j..n-1]
+         *
+         * The first HYBRID_PREFIX_LENGTH characters are compared directly, and lce_by_rmq is used only if they match.
+         */
+        uint64_t lce(uint64_t i, uint64_t j) const
+        {
+            uint64_t n = this->text.size();
+            if (i >= n || j >= n)
+            {
+                throw std::out_of_range("LCEIndex: the position is out of range");
+            }
+            if (i == j)
+            {
+                return n - i;
+            }
+            uint64_t max = std::min(n - std::max(i, j), HYBRID_PREFIX_LENGTH);
+            uint64_t k = this->compare_prefixes(i, j, max);
+            if (k < HYBRID_PREFIX_LENGTH)
+            {
+                return k;
+            }
+            return this->lce_by_rmq(i, j);
+        }
+
+        /**
+         * @brief Returns the size of this data structure in bytes
+         */
+        uint64_t get_using_memory() const
+        {
+            return this->text.size() + (this->isa.size() + this->lcp_array.size()) * sizeof(INDEX) + this->rmq.get_using_memory();
+        }
+    };
+}
@@ -0,0 +1,310 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+#include <limits>
+#include <type_traits>
+#include "./lcp_interval.hpp"
+
+namespace stool
+{
+    /**
+     * @brief A node of the LCP interval tree passed to the callbacks of LCPIntervalTreeTraversal
+     * \ingroup StringClasses
+     */
+    struct LCPIntervalTreeNode
+    {
+        /** @brief The first position of the interval in the suffix array */
+        uint64_t i;
+        /** @brief The last position of the interval in the suffix array */
+        uint64_t j;
+        /** @brief The length of the longest common prefix of the suffixes in the interval */
+        uint64_t lcp;
+        /** @brief The number of the ancestors of this node (0 for the root) */
+        uint64_t depth;
+        /** @brief The number of the children of this node, including the leaves (the single suffixes) */
+        uint64_t child_count;
+
+        /**
+         * @brief Returns the number of the occurrences of the string represented by this node
+         */
+        uint64_t get_frequency() const
+        {
+            return this->j - this->i + 1;
+        }
+
+        /**
+         * @brief Returns this node as an LCPInterval
+         */
+        stool::LCPInterval<uint64_t> get_interval() const
+        {
+            return stool::LCPInterval<uint64_t>(this->i, this->j, this->lcp);
+        }
+    };
+
+    /**
+     * @brief Top-down traversal of the LCP interval tree without materializing the LCP intervals
+     *
+     * The tree is traversed in depth-first order using the child table of Abouelhoda et al. (a single array of n integers
+     * computed from the LCP array in O(n) time), so the intervals are produced one by one in the order of
+     * LCPIntervalComparatorInPreorder. The visited intervals are the same as those of LCPInterval::compute_lcp_intervals.
+     *
+     * Subtrees can be pruned by a minimum frequency and a maximum LCP value (both are monotone along the tree, so a pruned node
+     * has no visited descendant), or by returning false from the on-enter callback.
+     *
+     * @tparam INDEX The integer type of the LCP array and the child table
+     * \ingroup StringClasses
+     */
+    template <typename INDEX = uint64_t>
+    class LCPIntervalTreeTraversal
+    {
+        static inline constexpr INDEX NONE = std::numeric_limits<INDEX>::max();
+
+        const std::vector<INDEX> *lcp_array = nullptr;
+
+        // The child table in the space-efficient layout of Abouelhoda et al.: up[k] (the first position of the minimum LCP value between
+        // the previous position with a smaller or equal LCP value and k) is stored in child_table[k-1] if LCP[k-1] > LCP[k].
+        // Otherwise child_table[k] stores next_l_index[k] (the next position with the same LCP value in the same interval) if it exists,
+        // and down[k] (the first position of the minimum LCP value between k and the next position with a smaller or equal LCP value) if not.
+        std::vector<INDEX> child_table;
+
+        struct Frame
+        {
+            uint64_t i;
+            uint64_t j;
+            uint64_t lcp;
+            uint64_t first_l_index;
+            uint64_t depth;
+            uint64_t child_count;
+            // The first position of the next child to visit.
+            uint64_t next_child_start;
+            bool single_child;
+        };
+
+        /**
+         * @brief Returns the LCP value at position k, where the positions 0 and n and the positions with the value NONE (no LCP value) have the value -1
+         */
+        int64_t get_lcp(uint64_t k) const
+        {
+            return (k == 0 || k == this->lcp_array->size() || (*this->lcp_array)[k] == NONE) ? -1 : (int64_t)(*this->lcp_array)[k];
+        }
+
+        uint64_t get_up(uint64_t k) const
+        {
+            return this->get_lcp(k - 1) > this->get_lcp(k) ? (uint64_t)this->child_table[k - 1] : NONE;
+        }
+        uint64_t get_down(uint64_t k) const
+        {
+            uint64_t v = this->get_lcp(k) <= this->get_lcp(k + 1) ? (uint64_t)this->child_table[k] : NONE;
+            return v != NONE && this->get_lcp(v) > this->get_lcp(k) ? v : NONE;
+        }
+        uint64_t get_next_l_index(uint64_t k) const
+        {
+            uint64_t v = this->get_lcp(k) <= this->get_lcp(k + 1) ? (uint64_t)this->child_table[k] : NONE;
+            return v != NONE && this->get_lcp(v) == this->get_lcp(k) ? v : NONE;
+        }
+
+        /**
+         * @brief Returns the last position of the child starting at \p a of the interval \p f
+         */
+        uint64_t get_child_end(const Frame &f, uint64_t a) const
+        {
+            uint64_t next = a == f.i ? f.first_l_index : this->get_next_l_index(a);
+            return next == NONE ? f.j : next - 1;
+        }
+
+        /**
+         * @brief Returns the first l-index of the child [a..b] (a < b) of an interval
+         */
+        uint64_t get_child_first_l_index(uint64_t a, uint64_t b) const
+        {
+            uint64_t up = this->get_up(b + 1);
+            return a < up && up <= b ? up : this->get_down(a);
+        }
+
+        Frame create_frame(uint64_t i, uint64_t j, uint64_t first_l_index, uint64_t depth, uint64_t lcp) const
+        {
+            Frame f;
+            f.i = i;
+            f.j = j;
+            f.lcp = lcp;
+            f.first_l_index = first_l_index;
+            f.depth = depth;
+            f.next_child_start = i;
+            f.single_child = i < j && (uint64_t)this->get_lcp(first_l_index) != lcp;
+            if (i == j)
+            {
+                f.child_count = 0;
+            }
+            else if (f.single_child)
+            {
+                f.child_count = 1;
+            }
+            else
+            {
+                f.child_count = 2;
+                for (uint64_t k = this->get_next_l_index(first_l_index); k != NONE; k = this->get_next_l_index(k))
+                {
+                    f.child_count++;
+                }
+            }
+            return f;
+        }
+
+        bool is_visited(const Frame &f, uint64_t min_frequency, uint64_t max_lcp) const
+        {
+            return f.j - f.i + 1 >= min_frequency && f.lcp <= max_lcp;
+        }
+
+        static LCPIntervalTreeNode to_node(const Frame &f)
+        {
+            return LCPIntervalTreeNode{f.i, f.j, f.lcp, f.depth, f.child_count};
+        }
+
+    public:
+        LCPIntervalTreeTraversal()
+        {
+        }
+
+        /**
+         * @brief Builds the child table of \p _lcp_array (LCP[k] is the LCP of the suffixes SA[k-1] and SA[k]; LCP[0] is ignored).
+         *
+         * \p _lcp_array must not be modified or destroyed while this object is used.
+         */
+        LCPIntervalTreeTraversal(const std::vector<INDEX> &_lcp_array)
+        {
+            this->build(_lcp_array);
+        }
+
+        /**
+         * @brief Builds the child table of \p _lcp_array
+         */
+        void build(const std::vector<INDEX> &_lcp_array)
+        {
+            this->lcp_array = &_lcp_array;
+            uint64_t n = _lcp_array.size();
+            this->child_table.assign(n, NONE);
+
+            // up values: the stack keeps the first position of each run of equal LCP values, so the last popped position is the first minimum.
+            std::vector<INDEX> stack;
+            stack.push_back(0);
+            for (uint64_t k = 1; k <= n; k++)
+            {
+                int64_t v = this->get_lcp(k);
+                INDEX last = NONE;
+                while (stack.back() != 0 && this->get_lcp(stack.back()) > v)
+                {
+                    last = stack.back();
+                    stack.pop_back();
+                }
+                if (this->get_lcp(k - 1) > v)
+                {
+                    this->child_table[k - 1] = last;
+                }
+                if (stack.back() == 0 || this->get_lcp(stack.back()) != v)
+                {
+                    stack.push_back(k);
+                }
+            }
+
+            // next_l_index and down values, which share the entries k with LCP[k] <= LCP[k+1].
+            stack.clear();
+            stack.push_back(n);
+            for (uint64_t x = n; x > 0; x--)
+            {
+                uint64_t k = x - 1;
+                int64_t v = this->get_lcp(k);
+                INDEX first_min = NONE;
+                while (stack.back() != n && this->get_lcp(stack.back()) > v)
+                {
+                    // The popped positions have non-increasing LCP values, so the first one with the smallest value is kept.
+                    if (first_min == NONE || this->get_lcp(stack.back()) < this->get_lcp(first_min))
+                    {
+                        first_min = stack.back();
+                    }
+                    stack.pop_back();
+                }
+                if (v <= this->get_lcp(k + 1))
+                {
+                    this->child_table[k] = (stack.back() != n && this->get_lcp(stack.back()) == v) ? stack.back() : first_min;
+                }
+                stack.push_back(k);
+            }
+        }
+
+        /**
+         * @brief Visits the LCP intervals in depth-first order
+         *
+         * \p on_enter(node) is called when a node is entered and returns true to visit its children or false to skip them.
+         * \p on_leave(node) is called after the subtree of the node has been visited (also for a node whose children were skipped).
+         * The nodes with frequency less than \p min_frequency or LCP value greater than \p max_lcp are skipped together with their subtrees.
+         * The root (the interval [0..n-1] with the LCP value 0) is always entered if the array is not empty.
+         */
+        template <typename ENTER, typename LEAVE>
+        void traverse(ENTER on_enter, LEAVE on_leave, uint64_t min_frequency = 2, uint64_t max_lcp = UINT64_MAX) const
+        {
+            if (this->lcp_array == nullptr)
+            {
+                throw std::runtime_error("LCPIntervalTreeTraversal: build must be called before traverse");
+            }
+            uint64_t n = this->lcp_array->size();
+            if (n == 0)
+            {
+                return;
+            }
+
+            std::vector<Frame> stack;
+            stack.push_back(this->create_frame(0, n - 1, this->get_down(0), 0, 0));
+            if (!on_enter(to_node(stack.back())))
+            {
+                on_leave(to_node(stack.back()));
+                return;
+            }
+
+            while (stack.size() > 0)
+            {
+                Frame &f = stack.back();
+                if (f.next_child_start > f.j || f.i == f.j)
+                {
+                    LCPIntervalTreeNode node = to_node(f);
+                    stack.pop_back();
+                    on_leave(node);
+                    continue;
+                }
+
+                uint64_t a = f.next_child_start;
+                uint64_t b = f.single_child ? f.j : this->get_child_end(f, a);
+                f.next_child_start = b + 1;
+                if (a == b)
+                {
+                    continue;
+                }
+
+                uint64_t first = f.single_child ? f.first_l_index : this->get_child_first_l_index(a, b);
+                Frame child = this->create_frame(a, b, first, f.depth + 1, (uint64_t)this->get_lcp(first));
+                if (!this->is_visited(child, min_frequency, max_lcp))
+                {
+                    continue;
+                }
+                if (on_enter(to_node(child)))
+                {
+                    stack.push_back(child);
+                }
+                else
+                {
+                    on_leave(to_node(child));
+                }
+            }
+        }
+
+        /**
+         * @brief Visits the LCP intervals of \p lcp_array in depth-first order (see traverse)
+         */
+        template <typename ENTER, typename LEAVE>
+        static void traverse(const std::vector<INDEX> &lcp_array, ENTER on_enter, LEAVE on_leave, uint64_t min_frequency = 2, uint64_t max_lcp = UINT64_MAX)
+        {
+            LCPIntervalTreeTraversal<INDEX> traversal(lcp_array);
+            traversal.traverse(on_enter, on_leave, min_frequency, max_lcp);
+        }
+    };
+} // namespace stool
@@ -1,12 +1,18 @@
+#pragma once
 #include <vector>
 #include <cstdint>
 #include <algorithm>
 #include <type_traits>
 #include <limits>
+#include <stdexcept>
+#include <unordered_set>
+#include "../basic/parallel_functions.hpp"
+#include "../basic/uint40.hpp"
+#include "../io/mapped_vector.hpp"
 
 // SA-IS for std::vector<C>
-// - Input : std::vector<C> text
-// - Output: std::vector<uint64_t> suffix array
+// - Input : std::vector<C> text (or a stool::MappedVector<C> mapped from a file)
+// - Output: std::vector<INDEX> suffix array (INDEX = uint64_t by default)
 //
 // Notes:
 // * This implementation assumes that the alphabet symbols in `text` are
@@ -16,54 +22,361 @@
 //   than every other symbol.
 // * The result size is text.size(), i.e. the suffix array of suffixes
 //   text[0..], text[1..], ..., text[n-1..].
+// * INDEX is also the integer type of all the working arrays. uint32_t can be
+//   used if text.size() + 1 < 2^32 - 1, and stool::UInt40 (5 bytes per entry)
+//   if text.size() + 1 < 2^40 - 1.
+// * Texts of 1-byte characters are read in place; the other texts are
+//   copied into a coordinate-compressed std::vector<uint64_t>.
 //
 // Example:
 //   std::vector<char> s = {'b','a','n','a','n','a'};
 //   auto sa = sais_suffix_array(s);
+//   auto sa32 = sais_suffix_array<char, uint32_t>(s);
+//
+// Low-workspace construction (no type array, recursion inside the output):
+//   auto sa = sais_suffix_array(s, true);
+//
+// Multi-threaded construction:
+//   auto sa = parallel_sais_suffix_array(s, 8);
+// The L/S classification, bucket counting, LMS collection, LMS naming and the
+// random reads of the induced-sorting scans are distributed over the threads.
+// The writes of the induced-sorting scans stay sequential, so the output is
+// identical to the one of sais_suffix_array.
 
 namespace sais_detail {
 
 using index_type = uint64_t;
 
-template <class Int>
-static std::vector<index_type> build_sa_int(const std::vector<Int>& s, index_type upper) {
+// Texts shorter than this are always processed by a single thread.
+static constexpr index_type PARALLEL_MIN_LENGTH = 1ULL << 16;
+
+// The number of SA entries each thread prefetches per block of an induced-sorting scan.
+static constexpr index_type PARALLEL_INDUCE_BLOCK_SIZE_PER_THREAD = 1ULL << 18;
+
+// Threads writing to the same std::vector<bool> must touch disjoint words,
+// so every range boundary of a parallel write to `ls` is a multiple of this value.
+static constexpr index_type BIT_VECTOR_ALIGNMENT = 4096;
+
+static constexpr index_type SKIP = std::numeric_limits<index_type>::max() - 1;
+
+// The value marking an empty SA entry of type INDEX.
+template <class INDEX>
+static index_type get_empty_value() {
+    return static_cast<index_type>(std::numeric_limits<INDEX>::max());
+}
+
+// A text followed by the sentinel 0, without copying the text.
+// The i-th symbol is text[i] + 1 for i < n, where text[i] is read as an unsigned integer of the same width
+// (this keeps the order of static_cast<uint64_t>, also for negative values).
+template <class C>
+class TextWithSentinel {
+    using unsigned_char_type = typename std::conditional<sizeof(C) == 1, uint8_t,
+                               typename std::conditional<sizeof(C) == 2, uint16_t,
+                               typename std::conditional<sizeof(C) == 4, uint32_t, uint64_t>::type>::type>::type;
+    const C* text;
+    index_type n;
+
+public:
+    TextWithSentinel(const C* _text, index_type _n) : text(_text), n(_n) {}
+
+    index_type size() const {
+        return n + 1;
+    }
+
+    index_type operator[](index_type i) const {
+        return i < n ? static_cast<index_type>(static_cast<unsigned_char_type>(text[i])) + 1 : 0;
+    }
+
+    // Returns the largest symbol of this text.
+    index_type max_symbol() const {
+        index_type max = 0;
+        for (index_type i = 0; i < n; ++i) {
+            max = std::max(max, static_cast<index_type>(static_cast<unsigned_char_type>(text[i])) + 1);
+        }
+        return max;
+    }
+};
+
+// The set of LMS positions stored as a bit vector with a rank directory.
+// This replaces an n-word array mapping each LMS position to its rank.
+class LMSRankSupport {
+    std::vector<uint64_t> bits;
+    std::vector<index_type> word_ranks;
+
+public:
+    bool is_lms(index_type i) const {
+        return (bits[i >> 6] >> (i & 63)) & 1;
+    }
+
+    // Returns the number of LMS positions in [0, i).
+    index_type rank(index_type i) const {
+        uint64_t mask = (1ULL << (i & 63)) - 1;
+        return word_ranks[i >> 6] + __builtin_popcountll(bits[i >> 6] & mask);
+    }
+
+    // Marks the LMS positions of a text with the L/S types ls and returns the number of them.
+    index_type build(const std::vector<bool>& ls, uint64_t thread_count) {
+        const index_type n = static_cast<index_type>(ls.size());
+        const index_type word_count = (n + 63) / 64;
+        bits.resize(word_count, 0);
+        word_ranks.resize(word_count + 1, 0);
+
+        stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t, uint64_t b, uint64_t e) {
+            for (index_type i = std::max(b, (uint64_t)1); i < e; ++i) {
+                if (!ls[i - 1] && ls[i]) bits[i >> 6] |= 1ULL << (i & 63);
+            }
+            for (index_type w = b / 64; w < (e + 63) / 64; ++w) {
+                word_ranks[w + 1] = __builtin_popcountll(bits[w]);
+            }
+        }, BIT_VECTOR_ALIGNMENT);
+
+        for (index_type w = 0; w < word_count; ++w) {
+            word_ranks[w + 1] += word_ranks[w];
+        }
+        return word_ranks[word_count];
+    }
+};
+
+// Computes the L/S types of s[0..n-1] in parallel.
+// Each block is classified from right to left; the run of equal symbols at
+// the end of a block depends on the next block and is resolved afterwards.
+template <class TEXT>
+static void classify_parallel(const TEXT& s, std::vector<bool>& ls, uint64_t thread_count) {
     const index_type n = static_cast<index_type>(s.size());
-    std::vector<index_type> sa(n, std::numeric_limits<index_type>::max());
+    auto ranges = stool::ParallelFunctions::split_ranges(n, thread_count, BIT_VECTOR_ALIGNMENT);
+    std::vector<index_type> pending_begin(ranges.size());
+
+    stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t b, uint64_t e) {
+        bool resolved = false;
+        index_type i = e;
+        if (e == n) {
+            ls[n - 1] = true; // sentinel is S-type
+            resolved = true;
+            i = n - 1;
+        }
+        pending_begin[t] = i;
+        while (i > b) {
+            --i;
+            if (s[i] != s[i + 1]) {
+                ls[i] = (s[i] < s[i + 1]);
+                resolved = true;
+            } else if (resolved) {
+                ls[i] = ls[i + 1];
+            } else {
+                pending_begin[t] = i;
+            }
+        }
+    }, BIT_VECTOR_ALIGNMENT);
+
+    // head_type[t] is the type of the first position of the t-th block.
+    std::vector<bool> head_type(ranges.size() + 1, true);
+    for (index_type t = ranges.size(); t > 0; --t) {
+        index_type k = t - 1;
+        head_type[k] = pending_begin[k] == ranges[k].first ? head_type[k + 1] : ls[ranges[k].first];
+    }
+
+    stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t, uint64_t e) {
+        for (index_type i = pending_begin[t]; i < e; ++i) {
+            ls[i] = head_type[t + 1];
+        }
+    }, BIT_VECTOR_ALIGNMENT);
+}
+
+// Computes the bucket boundaries sum_l and sum_s in parallel using one histogram per thread.
+template <class TEXT>
+static void count_buckets_parallel(const TEXT& s, const std::vector<bool>& ls, index_type upper,
+                                   std::vector<index_type>& sum_l, std::vector<index_type>& sum_s, uint64_t thread_count) {
+    const index_type n = static_cast<index_type>(s.size());
+    uint64_t range_count = stool::ParallelFunctions::get_range_count(n, thread_count);
+    std::vector<std::vector<index_type>> local_l(range_count), local_s(range_count);
+
+    stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t b, uint64_t e) {
+        local_l[t].resize(upper + 1, 0);
+        local_s[t].resize(upper + 1, 0);
+        for (index_type i = b; i < e; ++i) {
+            if (!ls[i]) {
+                ++local_s[t][s[i]];
+            } else {
+                ++local_l[t][s[i] + 1];
+            }
+        }
+    });
+
+    stool::ParallelFunctions::parallel_for_ranges(upper + 1, thread_count, [&](uint64_t, uint64_t b, uint64_t e) {
+        for (index_type c = b; c < e; ++c) {
+            for (uint64_t t = 0; t < range_count; ++t) {
+                sum_l[c] += local_l[t][c];
+                sum_s[c] += local_s[t][c];
+            }
+        }
+    });
+}
+
+// Left-to-right induced-sorting scan. For each block of SA, the symbols of
+// the induced suffixes are read in parallel; the writes are then performed
+// sequentially in the same order as in the single-threaded scan. An entry
+// that changed after it was read is recomputed, so the result does not
+// depend on the number of threads.
+template <class TEXT, class INDEX>
+static void induce_l_parallel(const TEXT& s, const std::vector<bool>& ls, std::vector<INDEX>& sa,
+                              std::vector<index_type>& buf, uint64_t thread_count) {
+    const index_type n = static_cast<index_type>(sa.size());
+    const index_type empty = get_empty_value<INDEX>();
+    const index_type block_size = PARALLEL_INDUCE_BLOCK_SIZE_PER_THREAD * thread_count;
+    std::vector<std::pair<index_type, index_type>> cache(std::min(n, block_size));
+
+    auto get_bucket = [&](index_type v) -> index_type {
+        if (v == empty || v == 0 || ls[v - 1]) return SKIP;
+        return static_cast<index_type>(s[v - 1]);
+    };
+
+    for (index_type b = 0; b < n; b += block_size) {
+        const index_type e = std::min(n, b + block_size);
+        stool::ParallelFunctions::parallel_for_ranges(e - b, thread_count, [&](uint64_t, uint64_t x, uint64_t y) {
+            for (uint64_t i = x; i < y; ++i) {
+                index_type v = sa[b + i];
+                cache[i] = std::pair<index_type, index_type>(v, get_bucket(v));
+            }
+        });
+        for (index_type i = b; i < e; ++i) {
+            index_type v = sa[i];
+            index_type c = v == cache[i - b].first ? cache[i - b].second : get_bucket(v);
+            if (c != SKIP) {
+                sa[buf[c]++] = static_cast<INDEX>(v - 1);
+            }
+        }
+    }
+}
+
+// Right-to-left counterpart of induce_l_parallel.
+template <class TEXT, class INDEX>
+static void induce_s_parallel(const TEXT& s, const std::vector<bool>& ls, std::vector<INDEX>& sa,
+                              std::vector<index_type>& buf, uint64_t thread_count) {
+    const index_type n = static_cast<index_type>(sa.size());
+    const index_type empty = get_empty_value<INDEX>();
+    const index_type block_size = PARALLEL_INDUCE_BLOCK_SIZE_PER_THREAD * thread_count;
+    std::vector<std::pair<index_type, index_type>> cache(std::min(n, block_size));
+
+    auto get_bucket = [&](index_type v) -> index_type {
+        if (v == empty || v == 0 || !ls[v - 1]) return SKIP;
+        return static_cast<index_type>(s[v - 1]) + 1;
+    };
+
+    for (index_type e = n; e > 0;) {
+        const index_type b = e > block_size ? e - block_size : 0;
+        stool::ParallelFunctions::parallel_for_ranges(e - b, thread_count, [&](uint64_t, uint64_t x, uint64_t y) {
+            for (uint64_t i = x; i < y; ++i) {
+                index_type v = sa[b + i];
+                cache[i] = std::pair<index_type, index_type>(v, get_bucket(v));
+            }
+        });
+        for (index_type i = e; i > b; --i) {
+            index_type v = sa[i - 1];
+            index_type c = v == cache[i - 1 - b].first ? cache[i - 1 - b].second : get_bucket(v);
+            if (c != SKIP) {
+                sa[--buf[c]] = static_cast<INDEX>(v - 1);
+            }
+        }
+        e = b;
+    }
+}
+
+// Stores the LMS positions in text order into lms.
+template <class INDEX>
+static void collect_lms(const LMSRankSupport& lms_rank, index_type n, std::vector<INDEX>& lms, uint64_t thread_count) {
+    stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t, uint64_t b, uint64_t e) {
+        index_type m = lms_rank.rank(b);
+        for (index_type i = b; i < e; ++i) {
+            if (lms_rank.is_lms(i)) lms[m++] = static_cast<INDEX>(i);
+        }
+    });
+}
+
+// Extracts the LMS positions from sa in SA order.
+template <class INDEX>
+static void extract_sorted_lms(const std::vector<INDEX>& sa, const LMSRankSupport& lms_rank,
+                               std::vector<INDEX>& sorted_lms, uint64_t thread_count) {
+    const index_type n = static_cast<index_type>(sa.size());
+    const index_type empty = get_empty_value<INDEX>();
+    uint64_t range_count = stool::ParallelFunctions::get_range_count(n, thread_count);
+    std::vector<index_type> counts(range_count + 1, 0);
+
+    auto is_lms = [&](index_type v) {
+        return v != empty && lms_rank.is_lms(v);
+    };
+
+    stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t b, uint64_t e) {
+        for (index_type i = b; i < e; ++i) {
+            if (is_lms(sa[i])) ++counts[t + 1];
+        }
+    });
+    for (uint64_t t = 0; t < range_count; ++t) {
+        counts[t + 1] += counts[t];
+    }
+
+    sorted_lms.resize(counts[range_count]);
+    stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t b, uint64_t e) {
+        index_type m = counts[t];
+        for (index_type i = b; i < e; ++i) {
+            if (is_lms(sa[i])) sorted_lms[m++] = sa[i];
+        }
+    });
+}
+
+// Builds the suffix array of s, where s[n-1] must be a unique smallest symbol and every symbol is in [0, upper].
+// TEXT is any random-access container of integers (e.g., std::vector<uint64_t> or TextWithSentinel).
+template <class INDEX = uint64_t, class TEXT>
+static std::vector<INDEX> build_sa_int(const TEXT& s, index_type upper, uint64_t thread_count = 1) {
+    const index_type n = static_cast<index_type>(s.size());
+    const index_type empty = get_empty_value<INDEX>();
+    std::vector<INDEX> sa;
 
     if (n == 0) return sa;
     if (n == 1) {
-        sa[0] = 0;
+        sa.resize(1, static_cast<INDEX>(0));
         return sa;
     }
     if (n == 2) {
+        sa.resize(2);
         if (s[0] < s[1]) {
-            sa[0] = 0;
-            sa[1] = 1;
+            sa[0] = static_cast<INDEX>(0);
+            sa[1] = static_cast<INDEX>(1);
         } else {
-            sa[0] = 1;
-            sa[1] = 0;
+            sa[0] = static_cast<INDEX>(1);
+            sa[1] = static_cast<INDEX>(0);
         }
         return sa;
     }
+    const bool parallel = thread_count > 1 && n >= PARALLEL_MIN_LENGTH;
+    const uint64_t local_thread_count = parallel ? thread_count : 1;
 
     // ls[i] == true  <=> S-type
     // ls[i] == false <=> L-type
     std::vector<bool> ls(n);
-    ls[n - 1] = true; // sentinel is S-type
-    for (index_type i = n - 1; i > 0; --i) {
-        if (s[i - 1] == s[i]) {
-            ls[i - 1] = ls[i];
-        } else {
-            ls[i - 1] = (s[i - 1] < s[i]);
+    if (parallel) {
+        classify_parallel(s, ls, thread_count);
+    } else {
+        ls[n - 1] = true; // sentinel is S-type
+        for (index_type i = n - 1; i > 0; --i) {
+            if (s[i - 1] == s[i]) {
+                ls[i - 1] = ls[i];
+            } else {
+                ls[i - 1] = (s[i - 1] < s[i]);
+            }
         }
     }
 
     std::vector<index_type> sum_l(upper + 1, 0), sum_s(upper + 1, 0);
-    for (index_type i = 0; i < n; ++i) {
-        if (!ls[i]) {
-            ++sum_s[s[i]];
-        } else {
-            ++sum_l[s[i] + 1];
+    // One histogram per thread is only worth it if the alphabet is small compared to the text.
+    if (parallel && (upper + 1) * thread_count <= n) {
+        count_buckets_parallel(s, ls, upper, sum_l, sum_s, thread_count);
+    } else {
+        for (index_type i = 0; i < n; ++i) {
+            if (!ls[i]) {
+                ++sum_s[s[i]];
+            } else {
+                ++sum_l[s[i] + 1];
+            }
         }
     }
     for (index_type i = 0; i <= upper; ++i) {
@@ -71,8 +384,12 @@ static std::vector<index_type> build_sa_int(const std::vector<Int>& s, index_typ
         if (i < upper) sum_l[i + 1] += sum_s[i];
     }
 
-    auto induce = [&](const std::vector<index_type>& lms) {
-        std::fill(sa.begin(), sa.end(), std::numeric_limits<index_type>::max());
+    // sa is allocated here and released while the reduced problem is solved.
+    auto induce = [&](const std::vector<INDEX>& lms) {
+        sa.resize(n);
+        stool::ParallelFunctions::parallel_for_ranges(n, local_thread_count, [&](uint64_t, uint64_t b, uint64_t e) {
+            std::fill(sa.begin() + b, sa.begin() + e, static_cast<INDEX>(empty));
+        });
 
         std::vector<index_type> buf(upper + 1);
 
@@ -80,154 +397,535 @@ static std::vector<index_type> build_sa_int(const std::vector<Int>& s, index_typ
         std::copy(sum_s.begin(), sum_s.end(), buf.begin());
         for (index_type d : lms) {
             if (d == n) continue;
-            sa[buf[s[d]]++] = d;
+            sa[buf[s[d]]++] = static_cast<INDEX>(d);
         }
 
         // Place sentinel suffix.
         std::copy(sum_l.begin(), sum_l.end(), buf.begin());
-        sa[buf[s[n - 1]]++] = n - 1;
+        sa[buf[s[n - 1]]++] = static_cast<INDEX>(n - 1);
 
         // Induce L-type suffixes from left to right.
-        for (index_type i = 0; i < n; ++i) {
-            index_type v = sa[i];
-            if (v == std::numeric_limits<index_type>::max() || v == 0) continue;
-            --v;
-            if (!ls[v]) {
-                sa[buf[s[v]]++] = v;
+        if (parallel) {
+            induce_l_parallel(s, ls, sa, buf, thread_count);
+        } else {
+            for (index_type i = 0; i < n; ++i) {
+                index_type v = sa[i];
+                if (v == empty || v == 0) continue;
+                --v;
+                if (!ls[v]) {
+                    sa[buf[s[v]]++] = static_cast<INDEX>(v);
+                }
             }
         }
 
         // Induce S-type suffixes from right to left.
         std::copy(sum_l.begin(), sum_l.end(), buf.begin());
-        for (index_type i = n; i > 0; --i) {
-            index_type v = sa[i - 1];
-            if (v == std::numeric_limits<index_type>::max() || v == 0) continue;
-            --v;
-            if (ls[v]) {
-                sa[--buf[s[v] + 1]] = v;
+        if (parallel) {
+            induce_s_parallel(s, ls, sa, buf, thread_count);
+        } else {
+            for (index_type i = n; i > 0; --i) {
+                index_type v = sa[i - 1];
+                if (v == empty || v == 0) continue;
+                --v;
+                if (ls[v]) {
+                    sa[--buf[s[v] + 1]] = static_cast<INDEX>(v);
+                }
             }
         }
     };
 
     // Collect LMS positions.
-    std::vector<index_type> lms_map(n + 1, std::numeric_limits<index_type>::max());
-    index_type m = 0;
-    for (index_type i = 1; i < n; ++i) {
-        if (!ls[i - 1] && ls[i]) {
-            lms_map[i] = m++;
-        }
-    }
-
-    std::vector<index_type> lms;
-    lms.reserve(m);
-    for (index_type i = 1; i < n; ++i) {
-        if (!ls[i - 1] && ls[i]) lms.push_back(i);
-    }
+    LMSRankSupport lms_rank;
+    const index_type m = lms_rank.build(ls, local_thread_count);
+    std::vector<INDEX> lms(m);
+    collect_lms(lms_rank, n, lms, local_thread_count);
 
     induce(lms);
 
     if (m > 0) {
-        std::vector<index_type> sorted_lms;
-        sorted_lms.reserve(m);
-        for (index_type v : sa) {
-            if (v != std::numeric_limits<index_type>::max() && lms_map[v] != std::numeric_limits<index_type>::max()) {
-                sorted_lms.push_back(v);
-            }
-        }
-
-        std::vector<index_type> rec_s(m);
-        index_type rec_upper = 0;
-        rec_s[lms_map[sorted_lms[0]]] = 0;
-
-        for (index_type i = 1; i < m; ++i) {
-            index_type l = sorted_lms[i - 1];
-            index_type r = sorted_lms[i];
+        std::vector<INDEX> sorted_lms;
+        extract_sorted_lms(sa, lms_rank, sorted_lms, local_thread_count);
+        std::vector<INDEX>().swap(sa);
 
-            index_type end_l = (lms_map[l] + 1 < m) ? lms[lms_map[l] + 1] : n;
-            index_type end_r = (lms_map[r] + 1 < m) ? lms[lms_map[r] + 1] : n;
+        // Returns true iff the LMS substrings starting at l and r differ.
+        auto differ = [&](index_type l, index_type r) {
+            index_type rank_l = lms_rank.rank(l);
+            index_type rank_r = lms_rank.rank(r);
+            index_type end_l = (rank_l + 1 < m) ? static_cast<index_type>(lms[rank_l + 1]) : n;
+            index_type end_r = (rank_r + 1 < m) ? static_cast<index_type>(lms[rank_r + 1]) : n;
 
-            bool same = true;
             if ((end_l - l) != (end_r - r)) {
-                same = false;
-            } else {
-                while (l < end_l) {
-                    if (s[l] != s[r] || ls[l] != ls[r]) {
-                        same = false;
-                        break;
-                    }
-                    ++l;
-                    ++r;
+                return true;
+            }
+            while (l < end_l) {
+                if (s[l] != s[r] || ls[l] != ls[r]) {
+                    return true;
                 }
+                ++l;
+                ++r;
             }
+            return false;
+        };
 
-            if (!same) ++rec_upper;
-            rec_s[lms_map[sorted_lms[i]]] = rec_upper;
+        std::vector<INDEX> rec_s(m);
+        index_type rec_upper = 0;
+        rec_s[lms_rank.rank(sorted_lms[0])] = static_cast<INDEX>(0);
+
+        if (parallel) {
+            // Mark the first LMS substring of each new name, then turn the marks into names by prefix sums.
+            uint64_t range_count = stool::ParallelFunctions::get_range_count(m, thread_count);
+            std::vector<index_type> counts(range_count + 1, 0);
+            stool::ParallelFunctions::parallel_for_ranges(m, thread_count, [&](uint64_t t, uint64_t b, uint64_t e) {
+                for (index_type i = std::max(b, (uint64_t)1); i < e; ++i) {
+                    index_type d = differ(sorted_lms[i - 1], sorted_lms[i]) ? 1 : 0;
+                    rec_s[lms_rank.rank(sorted_lms[i])] = static_cast<INDEX>(d);
+                    counts[t + 1] += d;
+                }
+            });
+            for (uint64_t t = 0; t < range_count; ++t) {
+                counts[t + 1] += counts[t];
+            }
+            stool::ParallelFunctions::parallel_for_ranges(m, thread_count, [&](uint64_t t, uint64_t b, uint64_t e) {
+                index_type name = counts[t];
+                for (index_type i = std::max(b, (uint64_t)1); i < e; ++i) {
+                    index_type p = lms_rank.rank(sorted_lms[i]);
+                    name += static_cast<index_type>(rec_s[p]);
+                    rec_s[p] = static_cast<INDEX>(name);
+                }
+            });
+            rec_upper = counts[range_count];
+        } else {
+            for (index_type i = 1; i < m; ++i) {
+                if (differ(sorted_lms[i - 1], sorted_lms[i])) ++rec_upper;
+                rec_s[lms_rank.rank(sorted_lms[i])] = static_cast<INDEX>(rec_upper);
+            }
         }
+        std::vector<INDEX>().swap(sorted_lms);
 
-        std::vector<index_type> rec_sa;
+        std::vector<INDEX> rec_sa;
         if (rec_upper + 1 == m) {
             rec_sa.resize(m);
-            for (index_type i = 0; i < m; ++i) {
-                rec_sa[rec_s[i]] = i;
-            }
+            stool::ParallelFunctions::parallel_for_ranges(m, local_thread_count, [&](uint64_t, uint64_t b, uint64_t e) {
+                for (index_type i = b; i < e; ++i) {
+                    rec_sa[rec_s[i]] = static_cast<INDEX>(i);
+                }
+            });
         } else {
-            rec_sa = build_sa_int(rec_s, rec_upper);
+            rec_sa = build_sa_int<INDEX>(rec_s, rec_upper, thread_count);
         }
+        std::vector<INDEX>().swap(rec_s);
 
+        // rec_sa is overwritten with the sorted LMS positions.
+        stool::ParallelFunctions::parallel_for_ranges(m, local_thread_count, [&](uint64_t, uint64_t b, uint64_t e) {
+            for (index_type i = b; i < e; ++i) {
+                rec_sa[i] = lms[rec_sa[i]];
+            }
+        });
+        std::vector<INDEX>().swap(lms);
+        induce(rec_sa);
+    }
+
+    return sa;
+}
+
+// Removes the sentinel position from the SA of text + sentinel in place.
+// The sentinel is the smallest suffix, so it is sa_all[0].
+template <class INDEX>
+static void remove_sentinel(std::vector<INDEX>& sa_all, uint64_t thread_count) {
+    const index_type n = static_cast<index_type>(sa_all.size()) - 1;
+    if (n < PARALLEL_MIN_LENGTH) thread_count = 1;
+
+    // Each range [b, e) receives sa_all[b+1..e]; sa_all[e] is saved first because the next range overwrites it.
+    auto ranges = stool::ParallelFunctions::split_ranges(n, thread_count);
+    std::vector<INDEX> next_values(ranges.size());
+    for (uint64_t t = 0; t < ranges.size(); ++t) {
+        next_values[t] = sa_all[ranges[t].second];
+    }
+    stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t b, uint64_t e) {
+        for (index_type i = b; i + 1 < e; ++i) {
+            sa_all[i] = sa_all[i + 1];
+        }
+        sa_all[e - 1] = next_values[t];
+    });
+    sa_all.pop_back();
+}
+
+// ---------------------------------------------------------------------------
+// Low-workspace SA-IS.
+// The L/S types are not stored but recomputed from the text. The sorted LMS
+// substrings, their names and the reduced string are kept in the output array
+// sa as in the original SA-IS paper, and the bucket array of a recursion level
+// is placed in the unused middle part of sa whenever it fits.
+// ---------------------------------------------------------------------------
+
+// Returns true iff s[i] is S-type. The cost is O(the length of the run of s[i]).
+template <class TEXT>
+static bool is_s_type(const TEXT& s, index_type n, index_type i) {
+    while (i + 1 < n && s[i] == s[i + 1]) ++i;
+    return i + 1 == n || s[i] < s[i + 1];
+}
+
+// Returns true iff i is an LMS position. The run of s[i] is scanned only if s[i - 1] > s[i].
+template <class TEXT>
+static bool is_lms_position(const TEXT& s, index_type n, index_type i) {
+    return i > 0 && i < n && s[i - 1] > s[i] && is_s_type(s, n, i);
+}
+
+// Stores the bucket heads (end == false) or the bucket ends (end == true, exclusive) into bkt[0..upper].
+template <class TEXT, class INDEX>
+static void compute_buckets(const TEXT& s, index_type n, index_type upper, INDEX* bkt, bool end) {
+    std::fill(bkt, bkt + upper + 1, static_cast<INDEX>(0));
+    for (index_type i = 0; i < n; ++i) {
+        index_type c = s[i];
+        bkt[c] = static_cast<INDEX>(static_cast<index_type>(bkt[c]) + 1);
+    }
+    index_type sum = 0;
+    for (index_type c = 0; c <= upper; ++c) {
+        index_type count = bkt[c];
+        sum += count;
+        bkt[c] = static_cast<INDEX>(end ? sum : sum - count);
+    }
+}
+
+// Induced sorting without a type array.
+// In the left-to-right scan, only LMS and L-type suffixes are in sa, so s[j] is L-type iff s[j] >= s[j + 1].
+// In the right-to-left scan, if s[j] == s[j + 1], then s[j] is S-type iff s[j + 1] lies in the already
+// filled S-type part of its bucket, i.e., iff the position of s[j + 1] is at least bkt[s[j]].
+template <class TEXT, class INDEX>
+static void induce_without_types(const TEXT& s, index_type n, index_type upper, INDEX* sa, INDEX* bkt) {
+    const index_type empty = get_empty_value<INDEX>();
+
+    compute_buckets(s, n, upper, bkt, false);
+    for (index_type i = 0; i < n; ++i) {
+        index_type v = sa[i];
+        if (v == empty || v == 0) continue;
+        index_type j = v - 1;
+        index_type c = s[j];
+        if (c >= static_cast<index_type>(s[j + 1])) {
+            index_type p = bkt[c];
+            bkt[c] = static_cast<INDEX>(p + 1);
+            sa[p] = static_cast<INDEX>(j);
+        }
+    }
+
+    compute_buckets(s, n, upper, bkt, true);
+    for (index_type i = n; i > 0; --i) {
+        index_type v = sa[i - 1];
+        if (v == empty || v == 0) continue;
+        index_type j = v - 1;
+        index_type c = s[j];
+        index_type c1 = s[j + 1];
+        if (c < c1 || (c == c1 && static_cast<index_type>(bkt[c]) <= i - 1)) {
+            index_type p = static_cast<index_type>(bkt[c]) - 1;
+            bkt[c] = static_cast<INDEX>(p);
+            sa[p] = static_cast<INDEX>(j);
+        }
+    }
+}
+
+// Builds the suffix array of s[0..n-1] into sa[0..n-1], where s[n-1] must be a unique smallest symbol and
+// every symbol is in [0, upper]. bkt must have at least upper + 1 entries.
+template <class INDEX, class TEXT>
+static void build_sa_low_workspace(const TEXT& s, index_type n, index_type upper, INDEX* sa, INDEX* bkt) {
+    const index_type empty = get_empty_value<INDEX>();
+    if (n == 1) {
+        sa[0] = static_cast<INDEX>(0);
+        return;
+    }
+
+    // Stage 1: sort the LMS substrings.
+    std::fill(sa, sa + n, static_cast<INDEX>(empty));
+    compute_buckets(s, n, upper, bkt, true);
+    bool succ_is_s = true; // the sentinel is S-type
+    for (index_type i = n - 1; i > 0; --i) {
+        bool cur_is_s = s[i - 1] < s[i] || (s[i - 1] == s[i] && succ_is_s);
+        if (!cur_is_s && succ_is_s) {
+            index_type c = s[i];
+            index_type p = static_cast<index_type>(bkt[c]) - 1;
+            bkt[c] = static_cast<INDEX>(p);
+            sa[p] = static_cast<INDEX>(i);
+        }
+        succ_is_s = cur_is_s;
+    }
+    induce_without_types(s, n, upper, sa, bkt);
+
+    // Move the sorted LMS positions to sa[0..m-1].
+    index_type m = 0;
+    for (index_type i = 0; i < n; ++i) {
+        index_type v = sa[i];
+        if (is_lms_position(s, n, v)) sa[m++] = static_cast<INDEX>(v);
+    }
+
+    // Store the length of the LMS substring starting at each LMS position p into sa[m + p/2].
+    // LMS positions are at least 2 apart and 2m <= n, so these entries are distinct and lie in sa[m..n-1].
+    std::fill(sa + m, sa + n, static_cast<INDEX>(empty));
+    index_type next_lms = n - 1;
+    succ_is_s = true;
+    for (index_type i = n - 1; i > 0; --i) {
+        bool cur_is_s = s[i - 1] < s[i] || (s[i - 1] == s[i] && succ_is_s);
+        if (!cur_is_s && succ_is_s) {
+            sa[m + (i >> 1)] = static_cast<INDEX>(i == n - 1 ? 1 : next_lms - i + 1);
+            next_lms = i;
+        }
+        succ_is_s = cur_is_s;
+    }
+
+    // Name the LMS substrings. Two LMS substrings of the same length and the same symbols also have the same types.
+    index_type name_count = 0;
+    index_type prev = empty;
+    index_type prev_len = 0;
+    for (index_type i = 0; i < m; ++i) {
+        index_type p = sa[i];
+        index_type len = sa[m + (p >> 1)];
+        bool diff = prev == empty || len != prev_len;
+        for (index_type d = 0; !diff && d < len; ++d) {
+            diff = s[p + d] != s[prev + d];
+        }
+        if (diff) {
+            ++name_count;
+            prev = p;
+            prev_len = len;
+        }
+        sa[m + (p >> 1)] = static_cast<INDEX>(name_count - 1);
+    }
+
+    // Move the names to sa[n-m..n-1] in text order; this is the reduced string.
+    for (index_type i = n, j = n; i > m; --i) {
+        index_type v = sa[i - 1];
+        if (v != empty) sa[--j] = static_cast<INDEX>(v);
+    }
+
+    // Stage 2: sort the suffixes of the reduced string into sa[0..m-1].
+    // The bucket array of the recursion is placed in the free middle part of sa, or in bkt of this level,
+    // which is not read again before stage 3 recomputes the buckets. A buffer is allocated only if neither is large enough.
+    INDEX* sa1 = sa;
+    INDEX* s1 = sa + n - m;
+    if (name_count < m) {
+        const index_type free_space = n - 2 * m;
+        if (name_count <= free_space) {
+            build_sa_low_workspace<INDEX, const INDEX*>(s1, m, name_count - 1, sa1, sa + m);
+        } else if (name_count <= upper + 1) {
+            build_sa_low_workspace<INDEX, const INDEX*>(s1, m, name_count - 1, sa1, bkt);
+        } else {
+            std::vector<INDEX> rec_bkt(name_count);
+            build_sa_low_workspace<INDEX, const INDEX*>(s1, m, name_count - 1, sa1, rec_bkt.data());
+        }
+    } else {
         for (index_type i = 0; i < m; ++i) {
-            sorted_lms[i] = lms[rec_sa[i]];
+            sa1[s1[i]] = static_cast<INDEX>(i);
         }
-        induce(sorted_lms);
     }
 
-    return sa;
+    // Stage 3: induce the suffix array from the sorted LMS suffixes.
+    // The LMS positions in text order overwrite the reduced string.
+    succ_is_s = true;
+    for (index_type i = n - 1, j = n; i > 0; --i) {
+        bool cur_is_s = s[i - 1] < s[i] || (s[i - 1] == s[i] && succ_is_s);
+        if (!cur_is_s && succ_is_s) sa[--j] = static_cast<INDEX>(i);
+        succ_is_s = cur_is_s;
+    }
+    for (index_type i = 0; i < m; ++i) {
+        sa[i] = s1[static_cast<index_type>(sa[i])];
+    }
+    std::fill(sa + m, sa + n, static_cast<INDEX>(empty));
+
+    compute_buckets(s, n, upper, bkt, true);
+    for (index_type i = m; i > 0; --i) {
+        index_type v = sa[i - 1];
+        sa[i - 1] = static_cast<INDEX>(empty);
+        index_type c = s[v];
+        index_type p = static_cast<index_type>(bkt[c]) - 1;
+        bkt[c] = static_cast<INDEX>(p);
+        sa[p] = static_cast<INDEX>(v);
+    }
+    induce_without_types(s, n, upper, sa, bkt);
 }
 
-} // namespace sais_detail
+// The body of stool::parallel_sais_suffix_array.
+// TEXT is std::vector<C> or stool::MappedVector<C>.
+template <class C, class INDEX, class TEXT>
+std::vector<INDEX> parallel_sais(const TEXT& text, uint64_t thread_count) {
+    static_assert(std::is_integral<C>::value || std::is_enum<C>::value,
+                  "C must be an integral or enum-like character type.");
 
+    const index_type n = static_cast<index_type>(text.size());
+    std::vector<INDEX> result;
 
-namespace stool {
-    template <class C>
-    std::vector<uint64_t> sais_suffix_array(const std::vector<C>& text) {
-        using sais_detail::index_type;
-    
-        static_assert(std::is_integral<C>::value || std::is_enum<C>::value,
-                      "C must be an integral or enum-like character type.");
-    
-        const index_type n = static_cast<index_type>(text.size());
-        std::vector<uint64_t> result;
-    
-        if (n == 0) return result;
-    
+    if (n == 0) return result;
+    if (n + 1 >= get_empty_value<INDEX>()) {
+        throw std::invalid_argument("sais_suffix_array: the text is too long for the index type");
+    }
+    if (n < PARALLEL_MIN_LENGTH) thread_count = 1;
+
+    if constexpr (sizeof(C) == 1) {
+        // 1-byte characters are ranked by their unsigned values without coordinate compression.
+        TextWithSentinel<C> s(text.data(), n);
+        result = build_sa_int<INDEX>(s, 256, thread_count);
+    } else {
         // Coordinate compression:
         // internal string = [rank(text[i]) + 1] + sentinel(0)
         // so that 0 is a unique smallest symbol.
-        std::vector<uint64_t> vals;
-        vals.reserve(n);
-        for (const auto& ch : text) {
-            vals.push_back(static_cast<uint64_t>(ch));
+        // Each thread collects the distinct symbols of its range, and the results are merged.
+        uint64_t range_count = stool::ParallelFunctions::get_range_count(n, thread_count);
+        std::vector<std::vector<uint64_t>> local_ord(range_count);
+        stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t t, uint64_t b, uint64_t e) {
+            std::vector<uint64_t>& tmp = local_ord[t];
+            tmp.reserve(e - b);
+            for (index_type i = b; i < e; ++i) {
+                tmp.push_back(static_cast<uint64_t>(text[i]));
+            }
+            std::sort(tmp.begin(), tmp.end());
+            tmp.erase(std::unique(tmp.begin(), tmp.end()), tmp.end());
+            tmp.shrink_to_fit();
+        });
+
+        std::vector<uint64_t> ord;
+        for (auto& tmp : local_ord) {
+            ord.insert(ord.end(), tmp.begin(), tmp.end());
+            std::vector<uint64_t>().swap(tmp);
         }
-    
-        std::vector<uint64_t> ord = vals;
         std::sort(ord.begin(), ord.end());
         ord.erase(std::unique(ord.begin(), ord.end()), ord.end());
-    
+
         std::vector<uint64_t> s(n + 1);
+        stool::ParallelFunctions::parallel_for_ranges(n, thread_count, [&](uint64_t, uint64_t b, uint64_t e) {
+            for (index_type i = b; i < e; ++i) {
+                s[i] = static_cast<uint64_t>(
+                    std::lower_bound(ord.begin(), ord.end(), static_cast<uint64_t>(text[i])) - ord.begin()
+                ) + 1;
+            }
+        });
+        s[n] = 0; // sentinel
+
+        result = build_sa_int<INDEX>(s, static_cast<uint64_t>(ord.size()), thread_count);
+    }
+
+    remove_sentinel(result, thread_count);
+    return result;
+}
+
+// The body of stool::low_workspace_sais_suffix_array.
+template <class C, class INDEX, class TEXT>
+std::vector<INDEX> low_workspace_sais(const TEXT& text) {
+    static_assert(std::is_integral<C>::value || std::is_enum<C>::value,
+                  "C must be an integral or enum-like character type.");
+
+    const index_type n = static_cast<index_type>(text.size());
+    std::vector<INDEX> result;
+
+    if (n == 0) return result;
+    if (n + 1 >= get_empty_value<INDEX>()) {
+        throw std::invalid_argument("sais_suffix_array: the text is too long for the index type");
+    }
+
+    result.resize(n + 1);
+    TextWithSentinel<C> view(text.data(), n);
+    index_type upper = view.max_symbol();
+    if (upper <= n) {
+        std::vector<INDEX> bkt(upper + 1);
+        build_sa_low_workspace<INDEX>(view, n + 1, upper, result.data(), bkt.data());
+    } else {
+        std::vector<uint64_t> ord;
+        {
+            std::unordered_set<uint64_t> alphabet;
+            for (const auto& ch : text) {
+                alphabet.insert(static_cast<uint64_t>(ch));
+            }
+            ord.assign(alphabet.begin(), alphabet.end());
+        }
+        std::sort(ord.begin(), ord.end());
+
+        std::vector<INDEX> s(n + 1);
         for (index_type i = 0; i < n; ++i) {
-            s[i] = static_cast<uint64_t>(
-                std::lower_bound(ord.begin(), ord.end(), vals[i]) - ord.begin()
-            ) + 1;
+            s[i] = static_cast<INDEX>(
+                std::lower_bound(ord.begin(), ord.end(), static_cast<uint64_t>(text[i])) - ord.begin() + 1
+            );
         }
-        s[n] = 0; // sentinel
-    
-        auto sa_all = sais_detail::build_sa_int(s, static_cast<uint64_t>(ord.size()));
-    
-        // Remove the sentinel position.
-        result.reserve(n);
-        for (uint64_t p : sa_all) {
-            if (p != n) result.push_back(p);
+        s[n] = static_cast<INDEX>(0); // sentinel
+
+        std::vector<INDEX> bkt(ord.size() + 1);
+        build_sa_low_workspace<INDEX>(s, n + 1, ord.size(), result.data(), bkt.data());
+    }
+
+    remove_sentinel(result, 1);
+    return result;
+}
+
+} // namespace sais_detail
+
+
+namespace stool {
+    /**
+     * @brief Constructs the suffix array of \p text with SA-IS using \p thread_count threads
+     *
+     * The output is identical to the one of sais_suffix_array(text) for every \p thread_count.
+     *
+     * @tparam INDEX The integer type of the output and the working arrays (uint64_t, uint32_t or stool::UInt40)
+     * @throws std::invalid_argument If text.size() is too large for INDEX
+     */
+    template <class C, class INDEX = uint64_t>
+    std::vector<INDEX> parallel_sais_suffix_array(const std::vector<C>& text, uint64_t thread_count) {
+        return sais_detail::parallel_sais<C, INDEX>(text, thread_count);
+    }
+
+    /**
+     * @brief Constructs the suffix array of a text mapped from a file with SA-IS using \p thread_count threads
+     */
+    template <class C, class INDEX = uint64_t>
+    std::vector<INDEX> parallel_sais_suffix_array(const stool::MappedVector<C>& text, uint64_t thread_count) {
+        return sais_detail::parallel_sais<C, INDEX>(text, thread_count);
+    }
+
+    /**
+     * @brief Constructs the suffix array of \p text with a low-workspace variant of SA-IS
+     *
+     * No L/S type array is used, and the reduced problems are solved inside the output array.
+     * Besides the output, the workspace is one bucket array for the largest character of \p text and
+     * the bucket arrays of the recursion levels that fit neither into the unused part of the output nor into the bucket array of the level above.
+     * If the largest character is not less than text.size(), \p text is first coordinate-compressed into an array of INDEX.
+     * The output is identical to the one of sais_suffix_array(text).
+     *
+     * @throws std::invalid_argument If text.size() is too large for INDEX
+     */
+    template <class C, class INDEX = uint64_t>
+    std::vector<INDEX> low_workspace_sais_suffix_array(const std::vector<C>& text) {
+        return sais_detail::low_workspace_sais<C, INDEX>(text);
+    }
+
+    /**
+     * @brief Constructs the suffix array of a text mapped from a file with a low-workspace variant of SA-IS
+     */
+    template <class C, class INDEX = uint64_t>
+    std::vector<INDEX> low_workspace_sais_suffix_array(const stool::MappedVector<C>& text) {
+        return sais_detail::low_workspace_sais<C, INDEX>(text);
+    }
+
+    /**
+     * @brief Constructs the suffix array of \p text with SA-IS
+     *
+     * @param low_workspace If true, low_workspace_sais_suffix_array is used
+     */
+    template <class C, class INDEX = uint64_t>
+    std::vector<INDEX> sais_suffix_array(const std::vector<C>& text, bool low_workspace = false) {
+        if (low_workspace) {
+            return low_workspace_sais_suffix_array<C, INDEX>(text);
+        } else {
+            return parallel_sais_suffix_array<C, INDEX>(text, 1);
+        }
+    }
+
+    /**
+     * @brief Constructs the suffix array of a text mapped from a file with SA-IS
+     *
+     * @param low_workspace If true, low_workspace_sais_suffix_array is used
+     */
+    template <class C, class INDEX = uint64_t>
+    std::vector<INDEX> sais_suffix_array(const stool::MappedVector<C>& text, bool low_workspace = false) {
+        if (low_workspace) {
+            return low_workspace_sais_suffix_array<C, INDEX>(text);
+        } else {
+            return parallel_sais_suffix_array<C, INDEX>(text, 1);
         }
-        return result;
     }
 
     template <class C>
@@ -256,15 +954,9 @@ namespace stool {
         }
         s[n] = 0; // sentinel
 
-        auto sa_all = sais_detail::build_sa_int(s, static_cast<uint64_t>(ord.size()));
-
-        // Remove the sentinel position.
-        result.reserve(n);
-        for (uint64_t p : sa_all) {
-            if (p != n) result.push_back(p);
-        }
+        result = sais_detail::build_sa_int(s, static_cast<uint64_t>(ord.size()));
+        sais_detail::remove_sentinel(result, 1);
         return result;
     }
-    
-}
 
+}
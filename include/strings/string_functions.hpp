@@ -2,6 +2,9 @@
 #include <string>
 #include <vector>
 #include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include <unordered_set>
 
 namespace stool
 {
@@ -75,6 +78,47 @@ namespace stool
             return r;
         }
 
+        /**
+         * @brief Collects the unique characters of the input text \p T[0..n-1] of any character type.
+         * @tparam TEXT A random access container of integers (e.g., std::vector<uint32_t>, stool::MappedVector<int8_t>)
+         * @return The unique characters in \p T as unsigned integers of the same width, sorted in increasing order.
+         */
+        template <typename TEXT>
+        static std::vector<uint64_t> get_alphabet_as_integers(const TEXT &T)
+        {
+            using CHAR = typename std::remove_cv<typename std::remove_reference<decltype(T[0])>::type>::type;
+            using UCHAR = typename std::make_unsigned<CHAR>::type;
+            std::vector<uint64_t> r;
+            if constexpr (sizeof(CHAR) <= 2)
+            {
+                std::vector<bool> checker;
+                checker.resize(1ULL << (sizeof(CHAR) * 8), false);
+                for (uint64_t i = 0; i < T.size(); i++)
+                {
+                    checker[(UCHAR)T[i]] = true;
+                }
+                for (uint64_t i = 0; i < checker.size(); i++)
+                {
+                    if (checker[i])
+                    {
+                        r.push_back(i);
+                    }
+                }
+            }
+            else
+            {
+                // Only the distinct characters are stored, so a text over a small alphabet needs O(sigma) extra space, not a copy of the text.
+                std::unordered_set<uint64_t> checker;
+                for (uint64_t i = 0; i < T.size(); i++)
+                {
+                    checker.insert((UCHAR)T[i]);
+                }
+                r.assign(checker.begin(), checker.end());
+                std::sort(r.begin(), r.end());
+            }
+            return r;
+        }
+
         /**
          * @brief Gets the i-th suffix of the text \p T[0..n-1].
          */
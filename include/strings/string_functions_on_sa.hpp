@@ -19,7 +19,8 @@ namespace stool
          * @brief Compares a suffix \p T[pos..] of a text with a given pattern \p P
          * @return 0 if the suffix is equal to the pattern, -1 if the suffix is lexicographically less than the pattern, 1 if the suffix is lexicographically greater than the pattern
          */
-        static int compare_suffix_with_pattern(const std::vector<uint8_t> &T, size_t pos, const std::vector<uint8_t> &P)
+        template <typename TEXT>
+        static int compare_suffix_with_pattern(const TEXT &T, size_t pos, const std::vector<uint8_t> &P)
         {
             size_t n = T.size();
             size_t m = P.size();
@@ -41,7 +42,8 @@ namespace stool
         /**
          * @brief Finds the lower bound of a pattern in a suffix array using binary search
          */
-        static size_t lower_bound_on_suffix_array(const std::vector<uint8_t> &T, const std::vector<uint64_t> &SA, const std::vector<uint8_t> &P)
+        template <typename TEXT, typename SA_ARRAY>
+        static size_t lower_bound_on_suffix_array(const TEXT &T, const SA_ARRAY &SA, const std::vector<uint8_t> &P)
         {
             size_t lo = 0, hi = SA.size();
             while (lo < hi)
@@ -82,9 +84,12 @@ namespace stool
         /**
          * @brief Computes the suffix array interval \p [L..R] (sa-interval) of a given pattern \p P on the suffix array \p SA of a string \p T.
          * 
+         * @tparam TEXT std::vector<uint8_t> or stool::MappedVector<uint8_t>
+         * @tparam SA_ARRAY std::vector<uint64_t> or stool::MappedVector<uint64_t>
          * @return The sa-interval \p [L..R] if it exists, otherwise \p [-1,-1].
          */
-        static Interval compute_sa_interval(const std::vector<uint8_t> &T, const std::vector<uint8_t> &P, const std::vector<uint64_t> &SA)
+        template <typename TEXT = std::vector<uint8_t>, typename SA_ARRAY = std::vector<uint64_t>>
+        static Interval compute_sa_interval(const TEXT &T, const std::vector<uint8_t> &P, const SA_ARRAY &SA)
         {
             // vector<int> res;
             size_t n = T.size();
@@ -112,8 +117,12 @@ namespace stool
 
         /**
          * @brief Locates all occurrences of a pattern \p P in the text \p T using the binary search on the suffix array \p SA.
+         *
+         * @tparam TEXT std::vector<uint8_t> or stool::MappedVector<uint8_t> (e.g., FileReader::map_vector<uint8_t>(path))
+         * @tparam SA_ARRAY std::vector<uint64_t> or stool::MappedVector<uint64_t>
          */
-        static std::vector<uint64_t> locate_query(const std::vector<uint8_t> &T, const std::vector<uint8_t> &P, const std::vector<uint64_t> &SA)
+        template <typename TEXT = std::vector<uint8_t>, typename SA_ARRAY = std::vector<uint64_t>>
+        static std::vector<uint64_t> locate_query(const TEXT &T, const std::vector<uint8_t> &P, const SA_ARRAY &SA)
         {
             std::vector<uint64_t> r;
             auto interval = compute_sa_interval(T, P, SA);
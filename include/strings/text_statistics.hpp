@@ -167,7 +167,7 @@ namespace stool
         static TextStatistics build(std::string filename, int message_paragraph = stool::Message::SHOW_MESSAGE)
         {
 
-            stool::OnlineFileReader ofr(filename);
+            stool::OnlineFileReader ofr(filename, stool::OnlineFileReader::PREFETCH_BUFFER_SIZE, true);
             ofr.open();
             stool::ForwardRLE frle(ofr.begin(), ofr.end(), ofr.size());
             TextStatistics ts = TextStatistics::build(frle, message_paragraph);
@@ -30,11 +30,20 @@ int main(int argc, char *argv[])
     // p.add<std::string>("input_file", 'i', "input file name", true);
     p.add<std::string>("input_file", 'i', "input file name", true);
     //p.add<uint>("option", 'b', "option", false, 0);
+    p.add<uint64_t>("threads", 'p', "the number of threads", false, 1);
+    p.add<bool>("rank_directory", 'r', "use a byte rank directory instead of a wavelet tree (faster, but larger)", false, false);
+    p.add<uint64_t>("memory_limit", 'm', "the memory for the queues of Beller's algorithm (MB); the rest is spilled to disk. 0 means no limit", false, 0);
+    p.add<std::string>("tmp_dir", 'd', "the directory for the spilled queues", false, ".");
     
 
     p.parse_check(argc, argv);
     //uint64_t mode = p.get<uint>("option");
     std::string input_file_path = p.get<std::string>("input_file");
+    uint64_t thread_count = p.get<uint64_t>("threads");
+    stool::IntervalSearchBackend backend = p.get<bool>("rank_directory") ? stool::IntervalSearchBackend::ByteRankDirectory : stool::IntervalSearchBackend::WaveletTree;
+    uint64_t memory_limit_mb = p.get<uint64_t>("memory_limit");
+    uint64_t queue_memory_limit_bytes = memory_limit_mb == 0 ? UINT64_MAX : memory_limit_mb * 1024 * 1024;
+    std::string tmp_dir = p.get<std::string>("tmp_dir");
 
     std::chrono::system_clock::time_point st1, st2;
     st1 = std::chrono::system_clock::now();
@@ -45,7 +54,7 @@ int main(int argc, char *argv[])
     stool::FileReader::load_vector(input_file_path, text);
     sdsl::int_vector<> int_text;
     stool::SDSLFunctions::to_int_vector(text, int_text);
-    std::vector<uint64_t> lcp_statistics = stool::beller::LCPEnumerator::compute_lcp_statistics(int_text);
+    std::vector<uint64_t> lcp_statistics = stool::beller::LCPEnumerator::compute_lcp_statistics(int_text, stool::Message::SHOW_MESSAGE, thread_count, backend, queue_memory_limit_bytes, tmp_dir);
     std::vector<uint64_t> distinct_substring_counter_array = stool::SubstringComplexityFunctions::construct_distinct_substring_counter_array_from_lcp_statistics(lcp_statistics, text.size());
     uint64_t delta = stool::SubstringComplexityFunctions::compute_delta(distinct_substring_counter_array);
 
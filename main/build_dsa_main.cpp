@@ -8,27 +8,34 @@
 
 
 template <typename T>
-void mainfunc(std::string input, std::string outputFile, bool textOutput)
+void mainfunc(std::string input, std::string outputFile, bool textOutput, uint64_t thread_count, bool packedOutput)
 {
     auto start = std::chrono::system_clock::now();
 
 
-    std::vector<T> text;
-    std::cout << "Loading Text..." << std::endl;
-    stool::FileReader::load_vector(input, text);
+    std::cout << "Mapping Text..." << std::endl;
+    stool::MappedVector<T> text = stool::FileReader::map_vector<T>(input);
 
     std::cout << "Constructing Suffix Array..." << std::endl;
-    std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+    std::vector<uint64_t> sa = stool::parallel_sais_suffix_array(text, thread_count);
 
-    std::cout << "Constructing DSA..." << std::endl;
-    std::vector<int64_t> dsa = stool::ArrayConstructor::construct_DSA(sa);
-
-    if(textOutput) {
-        std::cout << "Writing DSA as Text..." << std::endl;
-        stool::FileWriter::write_vector_as_text(outputFile, dsa);
+    std::vector<int64_t> dsa = stool::ArrayConstructor::construct_DSA(sa, stool::Message::SHOW_MESSAGE, thread_count);
+    std::vector<uint64_t>().swap(sa);
+    if(packedOutput) {
+        std::cout << "Writing DSA as Packed Array..." << std::endl;
+        stool::FileWriter::write_packed_array(outputFile, dsa, stool::PackedArrayContent::DifferentialSuffixArray, text.size(), stool::StringFunctions::get_alphabet_as_integers(text));
     }else{
-        std::cout << "Writing DSA..." << std::endl;
-        stool::FileWriter::write_vector(outputFile, dsa);
+        stool::StreamingFileWriter writer(outputFile, stool::StreamingFileWriter::DEFAULT_BUFFER_SIZE, true);
+        if(textOutput) {
+            std::cout << "Writing DSA as Text..." << std::endl;
+            for (uint64_t i = 0; i < dsa.size(); i++) {
+                writer.push_back_as_text(dsa[i]);
+            }
+        }else{
+            std::cout << "Writing DSA..." << std::endl;
+            writer.write_block(dsa);
+        }
+        writer.close();
     }
 
     auto end = std::chrono::system_clock::now();
@@ -66,8 +73,10 @@ int main(int argc, char *argv[])
     p.add<std::string>("input_file", 'i', "input file path", true);
     p.add<std::string>("output_file", 'o', "output bwt file path", false, "");
     p.add<bool>("text_output", 't', "output text file", false, false);
+    p.add<bool>("packed_output", 'k', "output a self-describing bit-packed file", false, false);
     //p.add<int64_t>("special_character", 's', "special character", false, 0);
     p.add<std::string>("char_type", 'c', "char_type", true, "uint8_t");
+    p.add<uint64_t>("threads", 'p', "the number of threads", false, 1);
 
     p.parse_check(argc, argv);
     std::string inputFile = p.get<std::string>("input_file");
@@ -75,43 +84,49 @@ int main(int argc, char *argv[])
     //int64_t specialCharacter = p.get<int64_t>("special_character");
     std::string char_type = p.get<std::string>("char_type");
     bool textOutput = p.get<bool>("text_output");
+    bool packedOutput = p.get<bool>("packed_output");
+    uint64_t thread_count = p.get<uint64_t>("threads");
     
     if (outputFile.size() == 0)
     {
         outputFile = inputFile + ".sa";
     }
+    if (textOutput && packedOutput)
+    {
+        throw std::runtime_error("text_output and packed_output cannot be used together");
+    }
 
     if (char_type == "uint8_t")
     {
-        mainfunc<uint8_t>(inputFile, outputFile, textOutput);
+        mainfunc<uint8_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "uint16_t")
     {
-        mainfunc<uint16_t>(inputFile, outputFile, textOutput);
+        mainfunc<uint16_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "uint32_t")
     {
-        mainfunc<uint32_t>(inputFile, outputFile, textOutput);
+        mainfunc<uint32_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "uint64_t")
     {
-        mainfunc<uint64_t>(inputFile, outputFile, textOutput);
+        mainfunc<uint64_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "int8_t")
     {
-        mainfunc<int8_t>(inputFile, outputFile, textOutput);
+        mainfunc<int8_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "int16_t")
     {
-        mainfunc<int16_t>(inputFile, outputFile, textOutput);
+        mainfunc<int16_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "int32_t")
     {
-        mainfunc<int32_t>(inputFile, outputFile, textOutput);
+        mainfunc<int32_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "int64_t")
     {
-        mainfunc<int64_t>(inputFile, outputFile, textOutput);
+        mainfunc<int64_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else
     {
@@ -8,24 +8,26 @@
 
 
 template <typename T>
-void mainfunc(std::string input, std::string outputFile, bool textOutput)
+void mainfunc(std::string input, std::string outputFile, bool textOutput, uint64_t thread_count, bool packedOutput)
 {
     auto start = std::chrono::system_clock::now();
 
 
-    std::vector<T> text;
-    std::cout << "Loading Text..." << std::endl;
-    stool::FileReader::load_vector(input, text);
+    std::cout << "Mapping Text..." << std::endl;
+    stool::MappedVector<T> text = stool::FileReader::map_vector<T>(input);
 
     std::cout << "Constructing Suffix Array..." << std::endl;
-    std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+    std::vector<uint64_t> sa = stool::parallel_sais_suffix_array(text, thread_count);
 
     std::cout << "Constructing Inverse Suffix Array..." << std::endl;
-    std::vector<uint64_t> isa = stool::ArrayConstructor::construct_ISA(sa);
+    std::vector<uint64_t> isa = stool::ArrayConstructor::construct_ISA(sa, stool::Message::SHOW_MESSAGE, thread_count);
 
     if(textOutput) {
         std::cout << "Writing Inverse Suffix Array as Text..." << std::endl;
         stool::FileWriter::write_vector_as_text(outputFile, isa);
+    }else if(packedOutput) {
+        std::cout << "Writing Inverse Suffix Array as Packed Array..." << std::endl;
+        stool::FileWriter::write_packed_array(outputFile, isa, stool::PackedArrayContent::InverseSuffixArray, text.size(), stool::StringFunctions::get_alphabet_as_integers(text));
     }else{
         std::cout << "Writing Inverse Suffix Array..." << std::endl;
         stool::FileWriter::write_vector(outputFile, isa);    
@@ -66,8 +68,10 @@ int main(int argc, char *argv[])
     p.add<std::string>("input_file", 'i', "input file path", true);
     p.add<std::string>("output_file", 'o', "output bwt file path", false, "");
     p.add<bool>("text_output", 't', "output text file", false, false);
+    p.add<bool>("packed_output", 'k', "output a self-describing bit-packed file", false, false);
     //p.add<int64_t>("special_character", 's', "special character", false, 0);
     p.add<std::string>("char_type", 'c', "char_type", true, "uint8_t");
+    p.add<uint64_t>("threads", 'p', "the number of threads", false, 1);
 
     p.parse_check(argc, argv);
     std::string inputFile = p.get<std::string>("input_file");
@@ -75,43 +79,49 @@ int main(int argc, char *argv[])
     //int64_t specialCharacter = p.get<int64_t>("special_character");
     std::string char_type = p.get<std::string>("char_type");
     bool textOutput = p.get<bool>("text_output");
+    bool packedOutput = p.get<bool>("packed_output");
+    uint64_t thread_count = p.get<uint64_t>("threads");
     
     if (outputFile.size() == 0)
     {
         outputFile = inputFile + ".sa";
     }
+    if (textOutput && packedOutput)
+    {
+        throw std::runtime_error("text_output and packed_output cannot be used together");
+    }
 
     if (char_type == "uint8_t")
     {
-        mainfunc<uint8_t>(inputFile, outputFile, textOutput);
+        mainfunc<uint8_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "uint16_t")
     {
-        mainfunc<uint16_t>(inputFile, outputFile, textOutput);
+        mainfunc<uint16_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "uint32_t")
     {
-        mainfunc<uint32_t>(inputFile, outputFile, textOutput);
+        mainfunc<uint32_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "uint64_t")
     {
-        mainfunc<uint64_t>(inputFile, outputFile, textOutput);
+        mainfunc<uint64_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "int8_t")
     {
-        mainfunc<int8_t>(inputFile, outputFile, textOutput);
+        mainfunc<int8_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "int16_t")
     {
-        mainfunc<int16_t>(inputFile, outputFile, textOutput);
+        mainfunc<int16_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "int32_t")
     {
-        mainfunc<int32_t>(inputFile, outputFile, textOutput);
+        mainfunc<int32_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else if (char_type == "int64_t")
     {
-        mainfunc<int64_t>(inputFile, outputFile, textOutput);
+        mainfunc<int64_t>(inputFile, outputFile, textOutput, thread_count, packedOutput);
     }
     else
     {
@@ -0,0 +1,63 @@
+#include <iostream>
+#include <string>
+#include <memory>
+#include "cmdline/cmdline.h"
+#include "../include/all.hpp"
+
+int main(int argc, char *argv[])
+{
+
+    std::cout << "\033[41m";
+    #ifdef RELEASE_BUILD
+        std::cout << "Running in Release mode";
+    #elif defined(DEBUG_BUILD)
+
+        std::cout << "Running in Debug mode";
+    #else
+        std::cout << "Running in Unknown mode";
+    #endif
+    std::cout << "\e[m" << std::endl;
+
+
+    cmdline::parser p;
+    p.add<std::string>("input_file", 'i', "input file path (the last character must be the unique smallest character)", true);
+    p.add<std::string>("output_file", 'o', "output bwt file path", false, "");
+    p.add<uint64_t>("window_size", 'w', "the window size of the prefix-free parsing", false, stool::PrefixFreeParsing::DEFAULT_WINDOW_SIZE);
+    p.add<uint64_t>("modulus", 'm', "the modulus of the prefix-free parsing", false, stool::PrefixFreeParsing::DEFAULT_MODULUS);
+
+    p.parse_check(argc, argv);
+    std::string inputFile = p.get<std::string>("input_file");
+    std::string outputFile = p.get<std::string>("output_file");
+    uint64_t window_size = p.get<uint64_t>("window_size");
+    uint64_t modulus = p.get<uint64_t>("modulus");
+
+    if (outputFile.size() == 0)
+    {
+        outputFile = inputFile + ".bwt";
+    }
+
+    auto start = std::chrono::system_clock::now();
+
+    std::vector<uint8_t> run_chars;
+    std::vector<uint64_t> run_lengths;
+    stool::PrefixFreeParsing::build_RLBWT_from_file(inputFile, run_chars, run_lengths, window_size, modulus);
+
+    std::cout << "Writing BWT..." << std::endl;
+    stool::RLEIO::write_BWT_from_RLBWT(outputFile, run_chars, run_lengths);
+
+    auto end = std::chrono::system_clock::now();
+    double elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    uint64_t text_size = stool::OnlineFileReader::get_text_size(inputFile);
+
+    std::cout << "\033[36m";
+    std::cout << "=============RESULT===============" << std::endl;
+    std::cout << "File : " << inputFile << std::endl;
+    std::cout << "Output file : " << outputFile << std::endl;
+    std::cout << "The length of the input text : " << text_size << std::endl;
+    std::cout << "The number of runs in BWT : " << run_chars.size() << std::endl;
+    double charperms = (double)text_size / elapsed;
+    std::cout << "Excecution time : " << ((uint64_t)elapsed) << "ms";
+    std::cout << "[" << charperms << "chars/ms]" << std::endl;
+    std::cout << "==================================" << std::endl;
+    std::cout << "\033[39m" << std::endl;
+}
@@ -7,25 +7,88 @@
 
 
 
-template <typename T>
-void mainfunc(std::string input, std::string outputFile, bool textOutput)
+template <typename T, typename INDEX>
+void construct_and_write_suffix_array(const stool::MappedVector<T> &text, std::string outputFile, bool textOutput, uint64_t thread_count, bool lowMemory, bool packedOutput)
 {
-    auto start = std::chrono::system_clock::now();
-
-
-    std::vector<T> text;
-    std::cout << "Loading Text..." << std::endl;
-    stool::FileReader::load_vector(input, text);
+    std::vector<INDEX> sa;
+    if (lowMemory)
+    {
+        std::cout << "Constructing Suffix Array (" << (sizeof(INDEX) * 8) << "-bit index, low workspace)..." << std::endl;
+        sa = stool::low_workspace_sais_suffix_array<T, INDEX>(text);
+    }
+    else
+    {
+        std::cout << "Constructing Suffix Array (" << (sizeof(INDEX) * 8) << "-bit index)..." << std::endl;
+        sa = stool::parallel_sais_suffix_array<T, INDEX>(text, thread_count);
+    }
 
-    std::cout << "Constructing Suffix Array..." << std::endl;
-    std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+    if(packedOutput) {
+        std::cout << "Writing Suffix Array as Packed Array..." << std::endl;
+        stool::FileWriter::write_packed_array(outputFile, sa, stool::PackedArrayContent::SuffixArray, text.size(), stool::StringFunctions::get_alphabet_as_integers(text));
+        return;
+    }
 
+    // The output is written by a background thread while the values are converted.
+    stool::StreamingFileWriter writer(outputFile, stool::StreamingFileWriter::DEFAULT_BUFFER_SIZE, true);
     if(textOutput) {
         std::cout << "Writing Suffix Array as Text..." << std::endl;
-        stool::FileWriter::write_vector_as_text(outputFile, sa);
+        for (uint64_t i = 0; i < sa.size(); i++) {
+            writer.push_back_as_text(sa[i]);
+        }
     }else{
         std::cout << "Writing Suffix Array..." << std::endl;
-        stool::FileWriter::write_vector(outputFile, sa);
+        for (uint64_t i = 0; i < sa.size(); i++) {
+            writer.push_back<uint64_t>(sa[i]);
+        }
+    }
+    writer.close();
+}
+
+template <typename T>
+void mainfunc_external_memory(std::string input, std::string outputFile, uint64_t memory_limit_mb, std::string tmp_dir)
+{
+    auto start = std::chrono::system_clock::now();
+    uint64_t n = stool::ExternalSuffixArrayConstructor::construct<T>(input, outputFile, memory_limit_mb * 1024 * 1024, tmp_dir);
+    auto end = std::chrono::system_clock::now();
+    double elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    std::cout << "\033[36m";
+    std::cout << "=============RESULT===============" << std::endl;
+    std::cout << "File : " << input << std::endl;
+    std::cout << "Output file : " << outputFile << std::endl;
+    std::cout << "The length of the input text : " << n << std::endl;
+    std::cout << "Memory limit : " << memory_limit_mb << "MB" << std::endl;
+    double charperms = (double)n / elapsed;
+    std::cout << "Excecution time : " << ((uint64_t)elapsed) << "ms";
+    std::cout << "[" << charperms << "chars/ms]" << std::endl;
+#if defined(__linux__) || defined(__APPLE__)
+    std::cout << "Peak RSS : " << (stool::Memory::getPeakRSS() / (1024 * 1024)) << "MB" << std::endl;
+#endif
+    std::cout << "==================================" << std::endl;
+    std::cout << "\033[39m" << std::endl;
+}
+
+template <typename T>
+void mainfunc(std::string input, std::string outputFile, bool textOutput, uint64_t thread_count, bool lowMemory, bool packedOutput)
+{
+    auto start = std::chrono::system_clock::now();
+
+
+    std::cout << "Mapping Text..." << std::endl;
+    stool::MappedVector<T> text = stool::FileReader::map_vector<T>(input);
+
+    // The narrowest index type is used during the construction; the output file always stores 64-bit integers.
+    if (text.size() + 1 < UINT32_MAX)
+    {
+        construct_and_write_suffix_array<T, uint32_t>(text, outputFile, textOutput, thread_count, lowMemory, packedOutput);
+    }
+    else if (text.size() + 1 < stool::UInt40::MAX_VALUE)
+    {
+        construct_and_write_suffix_array<T, stool::UInt40>(text, outputFile, textOutput, thread_count, lowMemory, packedOutput);
+    }
+    else
+    {
+        construct_and_write_suffix_array<T, uint64_t>(text, outputFile, textOutput, thread_count, lowMemory, packedOutput);
     }
 
     auto end = std::chrono::system_clock::now();
@@ -40,10 +103,26 @@ void mainfunc(std::string input, std::string outputFile, bool textOutput)
     //std::cout << "The number of RLBWT : " << rlbwt.size() << std::endl;
     std::cout << "Excecution time : " << ((uint64_t)elapsed) << "ms";
     std::cout << "[" << charperms << "chars/ms]" << std::endl;
+#if defined(__linux__) || defined(__APPLE__)
+    std::cout << "Peak RSS : " << (stool::Memory::getPeakRSS() / (1024 * 1024)) << "MB" << std::endl;
+#endif
     std::cout << "==================================" << std::endl;
     std::cout << "\033[39m" << std::endl;
 }
 
+template <typename T>
+void run(std::string input, std::string outputFile, bool textOutput, uint64_t thread_count, bool lowMemory, uint64_t memory_limit_mb, std::string tmp_dir, bool packedOutput)
+{
+    if (memory_limit_mb > 0)
+    {
+        mainfunc_external_memory<T>(input, outputFile, memory_limit_mb, tmp_dir);
+    }
+    else
+    {
+        mainfunc<T>(input, outputFile, textOutput, thread_count, lowMemory, packedOutput);
+    }
+}
+
 int main(int argc, char *argv[])
 {
 
@@ -63,8 +142,13 @@ int main(int argc, char *argv[])
     p.add<std::string>("input_file", 'i', "input file path", true);
     p.add<std::string>("output_file", 'o', "output bwt file path", false, "");
     p.add<bool>("text_output", 't', "output text file", false, false);
+    p.add<bool>("packed_output", 'k', "output a self-describing bit-packed file", false, false);
     //p.add<int64_t>("special_character", 's', "special character", false, 0);
     p.add<std::string>("char_type", 'c', "char_type", true, "uint8_t");
+    p.add<uint64_t>("threads", 'p', "the number of threads", false, 1);
+    p.add<bool>("low_memory", 'l', "use the low-workspace SA-IS (single-threaded)", false, false);
+    p.add<uint64_t>("memory_limit", 'm', "construct the suffix array on disk within the given memory (MB); 0 means in-memory construction", false, 0);
+    p.add<std::string>("tmp_dir", 'd', "the directory for temporary files of the on-disk construction", false, ".");
 
     p.parse_check(argc, argv);
     std::string inputFile = p.get<std::string>("input_file");
@@ -72,43 +156,64 @@ int main(int argc, char *argv[])
     //int64_t specialCharacter = p.get<int64_t>("special_character");
     std::string char_type = p.get<std::string>("char_type");
     bool textOutput = p.get<bool>("text_output");
+    bool packedOutput = p.get<bool>("packed_output");
+    uint64_t thread_count = p.get<uint64_t>("threads");
+    bool lowMemory = p.get<bool>("low_memory");
+    uint64_t memory_limit_mb = p.get<uint64_t>("memory_limit");
+    std::string tmp_dir = p.get<std::string>("tmp_dir");
     
     if (outputFile.size() == 0)
     {
         outputFile = inputFile + ".sa";
     }
+    if (textOutput && packedOutput)
+    {
+        throw std::runtime_error("text_output and packed_output cannot be used together");
+    }
+    if (memory_limit_mb > 0 && (textOutput || packedOutput))
+    {
+        throw std::runtime_error("text_output and packed_output are not supported by the on-disk construction (memory_limit > 0)");
+    }
+    if (lowMemory && thread_count > 1)
+    {
+        throw std::runtime_error("low_memory runs on a single thread and cannot be used with threads > 1");
+    }
+    if (lowMemory && memory_limit_mb > 0)
+    {
+        throw std::runtime_error("low_memory cannot be used with the on-disk construction (memory_limit > 0)");
+    }
 
     if (char_type == "uint8_t")
     {
-        mainfunc<uint8_t>(inputFile, outputFile, textOutput);
+        run<uint8_t>(inputFile, outputFile, textOutput, thread_count, lowMemory, memory_limit_mb, tmp_dir, packedOutput);
     }
     else if (char_type == "uint16_t")
     {
-        mainfunc<uint16_t>(inputFile, outputFile, textOutput);
+        run<uint16_t>(inputFile, outputFile, textOutput, thread_count, lowMemory, memory_limit_mb, tmp_dir, packedOutput);
     }
     else if (char_type == "uint32_t")
     {
-        mainfunc<uint32_t>(inputFile, outputFile, textOutput);
+        run<uint32_t>(inputFile, outputFile, textOutput, thread_count, lowMemory, memory_limit_mb, tmp_dir, packedOutput);
     }
     else if (char_type == "uint64_t")
     {
-        mainfunc<uint64_t>(inputFile, outputFile, textOutput);
+        run<uint64_t>(inputFile, outputFile, textOutput, thread_count, lowMemory, memory_limit_mb, tmp_dir, packedOutput);
     }
     else if (char_type == "int8_t")
     {
-        mainfunc<int8_t>(inputFile, outputFile, textOutput);
+        run<int8_t>(inputFile, outputFile, textOutput, thread_count, lowMemory, memory_limit_mb, tmp_dir, packedOutput);
     }
     else if (char_type == "int16_t")
     {
-        mainfunc<int16_t>(inputFile, outputFile, textOutput);
+        run<int16_t>(inputFile, outputFile, textOutput, thread_count, lowMemory, memory_limit_mb, tmp_dir, packedOutput);
     }
     else if (char_type == "int32_t")
     {
-        mainfunc<int32_t>(inputFile, outputFile, textOutput);
+        run<int32_t>(inputFile, outputFile, textOutput, thread_count, lowMemory, memory_limit_mb, tmp_dir, packedOutput);
     }
     else if (char_type == "int64_t")
     {
-        mainfunc<int64_t>(inputFile, outputFile, textOutput);
+        run<int64_t>(inputFile, outputFile, textOutput, thread_count, lowMemory, memory_limit_mb, tmp_dir, packedOutput);
     }
     else
     {
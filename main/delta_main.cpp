@@ -6,25 +6,47 @@
 
 
 
+void print_estimate(const stool::DeltaEstimator::DeltaEstimate &estimate)
+{
+    std::cout << "Estimated delta   \t : " << estimate.delta << " [" << estimate.lower_bound << ", " << estimate.upper_bound << "]" << std::endl;
+    std::cout << "Estimated length  \t : " << estimate.length << std::endl;
+}
+
+void estimate_func(std::string input, uint64_t sketch_size, uint64_t thread_count)
+{
+    auto start = std::chrono::system_clock::now();
+    stool::DeltaEstimator::DeltaEstimate estimate = stool::DeltaEstimator::estimate_delta_from_file(input, stool::DeltaEstimator::get_default_lengths(), sketch_size, thread_count);
+    auto end = std::chrono::system_clock::now();
+    double elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    std::cout << "\033[32m";
+    std::cout << "______________________INFO______________________" << std::endl;
+    std::cout << "File name         \t : " << input << std::endl;
+    std::cout << "Text length       \t : " << stool::OnlineFileReader::get_text_size(input) << std::endl;
+    print_estimate(estimate);
+    std::cout << "Excecution time   \t : " << ((uint64_t)elapsed) << "ms" << std::endl;
+    std::cout << "_______________________________________________________" << std::endl;
+    std::cout << "\033[39m" << std::endl;
+}
+
 template <typename T>
-void mainfunc(std::string input, std::string output)
+void mainfunc(std::string input, std::string output, uint64_t thread_count, uint64_t sketch_size)
 {
     auto start = std::chrono::system_clock::now();
 
-    std::vector<T> text;
-    std::cout << "Loading Text..." << std::endl;
-    stool::FileReader::load_vector(input, text);
+    std::cout << "Mapping Text..." << std::endl;
+    stool::MappedVector<T> text = stool::FileReader::map_vector<T>(input);
 
     std::cout << "Constructing Suffix Array..." << std::endl;
-    std::vector<uint64_t> sa = stool::sais_suffix_array(text);
-    std::vector<uint64_t> lcp_array = stool::ArrayConstructor::construct_LCP_array(text, sa);
+    std::vector<uint64_t> sa = stool::parallel_sais_suffix_array(text, thread_count);
+    std::vector<uint64_t> lcp_statistics = stool::ArrayConstructor::compute_LCP_statistics(text, sa, stool::Message::SHOW_MESSAGE, thread_count);
 
-    uint64_t max_lcp = *std::max_element(lcp_array.begin(), lcp_array.end());
+    uint64_t max_lcp = lcp_statistics.size() - 1;
 
     std::cout << "Computing delta..." << std::flush;
-    std::vector<uint64_t> distinct_substring_counter_array = stool::SubstringComplexityFunctions::construct_distinct_substring_counter_array(lcp_array);
+    std::vector<uint64_t> distinct_substring_counter_array = stool::SubstringComplexityFunctions::construct_distinct_substring_counter_array_from_lcp_statistics(lcp_statistics, text.size());
     std::vector<uint64_t> delta_array;
-    for (uint64_t i = 1; i <= distinct_substring_counter_array.size(); i++){
+    for (uint64_t i = 1; i < distinct_substring_counter_array.size(); i++){
         uint64_t i_delta = distinct_substring_counter_array[i] / i;
         delta_array.push_back(i_delta);
     }
@@ -54,6 +76,12 @@ void mainfunc(std::string input, std::string output)
 
     std::cout << "[END]" << std::endl;
     auto end = std::chrono::system_clock::now();
+
+    stool::DeltaEstimator::DeltaEstimate estimate{0, 0, 0, 0};
+    if (sketch_size > 0)
+    {
+        estimate = stool::DeltaEstimator::estimate_delta_from_file(input, stool::DeltaEstimator::get_default_lengths(), sketch_size, thread_count);
+    }
     double elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
 
     std::cout << "\033[32m";
@@ -61,8 +89,12 @@ void mainfunc(std::string input, std::string output)
     std::cout << "File name         \t : " << input << std::endl;
     std::cout << "Text length       \t : " << text.size() << std::endl;
     std::cout << "Delta             \t : " << max_delta << std::endl;
-    std::cout << "Delta position    \t : " << delta_position << std::endl;
+    std::cout << "Delta length      \t : " << (delta_position + 1) << std::endl;
     std::cout << "Max LCP           \t : " << max_lcp << std::endl;
+    if (sketch_size > 0)
+    {
+        print_estimate(estimate);
+    }
     double charperms = (double)text.size() / elapsed;
     //std::cout << "The number of RLBWT : " << rlbwt.size() << std::endl;
     std::cout << "Excecution time   \t : " << ((uint64_t)elapsed) << "ms";
@@ -92,11 +124,17 @@ int main(int argc, char *argv[])
     p.add<std::string>("output_file", 'o', "output file path", false);
 
     p.add<std::string>("char_type", 'c', "char_type", true, "uint8_t");
+    p.add<uint64_t>("threads", 'p', "the number of threads", false, 1);
+    p.add<uint64_t>("sketch_size", 's', "the sketch size of the estimation of delta (0: no estimation)", false, 0);
+    p.add<bool>("estimate_only", 'e', "estimate delta without the suffix array (uint8_t only)", false, false);
 
     p.parse_check(argc, argv);
     std::string inputFile = p.get<std::string>("input_file");
     std::string outputFile = p.get<std::string>("output_file");
     std::string char_type = p.get<std::string>("char_type");
+    uint64_t thread_count = p.get<uint64_t>("threads");
+    uint64_t sketch_size = p.get<uint64_t>("sketch_size");
+    bool estimate_only = p.get<bool>("estimate_only");
 
     /*
     if (outputFile.size() == 0)
@@ -105,37 +143,46 @@ int main(int argc, char *argv[])
     }
     */
 
-    if (char_type == "uint8_t")
+    if ((sketch_size > 0 || estimate_only) && char_type != "uint8_t")
+    {
+        throw std::runtime_error("The estimation of delta supports only uint8_t");
+    }
+
+    if (estimate_only)
+    {
+        estimate_func(inputFile, sketch_size > 0 ? sketch_size : stool::DeltaEstimator::DEFAULT_SKETCH_SIZE, thread_count);
+    }
+    else if (char_type == "uint8_t")
     {
-        mainfunc<uint8_t>(inputFile, outputFile);
+        mainfunc<uint8_t>(inputFile, outputFile, thread_count, sketch_size);
     }
     else if (char_type == "uint16_t")
     {
-        mainfunc<uint16_t>(inputFile, outputFile);
+        mainfunc<uint16_t>(inputFile, outputFile, thread_count, sketch_size);
     }
     else if (char_type == "uint32_t")
     {
-        mainfunc<uint32_t>(inputFile, outputFile);
+        mainfunc<uint32_t>(inputFile, outputFile, thread_count, sketch_size);
     }
     else if (char_type == "uint64_t")
     {
-        mainfunc<uint64_t>(inputFile, outputFile);
+        mainfunc<uint64_t>(inputFile, outputFile, thread_count, sketch_size);
     }
     else if (char_type == "int8_t")
     {
-        mainfunc<int8_t>(inputFile, outputFile);
+        mainfunc<int8_t>(inputFile, outputFile, thread_count, sketch_size);
     }
     else if (char_type == "int16_t")
     {
-        mainfunc<int16_t>(inputFile, outputFile);
+        mainfunc<int16_t>(inputFile, outputFile, thread_count, sketch_size);
     }
     else if (char_type == "int32_t")
     {
-        mainfunc<int32_t>(inputFile, outputFile);
+        mainfunc<int32_t>(inputFile, outputFile, thread_count, sketch_size);
     }
     else if (char_type == "int64_t")
     {
-        mainfunc<int64_t>(inputFile, outputFile);
+        mainfunc<int64_t>(inputFile, outputFile, thread_count, sketch_size);
     }
     else
     {
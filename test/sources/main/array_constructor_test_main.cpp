@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../../include/strings/sa_is.hpp"
+#include "../../../include/strings/array_constructor.hpp"
+#include "../../../include/strings/delta.hpp"
+#include "../../../include/io/file_writer.hpp"
+#include "../template/test_text.hpp"
+
+void test_parallel_constructions(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] ISA / LCP / DSA / BWT with several thread counts vs naive ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text(mt, t, max_len);
+        uint64_t n = text.size();
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        std::vector<uint64_t> lcp = stool::TestText::naive_lcp_array(text, sa);
+
+        std::vector<uint64_t> isa(n);
+        std::vector<int64_t> dsa(n);
+        std::vector<uint8_t> bwt(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            isa[sa[i]] = i;
+            dsa[i] = i == 0 ? (int64_t)sa[i] : (int64_t)sa[i] - (int64_t)sa[i - 1];
+            bwt[i] = sa[i] == 0 ? text[n - 1] : text[sa[i] - 1];
+        }
+
+        for ([[maybe_unused]] uint64_t thread_count : {1, 2, 3, 8})
+        {
+            assert(stool::ArrayConstructor::construct_ISA(sa, -1, thread_count) == isa);
+            assert(stool::ArrayConstructor::construct_LCP_array(text, sa, isa, -1, thread_count) == lcp);
+            assert(stool::ArrayConstructor::construct_LCP_array(text, sa, -1, thread_count) == lcp);
+            assert(stool::ArrayConstructor::construct_DSA(sa, -1, thread_count) == dsa);
+            assert(stool::ArrayConstructor::construct_BWT(text, sa, -1, thread_count) == bwt);
+        }
+    }
+
+    std::cout << "[OK] parallel construction test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_plcp_constructions(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] PLCP / compressed PLCP / LCP via PLCP vs naive ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text(mt, t, max_len);
+        uint64_t n = text.size();
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        std::vector<uint64_t> lcp = stool::TestText::naive_lcp_array(text, sa);
+        std::vector<uint64_t> plcp(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            plcp[sa[i]] = lcp[i];
+        }
+
+        for (uint64_t thread_count : {1, 2, 3, 8})
+        {
+            assert(stool::ArrayConstructor::construct_PLCP_array(text, sa, -1, thread_count) == plcp);
+            assert(stool::ArrayConstructor::construct_LCP_array_by_PLCP(text, sa, -1, thread_count) == lcp);
+
+            stool::CompressedPLCPArray compressed_plcp = stool::ArrayConstructor::construct_compressed_PLCP_array(text, sa, -1, thread_count);
+            assert(compressed_plcp.size() == n);
+            for (uint64_t i = 0; i < n; ++i)
+            {
+                assert(compressed_plcp[i] == plcp[i]);
+            }
+        }
+
+        std::vector<uint32_t> sa32(sa.begin(), sa.end());
+        std::vector<uint32_t> lcp32 = stool::ArrayConstructor::construct_LCP_array_by_PLCP<std::vector<uint8_t>, uint32_t>(text, sa32, -1, 2);
+        assert(std::equal(lcp32.begin(), lcp32.end(), lcp.begin(), lcp.end()));
+    }
+
+    std::cout << "[OK] PLCP construction test passed (" << trials << " trials)" << std::endl;
+}
+
+// Highly repetitive texts: a unary text, a Fibonacci word, and a periodic text with a few mutations.
+std::vector<uint8_t> create_repetitive_text(std::mt19937_64 &mt, uint64_t t, uint64_t max_len)
+{
+    uint64_t n = 1 + (mt() % max_len);
+    std::vector<uint8_t> text;
+    if (t % 3 == 0)
+    {
+        text.assign(n, 'a');
+    }
+    else if (t % 3 == 1)
+    {
+        std::vector<uint8_t> a = {'a'}, b = {'a', 'b'};
+        while (b.size() < n)
+        {
+            std::vector<uint8_t> c = b;
+            c.insert(c.end(), a.begin(), a.end());
+            a.swap(b);
+            b.swap(c);
+        }
+        text.assign(b.begin(), b.begin() + n);
+    }
+    else
+    {
+        uint64_t period = 1 + (mt() % 100);
+        text.resize(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            text[i] = i >= period && mt() % 500 != 0 ? text[i - period] : (uint8_t)(mt() % 4);
+        }
+    }
+    return text;
+}
+
+void test_lcp_statistics(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] LCP statistics by sparse Phi vs the histogram of the naive LCP array ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    std::string sa_path = "array_constructor_test.sa";
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = t % 2 == 0 ? create_repetitive_text(mt, t / 2, max_len) : stool::TestText::create_test_text(mt, t, max_len);
+        if (text.size() == 0)
+        {
+            text.push_back('a');
+        }
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        std::vector<uint64_t> lcp = stool::TestText::naive_lcp_array(text, sa);
+        std::vector<uint64_t> expected = stool::SubstringComplexityFunctions::compute_LCP_statistics(lcp);
+        std::vector<uint64_t> expected_dsca = stool::SubstringComplexityFunctions::construct_distinct_substring_counter_array(lcp);
+
+        std::vector<uint32_t> sa32(sa.begin(), sa.end());
+        stool::FileWriter::write_vector(sa_path, sa);
+        stool::MappedVector<uint64_t> mapped_sa(sa_path);
+        for ([[maybe_unused]] uint64_t thread_count : {1, 2, 3, 8})
+        {
+            assert(stool::ArrayConstructor::compute_LCP_statistics(text, sa, -1, thread_count) == expected);
+            assert((stool::ArrayConstructor::compute_LCP_statistics<std::vector<uint8_t>, uint32_t>(text, sa32, -1, thread_count) == expected));
+            assert(stool::ArrayConstructor::compute_LCP_statistics(text, mapped_sa, -1, thread_count) == expected);
+            assert(stool::SubstringComplexityFunctions::construct_distinct_substring_counter_array(text, sa, -1, thread_count) == expected_dsca);
+        }
+    }
+    std::remove(sa_path.c_str());
+
+    std::cout << "[OK] LCP statistics test passed (" << trials << " trials)" << std::endl;
+}
+
+int main()
+{
+    std::cout << "\033[34mTest: ArrayConstructor\033[0m" << std::endl;
+    test_parallel_constructions(200, 3000, 5005);
+    test_plcp_constructions(200, 3000, 6006);
+    test_lcp_statistics(200, 3000, 2101);
+    std::cout << "All ArrayConstructor tests passed!" << std::endl;
+    return 0;
+}
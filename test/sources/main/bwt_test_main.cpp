@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../../include/strings/sa_is.hpp"
+#include "../../../include/basic/parallel_functions.hpp"
+#include "../../../include/bwt/parallel_lf_walk.hpp"
+#include "../../../include/bwt/backward_isa.hpp"
+#include "../../../include/bwt/bwt_inversion.hpp"
+#include "../../../include/strings/array_constructor.hpp"
+#include "../../../include/bwt/bwt_functions.hpp"
+#include "../template/test_text.hpp"
+
+// An LF data structure that stores LF as a plain array.
+struct NaiveLF
+{
+    using INDEX = uint64_t;
+    std::vector<uint64_t> lf_array;
+
+    uint64_t lf(uint64_t i) const
+    {
+        return this->lf_array[i];
+    }
+};
+
+// Reference implementation: LF(i) = ISA[SA[i] - 1] (cyclically).
+NaiveLF create_naive_lf(const std::vector<uint64_t> &sa, const std::vector<uint64_t> &isa)
+{
+    uint64_t n = sa.size();
+    NaiveLF lfds;
+    lfds.lf_array.resize(n);
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        lfds.lf_array[i] = isa[sa[i] == 0 ? n - 1 : sa[i] - 1];
+    }
+    return lfds;
+}
+
+void test_parallel_lf_walk(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] ParallelLFWalk and BackwardISA::to_isa vs the suffix array ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text_with_end_marker(mt, t, max_len);
+        uint64_t n = text.size();
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        std::vector<uint64_t> isa(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            isa[sa[i]] = i;
+        }
+        NaiveLF lfds = create_naive_lf(sa, isa);
+        uint64_t end_marker_position = isa[0];
+
+        for (uint64_t thread_count : {1, 2, 3, 8})
+        {
+            // Fewer checkpoints than threads, one checkpoint per position, and the default.
+            for (uint64_t checkpoint_count : {(uint64_t)1, thread_count, n, 1 + (mt() % (n + 10))})
+            {
+                std::vector<stool::bwt::ParallelLFWalk::Checkpoint> checkpoints = stool::bwt::ParallelLFWalk::compute_checkpoints(lfds, end_marker_position, n, checkpoint_count, thread_count);
+                assert(checkpoints.size() > 0);
+                assert(checkpoints[0].text_position == 0 && checkpoints[0].bwt_position == end_marker_position);
+                for ([[maybe_unused]] auto &cp : checkpoints)
+                {
+                    assert(sa[cp.bwt_position] == cp.text_position);
+                }
+
+                // Every suffix is reported once.
+                std::vector<uint64_t> visits(n, 0);
+                stool::bwt::ParallelLFWalk::walk(lfds, checkpoints, n, thread_count, [&]([[maybe_unused]] uint64_t thread_id, uint64_t text_position, [[maybe_unused]] uint64_t bwt_position)
+                                                 {
+                                                     assert(thread_id < thread_count);
+                                                     assert(sa[bwt_position] == text_position);
+                                                     visits[text_position]++; });
+                assert(std::count(visits.begin(), visits.end(), 1) == (int64_t)n);
+            }
+
+            std::vector<uint64_t> visits(n, 0);
+            stool::bwt::ParallelLFWalk::walk(lfds, end_marker_position, n, thread_count, [&](uint64_t, uint64_t text_position, [[maybe_unused]] uint64_t bwt_position)
+                                             {
+                                                 assert(sa[bwt_position] == text_position);
+                                                 visits[text_position]++; });
+            assert(std::count(visits.begin(), visits.end(), 1) == (int64_t)n);
+
+            stool::bwt::BackwardISA<NaiveLF> backward_isa;
+            backward_isa.set(&lfds, end_marker_position, n);
+            assert(backward_isa.to_isa(thread_count) == isa);
+        }
+
+        // An LF function with two cycles is not the LF function of a BWT.
+        if (n >= 2)
+        {
+            NaiveLF invalid_lfds;
+            invalid_lfds.lf_array.resize(n);
+            for (uint64_t i = 0; i < n; ++i)
+            {
+                invalid_lfds.lf_array[i] = i;
+            }
+            [[maybe_unused]] bool rejected = false;
+            try
+            {
+                stool::bwt::ParallelLFWalk::compute_checkpoints(invalid_lfds, 0, n, 4, 2);
+            }
+            catch (const std::runtime_error &)
+            {
+                rejected = true;
+            }
+            assert(rejected);
+        }
+    }
+
+    std::cout << "[OK] ParallelLFWalk test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_parallel_radix_sort(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] parallel_radix_sort vs std::stable_sort ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = t == 0 ? 0 : mt() % (max_len + 1);
+        // Keys of zero, one, several and eight bytes.
+        uint64_t max_key = t % 5 == 0 ? 0 : (t % 5 == 1 ? UINT64_MAX : (1ULL << (mt() % 64)) + (mt() % 1000));
+        std::vector<std::pair<uint64_t, uint64_t>> items(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            uint64_t k = mt();
+            items[i] = std::make_pair(max_key == UINT64_MAX ? k : k % (max_key + 1), i);
+        }
+        std::vector<std::pair<uint64_t, uint64_t>> expected = items;
+        std::stable_sort(expected.begin(), expected.end(), [](const auto &a, const auto &b)
+                         { return a.first < b.first; });
+
+        for (uint64_t thread_count : {1, 2, 3, 8})
+        {
+            std::vector<std::pair<uint64_t, uint64_t>> sorted = items;
+            stool::ParallelFunctions::parallel_radix_sort(sorted, [](const std::pair<uint64_t, uint64_t> &item)
+                                                          { return item.first; }, max_key, thread_count);
+            assert(sorted == expected);
+        }
+    }
+
+    std::cout << "[OK] parallel_radix_sort test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_bwt_inversion(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] BWTInversion vs the BWT by ArrayConstructor ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        // Every character of 1..sigma occurs, so sigma = 255 gives 256 distinct characters with the end marker.
+        uint64_t sigma = std::vector<uint64_t>{2, 4, 200, 255}[t % 4];
+        uint64_t n = sigma + (mt() % (max_len + 1));
+        uint64_t period = 1 + (mt() % 300);
+        std::vector<uint8_t> text(n + 1, 0);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            text[i] = i < sigma ? (uint8_t)(i + 1) : ((t % 3 == 2 && i >= period) ? text[i - period] : (uint8_t)(1 + (mt() % sigma)));
+        }
+        std::shuffle(text.begin(), text.begin() + sigma, mt);
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        std::vector<uint8_t> bwt = stool::ArrayConstructor::construct_BWT(text, sa, -1, 1);
+
+        for ([[maybe_unused]] uint64_t thread_count : {1, 2, 3, 8})
+        {
+            for ([[maybe_unused]] uint64_t stream_count : {1, 4, 16})
+            {
+                assert(stool::bwt::BWTInversion::invert(bwt, stream_count, thread_count) == text);
+            }
+        }
+    }
+
+    // An LF function with a cycle that contains no starting position of the chains: the BWT of T$ followed by the BWT of the rotations of 3 4^(m-1).
+    for (uint64_t thread_count : {1, 2})
+    {
+        std::vector<uint8_t> text(2000, 1);
+        for (uint64_t i = 0; i + 1 < text.size(); ++i)
+        {
+            text[i] = (uint8_t)(1 + (mt() % 2));
+        }
+        text.back() = 0;
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        std::vector<uint8_t> invalid_bwt = stool::ArrayConstructor::construct_BWT(text, sa, -1, 1);
+        invalid_bwt.insert(invalid_bwt.end(), 49, 4);
+        invalid_bwt.push_back(3);
+        [[maybe_unused]] bool rejected = false;
+        try
+        {
+            stool::bwt::BWTInversion::invert(invalid_bwt, 1, thread_count);
+        }
+        catch (const std::runtime_error &)
+        {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+
+    std::cout << "[OK] BWTInversion test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_bwt_functions(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] BWTFunctions counting, C arrays and LF/FL arrays vs naive ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    using BWTFunctions = stool::bwt::BWTFunctions;
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text_with_end_marker(mt, t, max_len);
+        uint64_t n = text.size();
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        std::vector<uint8_t> bwt = stool::ArrayConstructor::construct_BWT(text, sa, -1, 1);
+
+        std::vector<uint64_t> counts(256, 0);
+        for (uint8_t c : bwt)
+        {
+            counts[c]++;
+        }
+        std::vector<uint64_t> C(256, 0);
+        for (uint64_t c = 1; c < 256; ++c)
+        {
+            C[c] = C[c - 1] + counts[c - 1];
+        }
+        std::vector<uint64_t> lf(n), fl(n);
+        std::vector<uint64_t> ranks(256, 0);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            lf[i] = C[bwt[i]] + ranks[bwt[i]]++;
+            fl[lf[i]] = i;
+        }
+
+        // Unaligned starts and lengths that are not multiples of 8.
+        uint64_t offset = mt() % std::min(n, (uint64_t)8);
+        std::vector<uint64_t> partial_counts(256, 0);
+        for (uint64_t i = offset; i < n; ++i)
+        {
+            partial_counts[bwt[i]]++;
+        }
+        std::vector<uint64_t> added_counts(256, 1);
+        BWTFunctions::count_characters(bwt.data() + offset, n - offset, added_counts.data());
+        for (uint64_t c = 0; c < 256; ++c)
+        {
+            assert(added_counts[c] == partial_counts[c] + 1);
+        }
+
+        sdsl::int_vector<> packed_bwt(n, 0, 8);
+        sdsl::int_vector<> wide_bwt(n, 0, 16);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            packed_bwt[i] = bwt[i];
+            wide_bwt[i] = bwt[i];
+        }
+
+        for (uint64_t thread_count : {1, 2, 3, 8})
+        {
+            assert(BWTFunctions::count_characters(bwt.data() + offset, n - offset, thread_count) == partial_counts);
+
+            std::vector<uint64_t> C1, C2, C3;
+            BWTFunctions::construct_C_array(bwt, C1, stool::Message::NO_MESSAGE, thread_count);
+            BWTFunctions::construct_C_array(packed_bwt, C2, stool::Message::NO_MESSAGE, thread_count);
+            BWTFunctions::construct_C_array(wide_bwt, C3, stool::Message::NO_MESSAGE, thread_count);
+            assert(C1 == C && C2 == C && C3 == C);
+
+            assert(BWTFunctions::construct_LF_array(bwt, C, stool::Message::NO_MESSAGE, thread_count) == lf);
+            std::vector<uint32_t> lf32 = BWTFunctions::construct_LF_array<uint32_t>(bwt, C, stool::Message::NO_MESSAGE, thread_count);
+            assert(std::equal(lf32.begin(), lf32.end(), lf.begin(), lf.end()));
+            assert(BWTFunctions::construct_FL_array(bwt, lf, stool::Message::NO_MESSAGE, thread_count) == fl);
+            std::vector<uint32_t> fl32 = BWTFunctions::construct_FL_array<uint32_t>(bwt, lf32, stool::Message::NO_MESSAGE, thread_count);
+            assert(std::equal(fl32.begin(), fl32.end(), fl.begin(), fl.end()));
+        }
+
+        // A BWT longer than 256 does not fit in 8-bit LF values.
+        if (n > 256)
+        {
+            [[maybe_unused]] bool rejected = false;
+            try
+            {
+                BWTFunctions::construct_LF_array<uint8_t>(bwt, C, stool::Message::NO_MESSAGE, 2);
+            }
+            catch (const std::runtime_error &)
+            {
+                rejected = true;
+            }
+            assert(rejected);
+        }
+
+        // The wavelet tree versions count BWT[0..n-2] and the given last character.
+        sdsl::wt_huff<> wt;
+        construct_im(wt, packed_bwt);
+        uint8_t last_char = t % 10 == 0 ? 8 : (uint8_t)(1 + (mt() % 255));
+        std::vector<uint64_t> wt_counts(256, 0);
+        for (uint64_t i = 0; i + 1 < n; ++i)
+        {
+            wt_counts[bwt[i]]++;
+        }
+        wt_counts[last_char]++;
+        std::vector<uint64_t> wt_C(256, 0);
+        for (uint64_t c = 1; c < 256; ++c)
+        {
+            wt_C[c] = wt_C[c - 1] + wt_counts[c - 1];
+        }
+        std::vector<uint64_t> C4;
+        BWTFunctions::construct_C_array(wt, last_char, C4);
+        assert(C4 == wt_C);
+
+        // The frequency array counts all the characters, adds one occurrence of last_char (unless it is 0) and ignores the character 8 (unless it is last_char).
+        std::vector<uint64_t> frequencies;
+        BWTFunctions::construct_frequency_array(wt, last_char, frequencies);
+        for (uint64_t c = 0; c < 256; ++c)
+        {
+            [[maybe_unused]] uint64_t expected = c == 0 ? counts[c] : (c == last_char ? counts[c] + 1 : (c == 8 ? 0 : counts[c]));
+            assert(frequencies[c] == expected);
+        }
+    }
+
+    std::cout << "[OK] BWTFunctions test passed (" << trials << " trials)" << std::endl;
+}
+
+int main()
+{
+    std::cout << "\033[34mTest: BWT\033[0m" << std::endl;
+    test_parallel_lf_walk(100, 3000, 1801);
+    test_parallel_radix_sort(200, 20000, 1802);
+    test_bwt_inversion(40, 20000, 1901);
+    test_bwt_functions(100, 5000, 2001);
+    std::cout << "All BWT tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../../include/strings/sa_is.hpp"
+#include "../../../include/strings/delta_estimator.hpp"
+#include "../../../include/io/file_writer.hpp"
+#include "../template/test_text.hpp"
+
+// Reference implementation: d_k is the number of the suffixes of length at least k whose LCP with the previous suffix is less than k.
+std::vector<uint64_t> naive_distinct_substring_counts(const std::vector<uint8_t> &text, const std::vector<uint64_t> &lengths)
+{
+    uint64_t n = text.size();
+    std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+    std::vector<uint64_t> lcp = stool::TestText::naive_lcp_array(text, sa);
+    std::vector<uint64_t> r;
+    for (uint64_t k : lengths)
+    {
+        uint64_t count = 0;
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            if (n - sa[i] >= k && lcp[i] < k)
+            {
+                count++;
+            }
+        }
+        r.push_back(count);
+    }
+    return r;
+}
+
+void test_exact_delta(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] DeltaEstimator with sketches holding every value vs the exact delta ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    std::vector<uint64_t> lengths = stool::DeltaEstimator::get_default_lengths();
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text(mt, t, max_len, 1);
+        std::vector<uint64_t> counts = naive_distinct_substring_counts(text, lengths);
+        double delta = 0;
+        for (uint64_t x = 0; x < lengths.size(); ++x)
+        {
+            delta = std::max(delta, (double)counts[x] / (double)lengths[x]);
+        }
+
+        for (uint64_t thread_count : {1, 3})
+        {
+            stool::DeltaEstimator estimator(lengths, stool::DeltaEstimator::DEFAULT_SKETCH_SIZE, thread_count, t);
+            estimator.add_text(text);
+            std::vector<stool::DeltaEstimator::Estimate> estimates = estimator.get_estimates();
+            assert(estimates.size() == lengths.size());
+            for (uint64_t x = 0; x < lengths.size(); ++x)
+            {
+                assert(estimates[x].is_exact);
+                assert(estimates[x].count == (double)counts[x]);
+            }
+            [[maybe_unused]] stool::DeltaEstimator::DeltaEstimate estimate = stool::DeltaEstimator::compute_delta(estimates);
+            assert(estimate.delta == delta);
+            assert(estimate.lower_bound == delta);
+            assert(estimate.upper_bound == delta);
+        }
+    }
+
+    std::cout << "[OK] exact delta test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_estimated_delta(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] DeltaEstimator with small sketches vs the exact delta ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    std::vector<uint64_t> lengths = stool::DeltaEstimator::get_default_lengths();
+    std::string text_path = "delta_test.txt";
+    uint64_t sketch_size = 512;
+    // The relative standard error of an estimated count is about 1/sqrt(K-2); five of them are allowed.
+    [[maybe_unused]] double tolerance = 5.0 / std::sqrt((double)(sketch_size - 2));
+    uint64_t estimated_count = 0;
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text(mt, t, max_len, 1);
+        std::vector<uint64_t> counts = naive_distinct_substring_counts(text, lengths);
+        double delta = 0;
+        for (uint64_t x = 0; x < lengths.size(); ++x)
+        {
+            delta = std::max(delta, (double)counts[x] / (double)lengths[x]);
+        }
+
+        stool::DeltaEstimator estimator(lengths, sketch_size, 1 + (t % 4), t);
+        estimator.add_text(text);
+        std::vector<stool::DeltaEstimator::Estimate> estimates = estimator.get_estimates();
+        for (uint64_t x = 0; x < lengths.size(); ++x)
+        {
+            const stool::DeltaEstimator::Estimate &e = estimates[x];
+            assert(std::abs(e.count - (double)counts[x]) <= tolerance * (double)counts[x]);
+            assert(e.lower_bound <= e.count && e.count <= e.upper_bound);
+            if (!e.is_exact)
+            {
+                estimated_count++;
+            }
+        }
+        [[maybe_unused]] stool::DeltaEstimator::DeltaEstimate estimate = stool::DeltaEstimator::compute_delta(estimates);
+        assert(std::abs(estimate.delta - delta) <= tolerance * delta);
+
+        // The text streamed from a file is estimated as closely as the text in memory.
+        stool::FileWriter::write_vector(text_path, text);
+        [[maybe_unused]] stool::DeltaEstimator::DeltaEstimate file_estimate = stool::DeltaEstimator::estimate_delta_from_file(text_path, lengths, sketch_size, 2, -1);
+        assert(std::abs(file_estimate.delta - delta) <= tolerance * delta);
+    }
+    std::remove(text_path.c_str());
+    assert(estimated_count > 0);
+
+    std::cout << "[OK] estimated delta test passed (" << trials << " trials)" << std::endl;
+}
+
+int main()
+{
+    std::cout << "\033[34mTest: DeltaEstimator\033[0m" << std::endl;
+    test_exact_delta(100, 2000, 2201);
+    test_estimated_delta(60, 5000, 2202);
+    std::cout << "All DeltaEstimator tests passed!" << std::endl;
+    return 0;
+}
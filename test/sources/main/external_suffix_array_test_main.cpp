@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../../include/strings/sa_is.hpp"
+#include "../../../include/strings/external_suffix_array.hpp"
+#include "../../../include/io/external_sorter.hpp"
+#include "../../../include/io/file_reader.hpp"
+#include "../../../include/io/file_writer.hpp"
+
+void test_external_sorter(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] ExternalSorter vs std::sort ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = mt() % (max_len + 1);
+        uint64_t max_value = 1 + (mt() % ((t % 2 == 0) ? 10 : 1000000));
+        // 0 bytes gives the smallest buffer, so the elements are spread over many runs.
+        uint64_t memory_limit_bytes = t % 3 == 0 ? 0 : 1 + (mt() % 100000);
+
+        std::vector<uint64_t> values(n);
+        stool::ExternalSorter<uint64_t> sorter(".", memory_limit_bytes);
+        for (auto &v : values)
+        {
+            v = mt() % max_value;
+            sorter.push(v);
+        }
+        assert(sorter.size() == n);
+        std::sort(values.begin(), values.end());
+
+        std::vector<uint64_t> sorted;
+        sorter.sort_and_consume([&](uint64_t v)
+                                { sorted.push_back(v); });
+        assert(sorted == values);
+        assert(sorter.size() == 0);
+
+        // The sorter can be reused after sort_and_consume.
+        sorter.push(2);
+        sorter.push(1);
+        sorted.clear();
+        sorter.sort_and_consume([&](uint64_t v)
+                                { sorted.push_back(v); });
+        assert((sorted == std::vector<uint64_t>{1, 2}));
+    }
+
+    std::cout << "[OK] external sorter test passed (" << trials << " trials)" << std::endl;
+}
+
+template <class C>
+void check_external_memory(std::vector<C> &text, uint64_t memory_limit_bytes, std::string name = "external_suffix_array_test")
+{
+    std::string text_path = name + ".txt";
+    std::string sa_path = name + ".sa";
+    stool::FileWriter::write_vector(text_path, text);
+    stool::ExternalSuffixArrayConstructor::construct<C>(text_path, sa_path, memory_limit_bytes, ".", -1);
+
+    std::vector<uint64_t> sa;
+    stool::FileReader::load_vector(sa_path, sa);
+    assert(sa == stool::sais_suffix_array(text));
+    std::remove(text_path.c_str());
+    std::remove(sa_path.c_str());
+}
+
+void test_external_memory(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] ExternalSuffixArrayConstructor vs sais_suffix_array ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = mt() % (max_len + 1);
+        uint64_t sigma = 1 + (mt() % ((t % 2 == 0) ? 3 : 256));
+        uint64_t period = 1 + (mt() % 50);
+
+        std::vector<uint8_t> byte_text(n);
+        std::vector<int8_t> signed_text(n);
+        std::vector<uint32_t> int_text(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            // Periodic texts need many doubling rounds.
+            byte_text[i] = (t % 3 == 2 && i >= period) ? byte_text[i - period] : (uint8_t)(mt() % sigma);
+            signed_text[i] = (int8_t)byte_text[i];
+            int_text[i] = (t % 4 == 0) ? (uint32_t)(mt() % sigma) * 16777259U : (uint32_t)(mt() % sigma);
+        }
+        // A small memory limit forces the external sorter to create several runs.
+        check_external_memory(byte_text, 4096);
+        check_external_memory(signed_text, 4096);
+        check_external_memory(int_text, 1 << 20);
+    }
+
+    std::cout << "[OK] external memory test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_concurrent_external_memory(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] concurrent ExternalSuffixArrayConstructor calls sharing a tmp dir ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        // The calls write their temporary rank files to the same directory at the same time.
+        std::vector<std::vector<uint8_t>> texts(4);
+        for (std::vector<uint8_t> &text : texts)
+        {
+            text.resize(1 + (mt() % max_len));
+            for (uint8_t &c : text)
+            {
+                c = (uint8_t)(mt() % 4);
+            }
+        }
+        std::vector<std::thread> threads;
+        for (uint64_t x = 0; x < texts.size(); ++x)
+        {
+            threads.push_back(std::thread([&texts, x]()
+                                          { check_external_memory(texts[x], 4096, "external_suffix_array_test_" + std::to_string(x)); }));
+        }
+        for (std::thread &th : threads)
+        {
+            th.join();
+        }
+    }
+
+    std::cout << "[OK] concurrent external memory test passed (" << trials << " trials)" << std::endl;
+}
+
+int main()
+{
+    std::cout << "\033[34mTest: External Suffix Array\033[0m" << std::endl;
+    test_external_sorter(100, 20000, 3030);
+    test_external_memory(60, 5000, 6060);
+    test_concurrent_external_memory(10, 3000, 404);
+    std::cout << "All external suffix array tests passed!" << std::endl;
+    return 0;
+}
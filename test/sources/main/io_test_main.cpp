@@ -0,0 +1,179 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../../include/io/online_file_reader.hpp"
+#include "../../../include/io/file_reader.hpp"
+#include "../../../include/io/file_writer.hpp"
+#include "../../../include/io/streaming_file_writer.hpp"
+
+std::vector<uint8_t> create_random_bytes(std::mt19937_64 &mt, uint64_t n, uint64_t sigma)
+{
+    std::vector<uint8_t> bytes(n);
+    for (auto &c : bytes)
+    {
+        c = (uint8_t)(mt() % sigma);
+    }
+    return bytes;
+}
+
+void test_online_file_reader(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] OnlineFileReader with and without prefetching ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    std::string path = "io_test_online.txt";
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        // Empty files and files shorter than a chunk are included.
+        uint64_t n = t == 0 ? 0 : mt() % (max_len + 1);
+        std::vector<uint8_t> text = create_random_bytes(mt, n, 1 + (mt() % 256));
+        stool::FileWriter::write_vector(path, text);
+        uint64_t buffer_size = 1 + (mt() % 300);
+
+        for (bool prefetch : {false, true})
+        {
+            stool::OnlineFileReader reader(path, buffer_size, prefetch);
+            assert(reader.size() == n);
+            reader.open();
+            std::vector<uint8_t> read_text;
+            for (auto it = reader.begin(); it != reader.end(); ++it)
+            {
+                read_text.push_back(*it);
+            }
+            reader.close();
+            assert(read_text == text);
+
+            // Chunks are at most buffer_size bytes long and cover the file in order.
+            stool::OnlineFileReader chunk_reader(path, buffer_size, prefetch);
+            chunk_reader.open();
+            std::vector<uint8_t> chunk;
+            read_text.clear();
+            while (chunk_reader.read_next_chunk(chunk))
+            {
+                assert(chunk.size() > 0 && chunk.size() <= buffer_size);
+                read_text.insert(read_text.end(), chunk.begin(), chunk.end());
+            }
+            chunk_reader.close();
+            assert(read_text == text);
+        }
+
+        // A reader that is closed in the middle of the file stops its background thread.
+        stool::OnlineFileReader partial_reader(path, buffer_size, true);
+        partial_reader.open();
+        std::vector<uint8_t> chunk;
+        partial_reader.read_next_chunk(chunk);
+        partial_reader.close();
+
+        std::vector<bool> occurs(256, false);
+        for (uint8_t c : text)
+        {
+            occurs[c] = true;
+        }
+        std::vector<uint8_t> alphabet;
+        for (uint64_t c = 0; c < 256; ++c)
+        {
+            if (occurs[c])
+            {
+                alphabet.push_back(c);
+            }
+        }
+        assert(stool::OnlineFileReader::get_alphabet(path, buffer_size) == alphabet);
+    }
+    std::remove(path.c_str());
+
+    std::cout << "[OK] OnlineFileReader test passed (" << trials << " trials)" << std::endl;
+}
+
+std::string read_file_as_string(const std::string &path)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    std::ostringstream oss;
+    oss << ifs.rdbuf();
+    return oss.str();
+}
+
+void test_streaming_file_writer(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] StreamingFileWriter with and without background flushing ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    std::string path = "io_test_streaming.bin";
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = t == 0 ? 0 : mt() % (max_len + 1);
+        std::vector<int64_t> values(n);
+        for (auto &v : values)
+        {
+            // Mix small, negative and full-width values.
+            uint64_t kind = mt() % 3;
+            v = kind == 0 ? (int64_t)(mt() % 10) : (kind == 1 ? -(int64_t)(mt() % 1000000) : (int64_t)mt());
+        }
+        // Buffer sizes below MIN_BUFFER_SIZE are rounded up.
+        uint64_t buffer_size = 1 + (mt() % 1000);
+        uint64_t split = n == 0 ? 0 : mt() % (n + 1);
+
+        for (bool background_flush : {false, true})
+        {
+            // Binary output: push_back and write_block give the same bytes as the values in memory.
+            {
+                stool::StreamingFileWriter writer(path, buffer_size, background_flush);
+                for (uint64_t i = 0; i < split; ++i)
+                {
+                    writer.push_back(values[i]);
+                }
+                writer.write_block(values.data() + split, n - split);
+                writer.close();
+            }
+            std::vector<int64_t> loaded;
+            stool::FileReader::load_vector(path, loaded);
+            assert(loaded == values);
+
+            // Text output with the default and a custom separator.
+            for (std::string separator : {std::string("\n"), std::string(", ")})
+            {
+                // Odd positions are written as unsigned values, with negative values clamped to 0.
+                std::string expected;
+                {
+                    stool::StreamingFileWriter writer(path, buffer_size, background_flush);
+                    writer.set_separator(separator);
+                    for (uint64_t i = 0; i < n; ++i)
+                    {
+                        expected += i > 0 ? separator : "";
+                        if (i % 2 == 0)
+                        {
+                            writer.push_back_as_text(values[i]);
+                            expected += std::to_string(values[i]);
+                        }
+                        else
+                        {
+                            uint64_t x = values[i] >= 0 ? (uint64_t)values[i] : 0;
+                            writer.push_back_as_text(x);
+                            expected += std::to_string(x);
+                        }
+                    }
+                    writer.close();
+                }
+                assert(read_file_as_string(path) == expected);
+            }
+        }
+    }
+    std::remove(path.c_str());
+
+    std::cout << "[OK] StreamingFileWriter test passed (" << trials << " trials)" << std::endl;
+}
+
+int main()
+{
+    std::cout << "\033[34mTest: I/O\033[0m" << std::endl;
+    test_online_file_reader(200, 5000, 8008);
+    test_streaming_file_writer(200, 5000, 9009);
+    std::cout << "All I/O tests passed!" << std::endl;
+    return 0;
+}
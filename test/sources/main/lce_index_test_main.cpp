@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "../../../include/strings/lce_index.hpp"
+#include "../template/test_text.hpp"
+
+// Reference implementation: the LCE computed by comparing the suffixes character by character.
+uint64_t naive_lce(const std::vector<uint8_t> &text, uint64_t i, uint64_t j)
+{
+    uint64_t k = 0;
+    while (i + k < text.size() && j + k < text.size() && text[i + k] == text[j + k])
+    {
+        k++;
+    }
+    return k;
+}
+
+template <typename INDEX>
+void test_lce_index(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] LCEIndex<" << sizeof(INDEX) * 8 << "-bit> vs naive LCE ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    uint64_t prefix_length = stool::LCEIndex<INDEX>::HYBRID_PREFIX_LENGTH;
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text(mt, t, max_len, 0, 100);
+        uint64_t n = text.size();
+        stool::LCEIndex<INDEX> index;
+        index.build(text, stool::Message::NO_MESSAGE, 1 + (t % 3));
+        assert(index.size() == n);
+
+        std::vector<std::pair<uint64_t, uint64_t>> queries;
+        if (n <= 150)
+        {
+            for (uint64_t i = 0; i < n; ++i)
+            {
+                for (uint64_t j = 0; j < n; ++j)
+                {
+                    queries.push_back(std::pair<uint64_t, uint64_t>(i, j));
+                }
+            }
+        }
+        else
+        {
+            // Random pairs, i == j, pairs near the end of the text, and pairs at a multiple of the period of a periodic text.
+            for (uint64_t q = 0; q < 3000; ++q)
+            {
+                uint64_t i = mt() % n;
+                uint64_t j = mt() % n;
+                if (q % 4 == 1)
+                {
+                    j = i;
+                }
+                else if (q % 4 == 2)
+                {
+                    i = n - 1 - (mt() % std::min(n, 2 * prefix_length));
+                }
+                else if (q % 4 == 3)
+                {
+                    j = std::min(n - 1, i + 1 + (mt() % 200));
+                }
+                queries.push_back(std::pair<uint64_t, uint64_t>(i, j));
+            }
+        }
+
+        for ([[maybe_unused]] const std::pair<uint64_t, uint64_t> &q : queries)
+        {
+            [[maybe_unused]] uint64_t lce = naive_lce(text, q.first, q.second);
+            assert(index.lce(q.first, q.second) == lce);
+            assert(index.lce_by_rmq(q.first, q.second) == lce);
+        }
+
+        [[maybe_unused]] uint64_t rejected_count = 0;
+        for (int k = 0; k < 2; ++k)
+        {
+            try
+            {
+                if (k == 0)
+                {
+                    index.lce(n, 0);
+                }
+                else
+                {
+                    index.lce_by_rmq(0, n);
+                }
+            }
+            catch (const std::out_of_range &)
+            {
+                rejected_count++;
+            }
+        }
+        assert(rejected_count == 2);
+    }
+
+    std::cout << "[OK] LCEIndex test passed (" << trials << " trials)" << std::endl;
+}
+
+int main()
+{
+    std::cout << "\033[34mTest: LCEIndex\033[0m" << std::endl;
+    test_lce_index<uint64_t>(200, 5000, 2501);
+    test_lce_index<uint32_t>(100, 5000, 2502);
+    std::cout << "All LCEIndex tests passed!" << std::endl;
+    return 0;
+}
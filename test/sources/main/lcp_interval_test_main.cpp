@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../../include/strings/sa_is.hpp"
+#include "../../../include/third_party/sdsl_functions.hpp"
+#include "../../../include/beller/lcp_enumerator.hpp"
+#include "../../../include/beller/lcp_interval_enumerator.hpp"
+#include "../../../include/beller/compact_interval_queue.hpp"
+#include "../../../include/strings/lcp_interval_tree_traversal.hpp"
+#include "../../../include/strings/lcp_interval_comparator_in_preorder.hpp"
+#include "../template/test_text.hpp"
+
+// Returns a random value that is small, close to UINT64_MAX, or a full-width value, so that the deltas between consecutive values are small, large or negative.
+uint64_t create_random_value(std::mt19937_64 &mt, uint64_t previous)
+{
+    uint64_t kind = mt() % 4;
+    if (kind == 0)
+    {
+        return previous + (mt() % 3) - std::min(previous, (uint64_t)1);
+    }
+    else if (kind == 1)
+    {
+        return mt() % 1000;
+    }
+    else if (kind == 2)
+    {
+        return UINT64_MAX - (mt() % 1000);
+    }
+    else
+    {
+        return mt();
+    }
+}
+
+void test_compact_interval_queue(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] CompactIntervalQueue vs std::deque with and without spilling ..." << std::endl;
+    using INTERVAL = stool::LCPInterval<uint64_t>;
+    std::mt19937_64 mt(seed);
+    uint64_t spilled_bytes = 0;
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        // A budget of 0 or a few bytes spills every filled chunk to disk; UINT64_MAX keeps all the chunks in memory.
+        uint64_t memory_limit_bytes = t % 3 == 0 ? UINT64_MAX : (t % 3 == 1 ? 0 : mt() % 10000);
+        stool::beller::IntervalQueueStorage storage(memory_limit_bytes, ".");
+        std::vector<stool::beller::CompactIntervalQueue> queues;
+        std::vector<std::deque<INTERVAL>> expected_queues(1 + (mt() % 3));
+        for (uint64_t x = 0; x < expected_queues.size(); ++x)
+        {
+            queues.emplace_back(&storage);
+        }
+
+        uint64_t n = mt() % (max_len + 1);
+        uint64_t pop_percent = mt() % 60;
+        INTERVAL previous(0, 0, 0);
+        for (uint64_t k = 0; k < n; ++k)
+        {
+            uint64_t x = mt() % queues.size();
+            if (mt() % 100 < pop_percent && !queues[x].empty())
+            {
+                assert(queues[x].front() == expected_queues[x].front());
+                queues[x].pop();
+                expected_queues[x].pop_front();
+            }
+            else
+            {
+                INTERVAL interval(create_random_value(mt, previous.i), create_random_value(mt, previous.j), create_random_value(mt, previous.lcp));
+                queues[x].push(interval);
+                expected_queues[x].push_back(interval);
+                previous = interval;
+            }
+            assert(queues[x].size() == expected_queues[x].size());
+        }
+        for (uint64_t x = 0; x < queues.size(); ++x)
+        {
+            while (!expected_queues[x].empty())
+            {
+                assert(queues[x].front() == expected_queues[x].front());
+                queues[x].pop();
+                expected_queues[x].pop_front();
+            }
+            assert(queues[x].empty());
+        }
+        assert(storage.get_memory_bytes() <= stool::beller::CompactIntervalQueue::CHUNK_SIZE * queues.size());
+        assert(memory_limit_bytes != UINT64_MAX || storage.get_spilled_bytes() == 0);
+        spilled_bytes += storage.get_spilled_bytes();
+
+        // A cleared queue can be reused.
+        queues[0].push(INTERVAL(5, 7, 3));
+        queues[0].clear();
+        queues[0].push(INTERVAL(2, 4, 1));
+        assert(queues[0].front() == INTERVAL(2, 4, 1));
+    }
+    assert(spilled_bytes > 0);
+
+    std::cout << "[OK] CompactIntervalQueue test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_spilled_beller(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] LCP enumeration with a tiny queue budget vs without a budget ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    [[maybe_unused]] uint64_t traversed_count = 0;
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text_with_end_marker(mt, t, max_len);
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        sdsl::int_vector<> bwt;
+        stool::SDSLFunctions::construct_BWT(text, sa, bwt);
+
+        std::vector<uint64_t> lcp = stool::beller::LCPEnumerator::construct_LCP_array(bwt, stool::Message::NO_MESSAGE, 1);
+        std::vector<uint64_t> lcp_statistics = stool::beller::LCPEnumerator::compute_lcp_statistics(bwt, stool::Message::NO_MESSAGE, 1);
+        std::vector<stool::LCPInterval<uint64_t>> intervals = stool::beller::LCPIntervalEnumerator::compute_lcp_intervals(bwt, stool::Message::NO_MESSAGE);
+        for ([[maybe_unused]] uint64_t memory_limit_bytes : {(uint64_t)0, (uint64_t)1000})
+        {
+            for ([[maybe_unused]] uint64_t thread_count : {1, 3})
+            {
+                assert(stool::beller::LCPEnumerator::construct_LCP_array(bwt, stool::Message::NO_MESSAGE, thread_count, stool::IntervalSearchBackend::WaveletTree, memory_limit_bytes, ".") == lcp);
+                assert(stool::beller::LCPEnumerator::compute_lcp_statistics(bwt, stool::Message::NO_MESSAGE, thread_count, stool::IntervalSearchBackend::ByteRankDirectory, memory_limit_bytes, ".") == lcp_statistics);
+            }
+            assert(stool::beller::LCPIntervalEnumerator::compute_lcp_intervals(bwt, stool::Message::NO_MESSAGE, stool::IntervalSearchBackend::WaveletTree, memory_limit_bytes, ".") == intervals);
+        }
+
+        // The 32-bit LCP array has the same values, and the traversal of the LCP interval tree visits the same nodes with 32-bit and 64-bit integers.
+        std::vector<uint32_t> lcp32 = stool::beller::LCPEnumerator::construct_LCP_array<uint32_t>(bwt, stool::Message::NO_MESSAGE, 1 + (t % 3));
+        for (uint64_t i = 0; i < lcp.size(); ++i)
+        {
+            assert(lcp[i] == UINT64_MAX ? lcp32[i] == UINT32_MAX : lcp32[i] == lcp[i]);
+        }
+        if (std::find(lcp.begin(), lcp.end(), UINT64_MAX) == lcp.end())
+        {
+            std::vector<stool::LCPInterval<uint64_t>> visited64, visited32;
+            stool::beller::LCPIntervalEnumerator::traverse_lcp_interval_tree(
+                bwt, [&](const stool::LCPIntervalTreeNode &node)
+                { visited64.push_back(node.get_interval()); return true; },
+                [](const stool::LCPIntervalTreeNode &) {});
+            stool::beller::LCPIntervalEnumerator::traverse_lcp_interval_tree<uint32_t>(
+                bwt, [&](const stool::LCPIntervalTreeNode &node)
+                { visited32.push_back(node.get_interval()); return true; },
+                [](const stool::LCPIntervalTreeNode &) {}, 2, UINT64_MAX, stool::Message::NO_MESSAGE, 2);
+            assert(visited64.size() > 0 && visited32 == visited64);
+            traversed_count++;
+        }
+    }
+    assert(traversed_count > 0);
+
+    std::cout << "[OK] spilled Beller test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_parallel_beller(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] parallel Beller LCP enumeration vs sequential ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text_with_end_marker(mt, t, max_len);
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        sdsl::int_vector<> bwt;
+        stool::SDSLFunctions::construct_BWT(text, sa, bwt);
+
+        // The sequential LCPEnumerator is the reference for the positions and the values of the LCP values.
+        std::vector<uint64_t> lcp = stool::beller::LCPEnumerator::construct_LCP_array(bwt, stool::Message::NO_MESSAGE, 1);
+        std::vector<uint64_t> lcp_statistics = stool::beller::LCPEnumerator::compute_lcp_statistics(bwt, stool::Message::NO_MESSAGE, 1);
+        for ([[maybe_unused]] auto backend : {stool::IntervalSearchBackend::WaveletTree, stool::IntervalSearchBackend::ByteRankDirectory})
+        {
+            assert(stool::beller::LCPEnumerator::construct_LCP_array(bwt, stool::Message::NO_MESSAGE, 1, backend) == lcp);
+            for ([[maybe_unused]] uint64_t thread_count : {2, 3, 8})
+            {
+                assert(stool::beller::LCPEnumerator::construct_LCP_array(bwt, stool::Message::NO_MESSAGE, thread_count, backend) == lcp);
+                assert(stool::beller::LCPEnumerator::compute_lcp_statistics(bwt, stool::Message::NO_MESSAGE, thread_count, backend) == lcp_statistics);
+            }
+        }
+
+        // Small windows split a level into many windows, small batches split a window into many batches, and a zero budget spills the queues to disk.
+        std::vector<uint64_t> C;
+        stool::bwt::BWTFunctions::construct_C_array(bwt, C, stool::Message::NO_MESSAGE);
+        sdsl::wt_huff<> wt;
+        stool::ByteRankDirectory rank_directory;
+        stool::IntervalSearchDataStructure<uint8_t> range;
+        range.initialize(bwt, &wt, &rank_directory, &C, bwt[bwt.size() - 1], stool::IntervalSearchBackend::ByteRankDirectory);
+        for (uint64_t thread_count : {1, 2, 3})
+        {
+            for (uint64_t batch_size : {1, 5})
+            {
+                for (uint64_t window_size : {1, 7, 100})
+                {
+                    stool::beller::IntervalQueueStorage storage(0, ".");
+                    stool::beller::ParallelBellerComponent comp(&range, thread_count, batch_size, &storage, window_size);
+                    std::vector<uint64_t> output(bwt.size(), UINT64_MAX);
+                    comp.enumerate_lcp_values([&](uint64_t, uint64_t position, uint64_t lcp_value)
+                                              { output[position] = lcp_value; });
+                    assert(output == lcp);
+                }
+            }
+        }
+    }
+
+    std::cout << "[OK] parallel Beller test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_interval_search_backends(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] getIntervals with the wavelet tree vs the byte rank directory ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text_with_end_marker(mt, t, max_len);
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        sdsl::int_vector<> bwt;
+        stool::SDSLFunctions::construct_BWT(text, sa, bwt);
+        uint64_t n = bwt.size();
+        std::vector<uint64_t> C;
+        stool::bwt::BWTFunctions::construct_C_array(bwt, C, stool::Message::NO_MESSAGE);
+
+        // The rank directory is built from the BWT, so the wavelet tree given to brd_range stays empty.
+        sdsl::wt_huff<> wt1, wt2;
+        stool::ByteRankDirectory rank_directory;
+        stool::IntervalSearchDataStructure<uint8_t> wt_range, brd_range;
+        wt_range.initialize(bwt, &wt1, &rank_directory, &C, bwt[n - 1], stool::IntervalSearchBackend::WaveletTree);
+        brd_range.initialize(bwt, &wt2, &rank_directory, &C, bwt[n - 1], stool::IntervalSearchBackend::ByteRankDirectory);
+        assert(wt1.size() == n && wt2.size() == 0);
+        assert(brd_range.get_text_size() == n);
+
+        std::vector<stool::CharInterval<uint64_t, uint8_t>> output1(256), output2(256);
+        for (uint64_t q = 0; q < 200; ++q)
+        {
+            uint64_t i = mt() % n;
+            uint64_t j = i + (mt() % (n - i));
+            brd_range.prefetch(i, j);
+            uint64_t k1 = wt_range.getIntervals(i, j, output1);
+            [[maybe_unused]] uint64_t k2 = brd_range.getIntervals(i, j, output2);
+            assert(k1 == k2);
+            for (uint64_t x = 0; x < k1; ++x)
+            {
+                assert(output1[x].i == output2[x].i && output1[x].j == output2[x].j && output1[x].c == output2[x].c);
+            }
+        }
+    }
+
+    std::cout << "[OK] interval search backend test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_lcp_interval_tree_traversal(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] traversal of the LCP interval tree ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = 1 + (mt() % max_len);
+        uint64_t sigma = 1 + (mt() % 4);
+        uint64_t period = 1 + (mt() % 10);
+        std::vector<uint8_t> text(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            text[i] = (t % 3 == 2 && i >= period) ? text[i - period] : (uint8_t)('a' + (mt() % sigma));
+        }
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        std::vector<uint64_t> lcp = stool::TestText::naive_lcp_array(text, sa);
+
+        std::vector<stool::LCPInterval<uint64_t>> expected = stool::LCPInterval<uint64_t>::compute_lcp_intervals(lcp);
+        stool::LCPIntervalComparatorInPreorder<uint64_t>::sort_in_preorder(expected);
+
+        uint64_t min_frequency = t % 3 == 0 ? 1 + (mt() % 5) : 2;
+        uint64_t max_lcp = t % 4 == 0 ? mt() % 5 : UINT64_MAX;
+        std::vector<stool::LCPInterval<uint64_t>> visited;
+        std::vector<stool::LCPIntervalTreeNode> open_nodes;
+        stool::LCPIntervalTreeTraversal<uint64_t>::traverse(
+            lcp,
+            [&](const stool::LCPIntervalTreeNode &node)
+            {
+                assert(node.depth == open_nodes.size());
+                if (open_nodes.size() > 0)
+                {
+                    assert(open_nodes.back().i <= node.i && node.j <= open_nodes.back().j);
+                }
+                // The children are separated by the positions whose LCP values equal node.lcp (only the root may have a single child).
+                uint64_t child_count = node.i == node.j ? 0 : 1;
+                for (uint64_t x = node.i + 1; x <= node.j; ++x)
+                {
+                    child_count += lcp[x] == node.lcp ? 1 : 0;
+                }
+                assert(node.child_count == child_count);
+                open_nodes.push_back(node);
+                visited.push_back(node.get_interval());
+                return true;
+            },
+            [&]([[maybe_unused]] const stool::LCPIntervalTreeNode &node)
+            {
+                assert(open_nodes.back().i == node.i && open_nodes.back().j == node.j);
+                open_nodes.pop_back();
+            },
+            min_frequency, max_lcp);
+        assert(open_nodes.size() == 0);
+
+        // A 32-bit LCP array visits the same intervals.
+        std::vector<uint32_t> lcp32(lcp.begin(), lcp.end());
+        std::vector<stool::LCPInterval<uint64_t>> visited32;
+        stool::LCPIntervalTreeTraversal<uint32_t>::traverse(
+            lcp32, [&](const stool::LCPIntervalTreeNode &node)
+            { visited32.push_back(node.get_interval()); return true; },
+            [](const stool::LCPIntervalTreeNode &) {}, min_frequency, max_lcp);
+        assert(visited32 == visited);
+
+        std::vector<stool::LCPInterval<uint64_t>> filtered;
+        for (auto &intv : expected)
+        {
+            bool is_root = intv.i == 0 && intv.j == n - 1 && intv.lcp == 0;
+            if (is_root || (intv.j - intv.i + 1 >= min_frequency && intv.lcp <= max_lcp))
+            {
+                filtered.push_back(intv);
+            }
+        }
+        assert(visited.size() == filtered.size());
+        for (uint64_t x = 0; x < visited.size(); ++x)
+        {
+            assert(visited[x].i == filtered[x].i && visited[x].j == filtered[x].j && visited[x].lcp == filtered[x].lcp);
+        }
+    }
+
+    std::cout << "[OK] LCP interval tree traversal test passed (" << trials << " trials)" << std::endl;
+}
+
+int main()
+{
+    std::cout << "\033[34mTest: LCP intervals\033[0m" << std::endl;
+    test_lcp_interval_tree_traversal(300, 200, 9090);
+    test_interval_search_backends(100, 3000, 1201);
+    test_parallel_beller(60, 1000, 1101);
+    test_compact_interval_queue(40, 200000, 1301);
+    test_spilled_beller(20, 8000, 1401);
+    std::cout << "All LCP interval tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../../include/strings/sa_is.hpp"
+#include "../../../include/rlbwt/rle.hpp"
+#include "../../../include/rlbwt/move_lf_data_structure.hpp"
+#include "../../../include/rlbwt/r_index.hpp"
+#include "../../../include/rlbwt/prefix_free_parsing.hpp"
+#include "../../../include/rlbwt/rle_io.hpp"
+#include "../../../include/io/file_reader.hpp"
+#include "../../../include/io/file_writer.hpp"
+#include "../template/test_text.hpp"
+
+std::vector<uint8_t> construct_bwt(const std::vector<uint8_t> &text, const std::vector<uint64_t> &sa)
+{
+    uint64_t n = text.size();
+    std::vector<uint8_t> bwt(n);
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        bwt[i] = sa[i] == 0 ? text[n - 1] : text[sa[i] - 1];
+    }
+    return bwt;
+}
+
+// Reference implementation: LF(i) = C[BWT[i]] + rank(BWT[i], i).
+std::vector<uint64_t> naive_lf_array(const std::vector<uint8_t> &bwt)
+{
+    std::vector<uint64_t> C(257, 0);
+    for (uint8_t c : bwt)
+    {
+        C[c + 1]++;
+    }
+    for (uint64_t c = 1; c <= 256; ++c)
+    {
+        C[c] += C[c - 1];
+    }
+    std::vector<uint64_t> lf(bwt.size());
+    for (uint64_t i = 0; i < bwt.size(); ++i)
+    {
+        lf[i] = C[bwt[i]]++;
+    }
+    return lf;
+}
+
+// Returns a substring of the text (which occurs) or a random string (which usually does not occur).
+// The pattern is cut after the end marker, since the backward search treats the text as cyclic.
+std::vector<uint8_t> create_test_pattern(std::mt19937_64 &mt, const std::vector<uint8_t> &text)
+{
+    uint64_t m = mt() % 12;
+    std::vector<uint8_t> pattern;
+    if (mt() % 3 != 0 && text.size() > 0)
+    {
+        uint64_t pos = mt() % text.size();
+        pattern.assign(text.begin() + pos, text.begin() + std::min(text.size(), pos + m));
+    }
+    else
+    {
+        for (uint64_t x = 0; x < m; ++x)
+        {
+            pattern.push_back(text[mt() % text.size()]);
+        }
+    }
+    auto end_marker = std::find(pattern.begin(), pattern.end(), 0);
+    if (end_marker != pattern.end())
+    {
+        pattern.erase(end_marker + 1, pattern.end());
+    }
+    return pattern;
+}
+
+// Reference implementation: the starting positions of the occurrences of pattern in the order of the suffix array.
+std::vector<uint64_t> naive_locate(const std::vector<uint8_t> &text, const std::vector<uint64_t> &sa, const std::vector<uint8_t> &pattern)
+{
+    std::vector<uint64_t> output;
+    for (uint64_t p : sa)
+    {
+        if (p + pattern.size() <= text.size() && std::equal(pattern.begin(), pattern.end(), text.begin() + p))
+        {
+            output.push_back(p);
+        }
+    }
+    return output;
+}
+
+void test_move_lf_data_structure(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] MoveLFDataStructure vs naive LF and pattern counting ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text_with_end_marker(mt, t, max_len);
+        uint64_t n = text.size();
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        std::vector<uint8_t> bwt = construct_bwt(text, sa);
+        std::vector<uint64_t> lf = naive_lf_array(bwt);
+        stool::rlbwt2::RLE<uint8_t> rle = stool::rlbwt2::RLE<uint8_t>::build_from_BWT(bwt, stool::Message::NO_MESSAGE);
+
+        stool::rlbwt2::MoveLFDataStructure lfds;
+        lfds.build(rle, stool::Message::NO_MESSAGE);
+        assert(lfds.size() == n);
+        assert(lfds.get_run_count() == rle.rle_size());
+        assert(lfds.get_row_count() >= rle.rle_size());
+
+        // Every run starts a row, and a row does not cross a run boundary.
+        for (uint64_t x = 0; x < lfds.get_row_count(); ++x)
+        {
+            uint64_t start = lfds.get_row_start(x);
+            uint64_t end = x + 1 < lfds.get_row_count() ? lfds.get_row_start(x + 1) : n;
+            assert(start < end);
+            for (uint64_t i = start; i < end; ++i)
+            {
+                assert(bwt[i] == lfds.get_char_by_row_index(x));
+            }
+        }
+
+        // The image of a row contains less than BALANCE_THRESHOLD row starts.
+        for (uint64_t x = 0; x < lfds.get_row_count(); ++x)
+        {
+            uint64_t start = lfds.get_row_start(x);
+            uint64_t end = x + 1 < lfds.get_row_count() ? lfds.get_row_start(x + 1) : n;
+            uint64_t lf_start = lf[start];
+            [[maybe_unused]] uint64_t starts = 0;
+            for (uint64_t y = 0; y < lfds.get_row_count(); ++y)
+            {
+                uint64_t s = lfds.get_row_start(y);
+                starts += (lf_start < s && s < lf_start + (end - start)) ? 1 : 0;
+            }
+            assert(starts < stool::rlbwt2::MoveLFDataStructure::BALANCE_THRESHOLD);
+        }
+
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            assert(lfds.access(i) == bwt[i]);
+            assert(lfds.lf(i) == lf[i]);
+        }
+
+        // An LF walk on (position, row) pairs visits the whole BWT.
+        uint64_t i = 0;
+        uint64_t row_index = lfds.get_row_index(0);
+        for (uint64_t k = 0; k < n; ++k)
+        {
+            [[maybe_unused]] uint64_t expected = lf[i];
+            lfds.lf(i, row_index);
+            assert(i == expected);
+            assert(row_index == lfds.get_row_index(i));
+        }
+        assert(i == 0);
+
+        for (uint64_t q = 0; q < 100; ++q)
+        {
+            std::vector<uint8_t> pattern = create_test_pattern(mt, text);
+            std::vector<uint64_t> occurrences = naive_locate(text, sa, pattern);
+            assert(lfds.count(pattern) == occurrences.size());
+            uint64_t sp = 0, ep = 0;
+            if (lfds.backward_search(pattern, sp, ep))
+            {
+                assert(occurrences.size() > 0);
+                assert(ep - sp + 1 == occurrences.size());
+                assert(sa[sp] == occurrences[0]);
+            }
+        }
+    }
+
+    std::cout << "[OK] MoveLFDataStructure test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_r_index(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] RIndex locate vs naive pattern scan ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<uint8_t> text = stool::TestText::create_test_text_with_end_marker(mt, t, max_len);
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        std::vector<uint8_t> bwt = construct_bwt(text, sa);
+        stool::rlbwt2::RLE<uint8_t> rle = stool::rlbwt2::RLE<uint8_t>::build_from_BWT(bwt, stool::Message::NO_MESSAGE);
+
+        for (uint64_t thread_count : {1, 3})
+        {
+            stool::rlbwt2::RIndex index;
+            index.build(rle, stool::Message::NO_MESSAGE, thread_count);
+            assert(index.size() == text.size());
+
+            // The empty pattern occurs at every position, so its occurrences are the suffix array.
+            assert(index.locate(std::vector<uint8_t>()) == sa);
+
+            for (uint64_t q = 0; q < 100; ++q)
+            {
+                std::vector<uint8_t> pattern = create_test_pattern(mt, text);
+                std::vector<uint64_t> occurrences = naive_locate(text, sa, pattern);
+                assert(index.count(pattern) == occurrences.size());
+                assert(index.locate(pattern) == occurrences);
+                uint64_t sp = 0, ep = 0, sa_sp = 0;
+                if (index.backward_search(pattern, sp, ep, sa_sp))
+                {
+                    assert(ep - sp + 1 == occurrences.size());
+                    assert(sa[sp] == sa_sp);
+                }
+            }
+        }
+    }
+
+    std::cout << "[OK] RIndex test passed (" << trials << " trials)" << std::endl;
+}
+
+// Checks that the runs are maximal and expand to the BWT.
+void check_runs(const std::vector<uint8_t> &run_chars, const std::vector<uint64_t> &run_lengths, [[maybe_unused]] const std::vector<uint8_t> &bwt)
+{
+    assert(run_chars.size() == run_lengths.size());
+    std::vector<uint8_t> expanded;
+    for (uint64_t x = 0; x < run_chars.size(); ++x)
+    {
+        assert(run_lengths[x] > 0);
+        assert(x == 0 || run_chars[x - 1] != run_chars[x]);
+        expanded.insert(expanded.end(), run_lengths[x], run_chars[x]);
+    }
+    assert(expanded == bwt);
+}
+
+void test_prefix_free_parsing(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] RLBWT by prefix-free parsing vs BWT by suffix array ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    std::string text_path = "rlbwt_test_pfp.txt";
+    std::string bwt_path = "rlbwt_test_pfp.bwt";
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        // The end marker is not always 0.
+        std::vector<uint8_t> text = stool::TestText::create_test_text_with_end_marker(mt, t, max_len);
+        uint8_t shift = t % 5 == 0 ? (uint8_t)(1 + (mt() % 10)) : 0;
+        for (auto &c : text)
+        {
+            c = (uint8_t)std::min((uint64_t)c + shift, (uint64_t)UINT8_MAX);
+        }
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        std::vector<uint8_t> bwt = construct_bwt(text, sa);
+
+        // Small moduli give many short phrases, and large ones give a few long phrases.
+        uint64_t window_size = 1 + (mt() % 12);
+        uint64_t modulus = t % 4 == 0 ? 1 : 1 + (mt() % 100);
+        std::vector<uint8_t> run_chars;
+        std::vector<uint64_t> run_lengths;
+        stool::PrefixFreeParsing::build_RLBWT(text, run_chars, run_lengths, window_size, modulus, stool::Message::NO_MESSAGE);
+        check_runs(run_chars, run_lengths, bwt);
+
+        stool::FileWriter::write_vector(text_path, text);
+        std::vector<uint8_t> file_run_chars;
+        std::vector<uint64_t> file_run_lengths;
+        stool::PrefixFreeParsing::build_RLBWT_from_file(text_path, file_run_chars, file_run_lengths, window_size, modulus, stool::Message::NO_MESSAGE);
+        assert(file_run_chars == run_chars);
+        assert(file_run_lengths == run_lengths);
+
+        stool::RLEIO::write_BWT_from_RLBWT(bwt_path, run_chars, run_lengths);
+        std::vector<uint8_t> written_bwt;
+        stool::FileReader::load_vector(bwt_path, written_bwt);
+        assert(written_bwt == bwt);
+
+        stool::rlbwt2::RLE<uint8_t> rle = stool::rlbwt2::RLE<uint8_t>::build_from_runs(run_chars, run_lengths);
+        assert(rle.rle_size() == run_chars.size());
+        assert(rle.str_size() == bwt.size());
+        for (uint64_t x = 0; x < run_chars.size(); ++x)
+        {
+            assert(rle.get_char_by_run_index(x) == run_chars[x]);
+            assert(rle.get_run(x) == run_lengths[x]);
+        }
+
+        // A text whose last character is not the unique smallest character is rejected.
+        if (text.size() > 1)
+        {
+            std::vector<uint8_t> invalid_text = text;
+            invalid_text[mt() % (text.size() - 1)] = text.back();
+            [[maybe_unused]] bool rejected = false;
+            try
+            {
+                stool::PrefixFreeParsing::build_RLBWT(invalid_text, run_chars, run_lengths, window_size, modulus, stool::Message::NO_MESSAGE);
+            }
+            catch (const std::runtime_error &)
+            {
+                rejected = true;
+            }
+            assert(rejected);
+        }
+    }
+    std::remove(text_path.c_str());
+    std::remove(bwt_path.c_str());
+
+    std::cout << "[OK] prefix-free parsing test passed (" << trials << " trials)" << std::endl;
+}
+
+int main()
+{
+    std::cout << "\033[34mTest: RLBWT\033[0m" << std::endl;
+    test_move_lf_data_structure(200, 2000, 1501);
+    test_r_index(200, 2000, 1601);
+    test_prefix_free_parsing(300, 5000, 1701);
+    std::cout << "All RLBWT tests passed!" << std::endl;
+    return 0;
+}
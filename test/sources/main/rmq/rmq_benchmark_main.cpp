@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../../../include/rmq/rmq_small_sparse_table.hpp"
+#include "../../../../include/rmq/rmq_compact.hpp"
+
+// Micro-benchmark of the RMQ data structures: the average latency of random queries answered one by one and by the batch API.
+// Usage: rmq_benchmark [array length] [number of queries] [max query length (0: unbounded)]
+
+using Queries = std::vector<std::pair<uint64_t, uint64_t>>;
+
+template <typename FUNC>
+double measure_ns_per_query(uint64_t query_count, FUNC func)
+{
+    auto st = std::chrono::steady_clock::now();
+    func();
+    auto ed = std::chrono::steady_clock::now();
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(ed - st).count() / (double)query_count;
+}
+
+template <typename RMQ>
+void run_single(const std::string &name, const RMQ &rmq, const std::vector<uint64_t> &array, const Queries &queries, const std::vector<uint64_t> &expected)
+{
+    std::vector<uint64_t> output(queries.size());
+    double ns = measure_ns_per_query(queries.size(), [&]()
+                                     {
+        for (uint64_t x = 0; x < queries.size(); x++)
+        {
+            output[x] = rmq.rmq_index(queries[x].first, queries[x].second, array);
+        } });
+    if (output != expected)
+    {
+        throw std::runtime_error(name + ": wrong answer");
+    }
+    std::cout << name << "\t: " << ns << " ns/query" << std::endl;
+}
+
+template <typename RMQ>
+void run_batch(const std::string &name, const RMQ &rmq, const std::vector<uint64_t> &array, const Queries &queries, const std::vector<uint64_t> &expected)
+{
+    std::vector<uint64_t> output;
+    double ns = measure_ns_per_query(queries.size(), [&]()
+                                     { rmq.rmq_index_batch(queries, output, array); });
+    if (output != expected)
+    {
+        throw std::runtime_error(name + ": wrong answer");
+    }
+    std::cout << name << "\t: " << ns << " ns/query" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (1ULL << 21);
+    uint64_t query_count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+    uint64_t max_length = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 0;
+
+    std::cout << "\033[34mBenchmark: RMQ (n = " << n << ", queries = " << query_count << ", max query length = " << max_length << ")\033[0m" << std::endl;
+    std::mt19937_64 rng(12345);
+    std::vector<uint64_t> array(n);
+    for (uint64_t &v : array)
+    {
+        v = rng() % 1000000;
+    }
+    Queries queries(query_count);
+    for (auto &q : queries)
+    {
+        q.first = rng() % n;
+        uint64_t width = max_length == 0 ? n - q.first : std::min(max_length, n - q.first);
+        q.second = q.first + rng() % width;
+    }
+
+    stool::RMQSparseTable<uint64_t> sparse_table;
+    sparse_table.build(array);
+    stool::RMQSmallSparseTable<uint64_t> small_sparse_table;
+    small_sparse_table.build(array);
+    stool::RMQCompact<uint64_t> compact;
+    compact.build(array);
+
+    std::vector<uint64_t> expected(query_count);
+    for (uint64_t x = 0; x < query_count; x++)
+    {
+        expected[x] = sparse_table.rmq_index(queries[x].first, queries[x].second, array);
+    }
+
+    run_single("RMQSparseTable", sparse_table, array, queries, expected);
+    run_batch("RMQSparseTable (batch)", sparse_table, array, queries, expected);
+    run_single("RMQSmallSparseTable", small_sparse_table, array, queries, expected);
+    run_batch("RMQSmallSparseTable (batch)", small_sparse_table, array, queries, expected);
+    run_single("RMQCompact", compact, array, queries, expected);
+    return 0;
+}
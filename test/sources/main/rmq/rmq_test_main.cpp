@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "../../../../include/rmq/rmq_sparse_table.hpp"
+#include "../../../../include/rmq/rmq_small_sparse_table.hpp"
+#include "../../../../include/rmq/rmq_compact.hpp"
+
+// Random arrays: small value ranges (many ties of the minimum), large value ranges, and increasing or decreasing runs.
+template <typename T>
+std::vector<T> create_test_array(std::mt19937_64 &mt, uint64_t t, uint64_t n)
+{
+    std::vector<T> array(n);
+    uint64_t max_value = t % 4 == 0 ? 2 : (t % 4 == 1 ? 10 : 1000000);
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        if (t % 4 == 3 && i > 0)
+        {
+            array[i] = (T)(mt() % 64 == 0 ? mt() % max_value : (t % 8 == 3 ? array[i - 1] + 1 : (array[i - 1] > 0 ? array[i - 1] - 1 : max_value)));
+        }
+        else
+        {
+            array[i] = (T)(mt() % max_value);
+        }
+    }
+    return array;
+}
+
+// Queries: every pair for short arrays, and otherwise random pairs, i == j, and pairs at and around the boundaries of the blocks of the given sizes.
+std::vector<std::pair<uint64_t, uint64_t>> create_test_queries(std::mt19937_64 &mt, uint64_t n, uint64_t query_count, const std::vector<uint64_t> &block_sizes)
+{
+    std::vector<std::pair<uint64_t, uint64_t>> queries;
+    if (n <= 300)
+    {
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            for (uint64_t j = i; j < n; ++j)
+            {
+                queries.push_back(std::pair<uint64_t, uint64_t>(i, j));
+            }
+        }
+        return queries;
+    }
+    for (uint64_t q = 0; q < query_count; ++q)
+    {
+        uint64_t i = mt() % n;
+        uint64_t j = i + (mt() % (n - i));
+        if (q % 4 == 1)
+        {
+            j = i;
+        }
+        else if (q % 4 >= 2)
+        {
+            uint64_t block_size = block_sizes[mt() % block_sizes.size()];
+            uint64_t bi = (mt() % (n / block_size + 1)) * block_size;
+            uint64_t bj = (mt() % (n / block_size + 1)) * block_size;
+            i = std::min(n - 1, bi + (mt() % 3) - std::min(bi, (uint64_t)1));
+            j = std::min(n - 1, bj + (mt() % 3) - std::min(bj, (uint64_t)1));
+            if (j < i)
+            {
+                std::swap(i, j);
+            }
+        }
+        queries.push_back(std::pair<uint64_t, uint64_t>(i, j));
+    }
+    return queries;
+}
+
+template <typename T>
+void test_rmq_compact(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] RMQCompact<" << sizeof(T) * 8 << "-bit> vs naive_rmq_index ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    std::vector<uint64_t> fixed_lengths = {0, 1, 2, 7, 8, 9, 255, 256, 257, 511, 512, 513, 256 * 5 + 3};
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = t < fixed_lengths.size() ? fixed_lengths[t] : mt() % (max_len + 1);
+        std::vector<T> array = create_test_array<T>(mt, t, n);
+        stool::RMQCompact<T> rmq;
+        rmq.build(array, stool::Message::NO_MESSAGE, 1 + (t % 3));
+        assert(rmq.size() == n);
+
+        for ([[maybe_unused]] const std::pair<uint64_t, uint64_t> &q : create_test_queries(mt, n, 2000, {stool::RMQCompact<T>::MICRO_BLOCK_SIZE, stool::RMQCompact<T>::MACRO_BLOCK_SIZE}))
+        {
+            assert(rmq.rmq_index(q.first, q.second, array) == stool::RMQSparseTable<T>::naive_rmq_index(q.first, q.second, array));
+            assert(rmq.rmq(q.first, q.second, array) == array[stool::RMQSparseTable<T>::naive_rmq_index(q.first, q.second, array)]);
+        }
+
+        [[maybe_unused]] bool rejected = false;
+        try
+        {
+            rmq.rmq_index(n, n, array);
+        }
+        catch (const std::out_of_range &)
+        {
+            rejected = true;
+        }
+        assert(rejected);
+        if (n > 1)
+        {
+            rejected = false;
+            try
+            {
+                rmq.rmq_index(1, 0, array);
+            }
+            catch (const std::out_of_range &)
+            {
+                rejected = true;
+            }
+            assert(rejected);
+        }
+    }
+
+    std::cout << "[OK] RMQCompact test passed (" << trials << " trials)" << std::endl;
+}
+
+template <typename T>
+void test_sparse_tables(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] RMQSparseTable / RMQSmallSparseTable<" << sizeof(T) * 8 << "-bit> (single and batch queries) vs naive_rmq_index ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    std::vector<uint64_t> fixed_lengths = {1, 2, 3, 4, 5, 15, 16, 17, 63, 64, 65};
+    uint64_t group_size = stool::RMQSparseTable<T>::BATCH_GROUP_SIZE;
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = t < fixed_lengths.size() ? fixed_lengths[t] : 1 + (mt() % max_len);
+        std::vector<T> array = create_test_array<T>(mt, t, n);
+        stool::RMQSparseTable<T> sparse_table;
+        sparse_table.build(array);
+        stool::RMQSmallSparseTable<T> small_sparse_table;
+        small_sparse_table.build(array);
+
+        // The queries of the small sparse table cross its blocks of log n elements; the last group of the batch is partial unless the count is a multiple of the group size.
+        uint64_t log_n = std::max((uint64_t)stool::Log::log2_floor(n), (uint64_t)1);
+        uint64_t query_count = t % 3 == 0 ? group_size * (1 + (mt() % 4)) : mt() % (group_size * 5);
+        std::vector<std::pair<uint64_t, uint64_t>> queries = create_test_queries(mt, n, query_count, {log_n, group_size});
+        std::vector<uint64_t> expected;
+        for (const std::pair<uint64_t, uint64_t> &q : queries)
+        {
+            expected.push_back(stool::RMQSparseTable<T>::naive_rmq_index(q.first, q.second, array));
+        }
+        for (uint64_t x = 0; x < queries.size(); ++x)
+        {
+            assert(sparse_table.rmq_index(queries[x].first, queries[x].second, array) == expected[x]);
+            assert(small_sparse_table.rmq_index(queries[x].first, queries[x].second, array) == expected[x]);
+        }
+
+        std::vector<uint64_t> output = {1, 2, 3};
+        sparse_table.rmq_index_batch(queries, output, array);
+        assert(output == expected);
+        output.clear();
+        small_sparse_table.rmq_index_batch(queries, output, array);
+        assert(output == expected);
+
+        // An invalid query in the last group is reported by the batch queries.
+        queries.push_back(t % 2 == 0 ? std::pair<uint64_t, uint64_t>(0, n) : std::pair<uint64_t, uint64_t>(n - 1, n - 2));
+        [[maybe_unused]] uint64_t rejected_count = 0;
+        for (int k = 0; k < 2; ++k)
+        {
+            try
+            {
+                if (k == 0)
+                {
+                    sparse_table.rmq_index_batch(queries, output, array);
+                }
+                else
+                {
+                    small_sparse_table.rmq_index_batch(queries, output, array);
+                }
+            }
+            catch (const std::out_of_range &)
+            {
+                rejected_count++;
+            }
+        }
+        assert(rejected_count == 2);
+    }
+
+    std::cout << "[OK] sparse table test passed (" << trials << " trials)" << std::endl;
+}
+
+int main()
+{
+    std::cout << "\033[34mTest: RMQ\033[0m" << std::endl;
+    test_rmq_compact<uint64_t>(200, 20000, 2301);
+    test_rmq_compact<uint32_t>(100, 20000, 2302);
+    test_sparse_tables<uint64_t>(300, 5000, 2401);
+    test_sparse_tables<uint32_t>(100, 5000, 2402);
+    std::cout << "All RMQ tests passed!" << std::endl;
+    return 0;
+}
@@ -1,11 +1,17 @@
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <random>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "../../../include/strings/sa_is.hpp"
+#include "../../../include/io/file_reader.hpp"
+#include "../../../include/io/file_writer.hpp"
+#include "../../../include/strings/string_functions.hpp"
 
 // Reference implementation: sort all suffixes with plain comparison.
 template <class C>
@@ -142,6 +148,280 @@ void test_signed_matches_unsigned_on_nonnegative(uint64_t trials, uint64_t max_l
     std::cout << "[OK] signed/unsigned agreement test passed (" << trials << " trials)" << std::endl;
 }
 
+void test_parallel_matches_sequential(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] parallel_sais_suffix_array agrees with sais_suffix_array ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = (max_len / 2) + (mt() % (max_len / 2 + 1));
+        uint64_t sigma = 1 + (mt() % ((t % 2 == 0) ? 4 : 300));
+        uint64_t period = 1 + (mt() % 1000);
+
+        std::vector<uint8_t> text(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            // Every third text is highly repetitive to force deep recursion.
+            text[i] = (t % 3 == 2 && i >= period) ? text[i - period] : (uint8_t)(mt() % sigma);
+        }
+        std::vector<uint64_t> expected = stool::sais_suffix_array(text);
+        for (uint64_t thread_count : {2, 3, 4})
+        {
+            if (stool::parallel_sais_suffix_array(text, thread_count) != expected)
+            {
+                std::cerr << "[NG] parallel: suffix array mismatch (n=" << n << ", threads=" << thread_count << ")" << std::endl;
+                assert(false);
+            }
+        }
+    }
+    std::vector<uint8_t> rep(300000, 'a');
+    assert(stool::parallel_sais_suffix_array(rep, 4) == stool::sais_suffix_array(rep));
+
+    std::cout << "[OK] parallel test passed (" << trials << " trials)" << std::endl;
+}
+
+template <class INDEX>
+bool equal_as_uint64(const std::vector<INDEX> &sa, const std::vector<uint64_t> &expected)
+{
+    if (sa.size() != expected.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < sa.size(); ++i)
+    {
+        if ((uint64_t)sa[i] != expected[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_index_widths(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] sais_suffix_array with uint32_t / UInt40 index types ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = mt() % (max_len + 1);
+        uint64_t sigma = 1 + (mt() % ((t % 2 == 0) ? 4 : 256));
+
+        std::vector<uint8_t> byte_text(n);
+        std::vector<uint32_t> int_text(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            byte_text[i] = (uint8_t)(mt() % sigma);
+            int_text[i] = (uint32_t)(mt() % (sigma * 1000));
+        }
+        std::vector<uint64_t> byte_expected = naive_suffix_array(byte_text);
+        std::vector<uint64_t> int_expected = naive_suffix_array(int_text);
+
+        assert(stool::sais_suffix_array(byte_text) == byte_expected);
+        assert(equal_as_uint64(stool::sais_suffix_array<uint8_t, uint32_t>(byte_text), byte_expected));
+        assert(equal_as_uint64(stool::sais_suffix_array<uint8_t, stool::UInt40>(byte_text), byte_expected));
+        assert(equal_as_uint64(stool::sais_suffix_array<uint32_t, uint32_t>(int_text), int_expected));
+        assert(equal_as_uint64(stool::sais_suffix_array<uint32_t, stool::UInt40>(int_text), int_expected));
+    }
+
+    // Signed 1-byte characters are ordered by their unsigned values, as in the other character types.
+    std::vector<int8_t> signed_text = {-1, 5, -128, 127, 0, -1, 5};
+    std::vector<uint8_t> unsigned_text(signed_text.begin(), signed_text.end());
+    assert(stool::sais_suffix_array(signed_text) == naive_suffix_array(unsigned_text));
+
+    std::vector<uint8_t> large(400000);
+    for (auto &c : large)
+    {
+        c = (uint8_t)(mt() % 3);
+    }
+    std::vector<uint64_t> expected = stool::sais_suffix_array(large);
+    assert(equal_as_uint64(stool::parallel_sais_suffix_array<uint8_t, uint32_t>(large, 3), expected));
+    assert(equal_as_uint64(stool::parallel_sais_suffix_array<uint8_t, stool::UInt40>(large, 2), expected));
+
+    std::cout << "[OK] index width test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_low_workspace(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] low_workspace_sais_suffix_array vs naive ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = mt() % (max_len + 1);
+        uint64_t sigma = 1 + (mt() % ((t % 2 == 0) ? 4 : 256));
+        uint64_t period = 1 + (mt() % 20);
+
+        std::vector<uint8_t> byte_text(n);
+        std::vector<uint64_t> int_text(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            byte_text[i] = (t % 3 == 2 && i >= period) ? byte_text[i - period] : (uint8_t)(mt() % sigma);
+            // Large characters force the coordinate compression path.
+            int_text[i] = (t % 4 == 0) ? (mt() % sigma) * 1000000007ULL : mt() % sigma;
+        }
+        std::vector<uint64_t> byte_expected = naive_suffix_array(byte_text);
+        std::vector<uint64_t> int_expected = naive_suffix_array(int_text);
+
+        assert(stool::sais_suffix_array(byte_text, true) == byte_expected);
+        assert(equal_as_uint64(stool::low_workspace_sais_suffix_array<uint8_t, uint32_t>(byte_text), byte_expected));
+        assert(equal_as_uint64(stool::low_workspace_sais_suffix_array<uint8_t, stool::UInt40>(byte_text), byte_expected));
+        assert(stool::low_workspace_sais_suffix_array(int_text) == int_expected);
+    }
+
+    // Every other position is an LMS position, so the reduced problems have no free space in the output,
+    // and their bucket arrays are placed in the bucket arrays of the levels above.
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = 2 * (1 + (mt() % (max_len / 2)));
+        std::vector<uint8_t> alternating(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            alternating[i] = i % 2 == 1 ? 1 : (uint8_t)(2 + (mt() % 8));
+        }
+        assert(stool::low_workspace_sais_suffix_array(alternating) == naive_suffix_array(alternating));
+    }
+
+    std::vector<uint8_t> large(500000);
+    for (uint64_t i = 0; i < large.size(); ++i)
+    {
+        large[i] = i >= 1000 ? large[i - 1000 + (mt() % 2)] : (uint8_t)(mt() % 4);
+    }
+    assert((stool::low_workspace_sais_suffix_array<uint8_t, uint32_t>(large) == stool::sais_suffix_array<uint8_t, uint32_t>(large)));
+
+    std::cout << "[OK] low workspace test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_mapped_text(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] sais_suffix_array on a text mapped from a file ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    std::string text_path = "sa_is_test_mapped.txt";
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = mt() % (max_len + 1);
+        std::vector<uint8_t> byte_text(n);
+        std::vector<uint16_t> wide_text(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            byte_text[i] = (uint8_t)(mt() % 4);
+            wide_text[i] = (uint16_t)(mt() % 1000);
+        }
+
+        stool::FileWriter::write_vector(text_path, byte_text);
+        stool::MappedVector<uint8_t> mapped_byte_text = stool::FileReader::map_vector<uint8_t>(text_path);
+        assert(mapped_byte_text.size() == n);
+        assert(stool::sais_suffix_array(mapped_byte_text) == stool::sais_suffix_array(byte_text));
+        assert(stool::sais_suffix_array(mapped_byte_text, true) == stool::sais_suffix_array(byte_text));
+
+        stool::FileWriter::write_vector(text_path, wide_text);
+        stool::MappedVector<uint16_t> mapped_wide_text = stool::FileReader::map_vector<uint16_t>(text_path, stool::MappingAdvice::Sequential);
+        assert(mapped_wide_text.to_vector() == wide_text);
+        assert(stool::sais_suffix_array(mapped_wide_text) == stool::sais_suffix_array(wide_text));
+    }
+    std::remove(text_path.c_str());
+
+    std::cout << "[OK] mapped text test passed (" << trials << " trials)" << std::endl;
+}
+
+void test_packed_array_file(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] suffix arrays stored in the packed array format ..." << std::endl;
+    std::mt19937_64 mt(seed);
+    std::string path = "sa_is_test_packed.sa";
+
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        uint64_t n = mt() % (max_len + 1);
+        std::vector<uint8_t> text(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            text[i] = (uint8_t)('a' + (mt() % 3));
+        }
+        std::vector<uint64_t> sa = stool::sais_suffix_array(text);
+        uint64_t block_size = t % 2 == 0 ? 0 : 1 + (mt() % 100);
+        std::vector<uint64_t> alphabet = stool::StringFunctions::get_alphabet_as_integers(text);
+        stool::FileWriter::write_packed_array(path, sa, stool::PackedArrayContent::SuffixArray, n, alphabet, block_size);
+
+        [[maybe_unused]] stool::PackedArrayHeader header = stool::FileReader::load_packed_array_header(path);
+        assert(header.element_count == n);
+        assert(header.text_length == n);
+        assert(header.bit_width == stool::PackedArrayFormat::get_bit_width(n == 0 ? 0 : n - 1));
+
+        stool::MappedPackedArray mapped = stool::FileReader::map_packed_array(path);
+        assert(mapped.get_content() == stool::PackedArrayContent::SuffixArray);
+        assert(mapped.get_alphabet() == alphabet);
+        assert(mapped.verify());
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            assert(mapped[i] == sa[i]);
+        }
+        std::vector<uint32_t> loaded;
+        stool::FileReader::load_packed_array(path, loaded);
+        assert(loaded.size() == n);
+        assert(std::equal(loaded.begin(), loaded.end(), sa.begin()));
+
+        std::vector<int64_t> dsa(n);
+        for (uint64_t i = 0; i < n; ++i)
+        {
+            dsa[i] = i == 0 ? (int64_t)sa[i] : (int64_t)sa[i] - (int64_t)sa[i - 1];
+        }
+        stool::FileWriter::write_packed_array(path, dsa, stool::PackedArrayContent::DifferentialSuffixArray, n, alphabet, block_size);
+        std::vector<int64_t> loaded_dsa;
+        stool::FileReader::load_packed_array(path, loaded_dsa);
+        assert(loaded_dsa == dsa);
+    }
+
+    // The alphabet of a wide text is collected without copying the text.
+    for (uint64_t t = 0; t < trials; ++t)
+    {
+        std::vector<int32_t> wide_text(mt() % (max_len + 1));
+        for (auto &c : wide_text)
+        {
+            c = (int32_t)(mt() % 50) * 10000019 - 200000000;
+        }
+        std::vector<uint64_t> wide_alphabet;
+        for (int32_t c : wide_text)
+        {
+            wide_alphabet.push_back((uint32_t)c);
+        }
+        std::sort(wide_alphabet.begin(), wide_alphabet.end());
+        wide_alphabet.erase(std::unique(wide_alphabet.begin(), wide_alphabet.end()), wide_alphabet.end());
+        assert(stool::StringFunctions::get_alphabet_as_integers(wide_text) == wide_alphabet);
+    }
+
+    // A header whose section sizes overflow when added up is rejected instead of being mapped.
+    std::vector<uint64_t> values = {1, 2, 3};
+    // With 2^64 - 8 values of 2 bits in blocks of one value, 12 - 2^59 is the alphabet size for which the unchecked sum wraps around to the 12 words of the file.
+    for (uint64_t corrupted_size : {(uint64_t)UINT64_MAX, (uint64_t)(1ULL << 62), (uint64_t)(12 - (1ULL << 59))})
+    {
+        stool::FileWriter::write_packed_array(path, values, stool::PackedArrayContent::Other, 0, std::vector<uint64_t>(), 1);
+        std::vector<uint64_t> words;
+        stool::FileReader::load_vector(path, words);
+        stool::PackedArrayHeader corrupted;
+        std::memcpy(&corrupted, words.data(), sizeof(stool::PackedArrayHeader));
+        corrupted.alphabet_size = corrupted_size;
+        corrupted.element_count = UINT64_MAX - 7;
+        std::memcpy(words.data(), &corrupted, sizeof(stool::PackedArrayHeader));
+        stool::FileWriter::write_vector(path, words);
+        [[maybe_unused]] bool rejected = false;
+        try
+        {
+            stool::MappedPackedArray mapped(path);
+        }
+        catch (const std::runtime_error &)
+        {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+    std::remove(path.c_str());
+
+    std::cout << "[OK] packed array file test passed (" << trials << " trials)" << std::endl;
+}
+
 int main()
 {
     std::cout << "\033[34mTest: SA-IS\033[0m" << std::endl;
@@ -151,6 +431,11 @@ int main()
     test_signed_random(200, 300, 424242);
     test_signed_extreme_values();
     test_signed_matches_unsigned_on_nonnegative(100, 300, 777);
+    test_index_widths(200, 300, 4040);
+    test_low_workspace(300, 300, 5150);
+    test_mapped_text(50, 2000, 7070);
+    test_packed_array_file(50, 2000, 8080);
+    test_parallel_matches_sequential(4, 1200000, 31337);
     std::cout << "All SA-IS tests passed!" << std::endl;
     return 0;
 }
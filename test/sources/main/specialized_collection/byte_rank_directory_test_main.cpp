@@ -0,0 +1,136 @@
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include "../../../../include/specialized_collection/byte_rank_directory.hpp"
+
+using stool::ByteRankDirectory;
+
+/**
+ * @brief Returns a random byte sequence of length \p n over \p sigma distinct characters that start at \p first_char
+ *
+ * Every fourth sequence consists of runs of about 64 characters and every fourth of runs of about 2048 characters,
+ * so that a block contains many (more than 255 for large blocks) occurrences of the same character.
+ */
+std::vector<uint8_t> create_random_sequence(std::mt19937_64 &mt, uint64_t n, uint64_t sigma, uint64_t first_char)
+{
+    std::vector<uint8_t> text(n);
+    uint64_t kind = mt() % 4;
+    uint64_t run_length = kind == 0 ? 64 : (kind == 1 ? 2048 : 1);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        text[i] = (i > 0 && mt() % run_length != 0) ? text[i - 1] : (uint8_t)(first_char + (mt() % sigma));
+    }
+    return text;
+}
+
+/**
+ * @brief Checks rank, access, inverse_select and interval_symbols of ByteRankDirectory against a scan of the sequence
+ */
+void check_byte_rank_directory(const std::vector<uint8_t> &text, std::mt19937_64 &mt, uint64_t query_count)
+{
+    uint64_t n = text.size();
+    ByteRankDirectory brd;
+    brd.build(text);
+    assert(brd.size() == n);
+
+    // ranks[i * 256 + c] = the number of occurrences of c in text[0..i-1]
+    std::vector<uint64_t> ranks((n + 1) * 256, 0);
+    for (uint64_t i = 0; i < n; i++)
+    {
+        std::copy(&ranks[i * 256], &ranks[(i + 1) * 256], &ranks[(i + 1) * 256]);
+        ranks[(i + 1) * 256 + text[i]]++;
+    }
+
+    for (uint64_t q = 0; q < query_count; q++)
+    {
+        // Positions at and around the block boundaries are queried as often as random positions.
+        uint64_t i = mt() % (n + 1);
+        if (q % 2 == 1)
+        {
+            uint64_t boundary = (mt() % ((n / brd.get_block_size()) + 1)) * brd.get_block_size();
+            i = std::min(n, boundary + (mt() % 3) - std::min(boundary, (uint64_t)1));
+        }
+        [[maybe_unused]] uint8_t c = text.size() > 0 && q % 3 != 0 ? text[mt() % n] : (uint8_t)(mt() % 256);
+        assert(brd.rank(i, c) == ranks[i * 256 + c]);
+
+        if (i < n)
+        {
+            assert(brd.access(i) == text[i]);
+            [[maybe_unused]] std::pair<uint64_t, uint8_t> p = brd.inverse_select(i);
+            assert(p.first == ranks[i * 256 + text[i]]);
+            assert(p.second == text[i]);
+        }
+
+        uint64_t j = i + (mt() % ((q % 4 == 0 ? n : brd.get_block_size()) + 1));
+        j = std::min(j, n);
+        uint64_t k = 0;
+        std::vector<uint8_t> cs(256);
+        std::vector<uint64_t> rank_c_i(256), rank_c_j(256);
+        brd.interval_symbols(i, j, k, cs, rank_c_i, rank_c_j);
+        uint64_t expected_k = 0;
+        for (uint64_t x = 0; x < 256; x++)
+        {
+            if (ranks[j * 256 + x] > ranks[i * 256 + x])
+            {
+                assert(expected_k < k);
+                assert(cs[expected_k] == x);
+                assert(rank_c_i[expected_k] == ranks[i * 256 + x]);
+                assert(rank_c_j[expected_k] == ranks[j * 256 + x]);
+                expected_k++;
+            }
+        }
+        assert(k == expected_k);
+    }
+}
+
+void test_byte_rank_directory(uint64_t trials, uint64_t max_len, uint64_t seed)
+{
+    std::cout << "[Test] ByteRankDirectory vs naive rank, access and interval_symbols ..." << std::endl;
+    std::mt19937_64 mt(seed);
+
+    for (uint64_t t = 0; t < trials; t++)
+    {
+        // Alphabets larger than 64 characters give blocks of 512 and 1024 characters.
+        uint64_t n = t == 0 ? 0 : mt() % (max_len + 1);
+        uint64_t sigma = 1 + (mt() % (t % 2 == 0 ? 64 : 256));
+        uint64_t first_char = mt() % (257 - sigma);
+        std::vector<uint8_t> text = create_random_sequence(mt, n, sigma, first_char);
+        check_byte_rank_directory(text, mt, 500);
+    }
+
+    // All the 256 characters occur (so a block has 1024 characters), followed by a block consisting of a single character.
+    for (uint64_t c : {0, 1, 128, 255})
+    {
+        std::vector<uint8_t> text(1024 + 1024 + 100, (uint8_t)c);
+        for (uint64_t x = 0; x < 256; x++)
+        {
+            text[x] = (uint8_t)x;
+        }
+        ByteRankDirectory brd;
+        brd.build(text);
+        assert(brd.get_block_size() == 1024);
+        uint64_t rank = 0;
+        for (uint64_t i = 0; i <= text.size(); i++)
+        {
+            assert(brd.rank(i, (uint8_t)c) == rank);
+            if (i < text.size() && text[i] == c)
+            {
+                assert(brd.inverse_select(i).first == rank);
+                rank++;
+            }
+        }
+    }
+
+    std::cout << "[OK] ByteRankDirectory test passed (" << trials << " trials)" << std::endl;
+}
+
+int main()
+{
+    std::cout << "\033[34mTest: ByteRankDirectory\033[0m" << std::endl;
+    test_byte_rank_directory(200, 5000, 1212);
+    std::cout << "All ByteRankDirectory tests passed!" << std::endl;
+    return 0;
+}
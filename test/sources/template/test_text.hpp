@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <random>
+
+namespace stool
+{
+    /**
+     * @brief The random texts and the naive reference arrays shared by the tests
+     */
+    class TestText
+    {
+    public:
+        /**
+         * @brief Returns the t-th random text of length in [min_len, max_len]
+         *
+         * Even t uses an alphabet of at most 4 characters and odd t one of at most 256 characters.
+         * Every third text is periodic with a period of at most \p max_period, except for a few mutations, so that the LCP values are long.
+         */
+        static std::vector<uint8_t> create_test_text(std::mt19937_64 &mt, uint64_t t, uint64_t max_len, uint64_t min_len = 0, uint64_t max_period = 30)
+        {
+            uint64_t n = min_len + (mt() % (max_len - min_len + 1));
+            uint64_t sigma = 1 + (mt() % ((t % 2 == 0) ? 4 : 256));
+            uint64_t period = 1 + (mt() % max_period);
+            std::vector<uint8_t> text(n);
+            for (uint64_t i = 0; i < n; ++i)
+            {
+                text[i] = (t % 3 == 2 && i >= period && mt() % 1000 != 0) ? text[i - period] : (uint8_t)(mt() % sigma);
+            }
+            return text;
+        }
+
+        /**
+         * @brief Returns a text of create_test_text over the characters 1..255 followed by the end marker 0
+         */
+        static std::vector<uint8_t> create_test_text_with_end_marker(std::mt19937_64 &mt, uint64_t t, uint64_t max_len)
+        {
+            std::vector<uint8_t> text = create_test_text(mt, t, max_len);
+            for (uint8_t &c : text)
+            {
+                c = (uint8_t)(1 + (c % UINT8_MAX));
+            }
+            text.push_back(0);
+            return text;
+        }
+
+        /**
+         * @brief Returns the LCP array of \p text computed by comparing adjacent suffixes character by character
+         */
+        template <typename TEXT>
+        static std::vector<uint64_t> naive_lcp_array(const TEXT &text, const std::vector<uint64_t> &sa)
+        {
+            uint64_t n = text.size();
+            std::vector<uint64_t> lcp(n, 0);
+            for (uint64_t i = 1; i < n; ++i)
+            {
+                while (sa[i - 1] + lcp[i] < n && sa[i] + lcp[i] < n && text[sa[i - 1] + lcp[i]] == text[sa[i] + lcp[i]])
+                {
+                    lcp[i]++;
+                }
+            }
+            return lcp;
+        }
+    };
+
+} // namespace stool
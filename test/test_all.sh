@@ -7,7 +7,17 @@
 ./build/vlc_deque_test
 ./build/value_array_test
 ./build/elias_fano_vector_test
+./build/byte_rank_directory_test
 ./build/sa_is_test
+./build/external_suffix_array_test
+./build/array_constructor_test
+./build/io_test
+./build/lcp_interval_test
+./build/rlbwt_test
+./build/bwt_test
+./build/delta_test
+./build/rmq_test
+./build/lce_index_test
 
 
 